@@ -14,86 +14,268 @@
 
 #include "alignment.h"
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "amatrix.h"
-#include "audio_signal.h"
+#include "audio_signal_view.h"
 #include "envelope.h"
 #include "xcorr.h"
 
 namespace Visqol {
-std::tuple<AudioSignal, AudioSignal, double> Alignment::AlignAndTruncate(
-    const AudioSignal& reference_signal, const AudioSignal& degraded_signal) {
-  std::tuple<AudioSignal, double> alignment_result =
-      Alignment::GloballyAlign(reference_signal, degraded_signal);
-  AudioSignal aligned_degraded_signal = std::get<0>(alignment_result);
-  double lag = std::get<1>(alignment_result);
-  const AMatrix<double>& reference_matrix = reference_signal.data_matrix;
-  // Take the aligned degraded matrix.
-  const AMatrix<double>& degraded_matrix = aligned_degraded_signal.data_matrix;
-  AMatrix<double> new_reference_matrix = reference_matrix;
-  AMatrix<double> new_degraded_matrix = degraded_matrix;
+const size_t Alignment::kEnvelopeDecimationFactor = 16;
+const int64_t Alignment::kRefinementRadius = 2;
+const size_t Alignment::kNumCoarseCandidates = 4;
+const size_t Alignment::kIntermediateDecimationFactor = 4;
+const size_t Alignment::kNumFineCandidates = 2;
+const size_t Alignment::kMinLengthForCoarseSearch = 1 << 16;
 
-  // Truncate the two aligned signals to match lengths.
-  // If the lag is positive or negative, the starts are aligned.
-  // (The front of degraded_signal is zero padded or truncated).
-  if (reference_matrix.NumRows() > degraded_matrix.NumRows()) {
-    new_reference_matrix =
-        reference_matrix.GetRows(0, degraded_matrix.NumRows() - 1);
-  } else if (reference_matrix.NumRows() < degraded_matrix.NumRows()) {
-    // For positive lag, the beginning of ref is now aligned with zeros, so
-    // that amount should be truncated.
-    new_reference_matrix = reference_matrix.GetRows(
-        static_cast<int>(lag * reference_signal.sample_rate),
-        reference_matrix.NumRows() - 1);
-    // Truncate the zeros off the deg matrix as well.
-    new_degraded_matrix = degraded_matrix.GetRows(
-        static_cast<int>(lag * degraded_signal.sample_rate),
-        reference_matrix.NumRows() - 1);
-  }
+std::tuple<AudioSignalView, AudioSignalView, double>
+Alignment::AlignAndTruncate(const AudioSignalView& reference_signal,
+                            const AudioSignalView& degraded_signal) {
+  return Truncate(reference_signal, degraded_signal,
+                  Alignment::GloballyAlign(reference_signal, degraded_signal));
+}
 
-  AudioSignal new_degraded_signal{new_degraded_matrix,
-                                  degraded_signal.sample_rate};
-  AudioSignal new_reference_signal{new_reference_matrix,
-                                   reference_signal.sample_rate};
-  return std::make_tuple(new_reference_signal, new_degraded_signal, lag);
+std::tuple<AudioSignalView, AudioSignalView, double>
+Alignment::AlignAndTruncate(const AudioSignalView& reference_signal,
+                            const AudioSignalView& degraded_signal,
+                            int64_t max_lag) {
+  return Truncate(
+      reference_signal, degraded_signal,
+      Alignment::GloballyAlign(reference_signal, degraded_signal, max_lag));
+}
+
+std::tuple<AudioSignalView, double> Alignment::GloballyAlign(
+    const AudioSignalView& reference_signal,
+    const AudioSignalView& degraded_signal) {
+  return GloballyAlign(reference_signal,
+                       Envelope::CalcUpperEnv(reference_signal),
+                       degraded_signal);
+}
+
+std::tuple<AudioSignalView, double> Alignment::GloballyAlign(
+    const AudioSignalView& reference_signal,
+    const AMatrix<double>& reference_upper_env,
+    const AudioSignalView& degraded_signal) {
+  AMatrix<double> degraded_upper_env = Envelope::CalcUpperEnv(degraded_signal);
+  int64_t best_lag = FindEnvelopeLag(reference_upper_env, degraded_upper_env);
+  return ApplyLag(reference_signal, degraded_signal, best_lag);
 }
 
-std::tuple<AudioSignal, double> Alignment::GloballyAlign(
-    const AudioSignal& reference_signal, const AudioSignal& degraded_signal) {
-  const AMatrix<double>& reference_matrix = reference_signal.data_matrix;
-  const AMatrix<double>& degraded_matrix = degraded_signal.data_matrix;
+std::tuple<AudioSignalView, double> Alignment::GloballyAlign(
+    const AudioSignalView& reference_signal,
+    const AudioSignalView& degraded_signal, int64_t max_lag) {
   AMatrix<double> reference_upper_env =
-      Envelope::CalcUpperEnv(reference_matrix);
-  AMatrix<double> degraded_upper_env = Envelope::CalcUpperEnv(degraded_matrix);
+      Envelope::CalcUpperEnv(reference_signal);
+  AMatrix<double> degraded_upper_env = Envelope::CalcUpperEnv(degraded_signal);
   int64_t best_lag =
-      XCorr::FindLowestLagIndex(reference_upper_env, degraded_upper_env);
+      FindEnvelopeLag(reference_upper_env, degraded_upper_env, max_lag);
+  return ApplyLag(reference_signal, degraded_signal, best_lag);
+}
 
+std::tuple<AudioSignalView, double> Alignment::ApplyLag(
+    const AudioSignalView& reference_signal,
+    const AudioSignalView& degraded_signal, int64_t best_lag) {
   // Limit the lag to half a patch.
   if (best_lag == 0 ||
       std::abs(best_lag) >
-          static_cast<double>(reference_matrix.NumRows()) / 2.0) {
+          static_cast<double>(reference_signal.NumSamples()) / 2.0) {
     return std::make_tuple(degraded_signal, 0);
   } else {
-    // align degraded matrix
-    AMatrix<double> new_degraded_matrix;
+    // align degraded signal
     // If the same point of the reference comes after the degraded
-    // (negative lag), truncate the rows before the refrence.
+    // (negative lag), truncate the samples before the refrence.
     // If the reference comes before the degraded, prepend zeros
     // to the degraded.
-    if (best_lag < 0) {
-      new_degraded_matrix = degraded_matrix.GetRows(
-          std::abs(best_lag), degraded_matrix.NumRows() - 1);
-    } else {
-      new_degraded_matrix = AMatrix<double>::Filled(best_lag, 1, 0.0);
-      new_degraded_matrix = new_degraded_matrix.JoinVertically(degraded_matrix);
-    }
-    AudioSignal new_degraded_signal{std::move(new_degraded_matrix),
-                                    degraded_signal.sample_rate};
+    const AudioSignalView new_degraded_signal =
+        best_lag < 0 ? degraded_signal.Slice(std::abs(best_lag),
+                                             degraded_signal.NumSamples())
+                     : degraded_signal.Padded(best_lag, 0);
     return std::make_tuple(
         new_degraded_signal,
-        best_lag / static_cast<double>(degraded_signal.sample_rate));
+        best_lag / static_cast<double>(degraded_signal.GetSampleRate()));
+  }
+}
+
+std::tuple<AudioSignalView, AudioSignalView, double> Alignment::Truncate(
+    const AudioSignalView& reference_signal,
+    const AudioSignalView& degraded_signal,
+    const std::tuple<AudioSignalView, double>& alignment_result) {
+  // Take the aligned degraded signal.
+  const AudioSignalView& aligned_degraded_signal =
+      std::get<0>(alignment_result);
+  double lag = std::get<1>(alignment_result);
+  const size_t reference_length = reference_signal.NumSamples();
+  const size_t degraded_length = aligned_degraded_signal.NumSamples();
+  AudioSignalView new_reference_signal = reference_signal;
+  AudioSignalView new_degraded_signal = aligned_degraded_signal;
+
+  // Truncate the two aligned signals to match lengths.
+  // If the lag is positive or negative, the starts are aligned.
+  // (The front of degraded_signal is zero padded or truncated).
+  if (reference_length > degraded_length) {
+    new_reference_signal = reference_signal.Slice(0, degraded_length);
+  } else if (reference_length < degraded_length) {
+    // For positive lag, the beginning of ref is now aligned with zeros, so
+    // that amount should be truncated.
+    new_reference_signal = reference_signal.Slice(
+        static_cast<int>(lag * reference_signal.GetSampleRate()),
+        reference_length);
+    // Truncate the zeros off the deg signal as well.
+    new_degraded_signal = aligned_degraded_signal.Slice(
+        static_cast<int>(lag * degraded_signal.GetSampleRate()),
+        reference_length);
+  }
+
+  return std::make_tuple(new_reference_signal, new_degraded_signal, lag);
+}
+
+int64_t Alignment::FindEnvelopeLag(const AMatrix<double>& reference_env,
+                                   const AMatrix<double>& degraded_env) {
+  if (std::max(reference_env.NumRows(), degraded_env.NumRows()) <
+      kMinLengthForCoarseSearch) {
+    return XCorr::FindLowestLagIndex(reference_env, degraded_env);
+  }
+
+  // The envelopes are band-limited, so heavily decimated copies are enough to
+  // locate the correlation peaks to within a few decimated samples.
+  const std::vector<double> coarse_corrs = XCorr::CalcCrossCorrelation(
+      DecimateByBlockMean(reference_env, kEnvelopeDecimationFactor),
+      DecimateByBlockMean(degraded_env, kEnvelopeDecimationFactor));
+  const int64_t coarse_max_lag = (coarse_corrs.size() - 1) / 2;
+  const int64_t lag_limit =
+      static_cast<int64_t>(
+          std::max(reference_env.NumRows(), degraded_env.NumRows())) -
+      1;
+  return RefineCoarseLag(reference_env, degraded_env, coarse_corrs,
+                         -coarse_max_lag, lag_limit);
+}
+
+int64_t Alignment::FindEnvelopeLag(const AMatrix<double>& reference_env,
+                                   const AMatrix<double>& degraded_env,
+                                   int64_t max_lag) {
+  const int64_t lag_limit =
+      static_cast<int64_t>(
+          std::max(reference_env.NumRows(), degraded_env.NumRows())) -
+      1;
+  max_lag = std::max<int64_t>(0, std::min(max_lag, lag_limit));
+  const int64_t factor = static_cast<int64_t>(kEnvelopeDecimationFactor);
+  if (max_lag <= kRefinementRadius * factor) {
+    return XCorr::FindLowestLagIndexInRange(reference_env, degraded_env,
+                                            -max_lag, max_lag);
+  }
+
+  // Only the coarse lags that cover the bound are needed, so they are
+  // correlated directly in the time domain rather than through an FFT.
+  const AMatrix<double> reference_coarse =
+      DecimateByBlockMean(reference_env, kEnvelopeDecimationFactor);
+  const AMatrix<double> degraded_coarse =
+      DecimateByBlockMean(degraded_env, kEnvelopeDecimationFactor);
+  const int64_t coarse_max_lag = (max_lag + factor - 1) / factor;
+  std::vector<double> coarse_corrs(2 * coarse_max_lag + 1);
+  for (size_t i = 0; i < coarse_corrs.size(); ++i) {
+    coarse_corrs[i] = XCorr::CalcCorrelationAtLag(
+        reference_coarse, degraded_coarse,
+        static_cast<int64_t>(i) - coarse_max_lag);
+  }
+  return RefineCoarseLag(reference_env, degraded_env, coarse_corrs,
+                         -coarse_max_lag, max_lag);
+}
+
+int64_t Alignment::RefineCoarseLag(const AMatrix<double>& reference_env,
+                                   const AMatrix<double>& degraded_env,
+                                   const std::vector<double>& coarse_corrs,
+                                   int64_t lowest_coarse_lag,
+                                   int64_t max_lag) {
+  // Collect the local maxima of the coarse correlation, strongest first.
+  std::vector<size_t> peaks;
+  for (size_t i = 0; i < coarse_corrs.size(); ++i) {
+    const bool above_prev = i == 0 || coarse_corrs[i] >= coarse_corrs[i - 1];
+    const bool above_next =
+        i + 1 == coarse_corrs.size() || coarse_corrs[i] > coarse_corrs[i + 1];
+    if (above_prev && above_next) {
+      peaks.push_back(i);
+    }
+  }
+  const size_t num_candidates = std::min(peaks.size(), kNumCoarseCandidates);
+  std::partial_sort(peaks.begin(), peaks.begin() + num_candidates, peaks.end(),
+                    [&coarse_corrs](size_t a, size_t b) {
+                      return coarse_corrs[a] > coarse_corrs[b] ||
+                             (coarse_corrs[a] == coarse_corrs[b] && a < b);
+                    });
+
+  // Refine each candidate on envelopes decimated by a smaller factor, so the
+  // wide search around every coarse peak runs over a quarter of the samples.
+  const AMatrix<double> reference_mid =
+      DecimateByBlockMean(reference_env, kIntermediateDecimationFactor);
+  const AMatrix<double> degraded_mid =
+      DecimateByBlockMean(degraded_env, kIntermediateDecimationFactor);
+  const int64_t mid_step = static_cast<int64_t>(
+      kEnvelopeDecimationFactor / kIntermediateDecimationFactor);
+  const int64_t factor = static_cast<int64_t>(kIntermediateDecimationFactor);
+  const int64_t mid_max_lag = (max_lag + factor - 1) / factor;
+  std::vector<std::pair<double, int64_t>> mid_candidates;
+  for (size_t i = 0; i < num_candidates; ++i) {
+    const int64_t coarse_lag =
+        static_cast<int64_t>(peaks[i]) + lowest_coarse_lag;
+    const int64_t mid_lag = XCorr::FindLowestLagIndexInRange(
+        reference_mid, degraded_mid,
+        std::max((coarse_lag - kRefinementRadius) * mid_step, -mid_max_lag),
+        std::min((coarse_lag + kRefinementRadius) * mid_step, mid_max_lag));
+    mid_candidates.emplace_back(
+        XCorr::CalcCorrelationAtLag(reference_mid, degraded_mid, mid_lag),
+        mid_lag);
+  }
+  const size_t num_fine_candidates =
+      std::min(mid_candidates.size(), kNumFineCandidates);
+  std::partial_sort(mid_candidates.begin(),
+                    mid_candidates.begin() + num_fine_candidates,
+                    mid_candidates.end(),
+                    [](const std::pair<double, int64_t>& a,
+                       const std::pair<double, int64_t>& b) {
+                      return a.first > b.first ||
+                             (a.first == b.first && a.second < b.second);
+                    });
+
+  // Refine the strongest candidates at the full sample rate and keep the best.
+  // Ties resolve to the lowest lag, as they do in XCorr.
+  int64_t best_lag = 0;
+  double best_corr = -std::numeric_limits<double>::infinity();
+  for (size_t i = 0; i < num_fine_candidates; ++i) {
+    const int64_t mid_lag = mid_candidates[i].second;
+    const int64_t lag = XCorr::FindLowestLagIndexInRange(
+        reference_env, degraded_env,
+        std::max((mid_lag - kRefinementRadius) * factor, -max_lag),
+        std::min((mid_lag + kRefinementRadius) * factor, max_lag));
+    const double corr =
+        XCorr::CalcCorrelationAtLag(reference_env, degraded_env, lag);
+    if (corr > best_corr || (corr == best_corr && lag < best_lag)) {
+      best_corr = corr;
+      best_lag = lag;
+    }
+  }
+  return best_lag;
+}
+
+AMatrix<double> Alignment::DecimateByBlockMean(const AMatrix<double>& signal,
+                                               size_t factor) {
+  const size_t num_samples = signal.NumRows();
+  const size_t num_blocks = (num_samples + factor - 1) / factor;
+  std::vector<double> decimated(num_blocks);
+  const double* samples = signal.data();
+  for (size_t block = 0; block < num_blocks; ++block) {
+    const size_t start = block * factor;
+    const size_t end = std::min(start + factor, num_samples);
+    double sum = 0.0;
+    for (size_t i = start; i < end; ++i) {
+      sum += samples[i];
+    }
+    decimated[block] = sum / (end - start);
   }
+  return AMatrix<double>(decimated);
 }
 }  // namespace Visqol
@@ -15,6 +15,7 @@
 #include "amatrix.h"
 
 #include <armadillo>
+#include <cassert>
 #include <complex>
 #include <utility>
 #include <valarray>
@@ -28,6 +29,10 @@ inline AMatrix<T>::AMatrix(const AMatrix<T>& other) {
   matrix_ = arma::Mat<T>(other.matrix_);
 }
 
+template <typename T>
+inline AMatrix<T>::AMatrix(AMatrix<T>&& other) noexcept
+    : matrix_(std::move(other.matrix_)) {}
+
 template <typename T>
 inline AMatrix<T>::AMatrix(const arma::Mat<T>& mat) {
   matrix_ = mat;
@@ -122,6 +127,12 @@ inline AMatrix<T>& AMatrix<T>::operator=(const AMatrix<T>& other) {
   return *this;
 }
 
+template <typename T>
+inline AMatrix<T>& AMatrix<T>::operator=(AMatrix<T>&& other) noexcept {
+  matrix_ = std::move(other.matrix_);
+  return *this;
+}
+
 template <typename T>
 inline bool AMatrix<T>::operator==(const AMatrix<T>& other) const {
   if (matrix_.n_rows != other.matrix_.n_rows) return false;
@@ -171,6 +182,71 @@ inline AMatrix<T> AMatrix<T>::PointWiseDivide(const AMatrix<T>& m) const {
   return AMatrix<T>(std::move(matrix_ / m.matrix_));
 }
 
+template <typename T>
+inline AMatrix<T>& AMatrix<T>::operator+=(const AMatrix<T>& other) {
+  matrix_ += other.matrix_;
+  return *this;
+}
+
+template <typename T>
+inline AMatrix<T>& AMatrix<T>::operator+=(T v) {
+  matrix_ += v;
+  return *this;
+}
+
+template <typename T>
+inline AMatrix<T>& AMatrix<T>::operator-=(const AMatrix<T>& m) {
+  matrix_ -= m.matrix_;
+  return *this;
+}
+
+template <typename T>
+inline AMatrix<T>& AMatrix<T>::operator-=(T v) {
+  matrix_ -= v;
+  return *this;
+}
+
+template <typename T>
+inline AMatrix<T>& AMatrix<T>::operator*=(T v) {
+  matrix_ *= v;
+  return *this;
+}
+
+template <typename T>
+inline AMatrix<T>& AMatrix<T>::operator/=(T v) {
+  matrix_ /= v;
+  return *this;
+}
+
+template <typename T>
+inline AMatrix<T>& AMatrix<T>::PointWiseProductInPlace(const AMatrix<T>& m) {
+  matrix_ %= m.matrix_;
+  return *this;
+}
+
+template <typename T>
+inline AMatrix<T>& AMatrix<T>::PointWiseDivideInPlace(const AMatrix<T>& m) {
+  matrix_ /= m.matrix_;
+  return *this;
+}
+
+template <typename T>
+inline AMatrix<T>& AMatrix<T>::MultiplyAdd(const AMatrix<T>& a,
+                                           const AMatrix<T>& b, T scale) {
+  // The elements are accessed directly, so the sizes are not checked by
+  // armadillo as they are for the other arithmetic operators.
+  assert(a.NumRows() == NumRows() && a.NumCols() == NumCols());
+  assert(b.NumRows() == NumRows() && b.NumCols() == NumCols());
+  T* out = matrix_.memptr();
+  const T* a_data = a.matrix_.memptr();
+  const T* b_data = b.matrix_.memptr();
+  const size_t num_elements = matrix_.n_elem;
+  for (size_t i = 0; i < num_elements; i++) {
+    out[i] += a_data[i] * b_data[i] * scale;
+  }
+  return *this;
+}
+
 template <typename T>
 inline AMatrix<T> AMatrix<T>::Transpose() const {
   return AMatrix<T>{std::move(trans(matrix_))};
@@ -0,0 +1,286 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "audio_archive.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+
+namespace Visqol {
+
+namespace {
+// Tar archives are made of 512 byte blocks. Each member has a header block,
+// followed by its contents padded to a whole number of blocks.
+const size_t kBlockSize = 512;
+
+// The offsets and sizes of the header fields that are used.
+const size_t kNameOffset = 0;
+const size_t kNameSize = 100;
+const size_t kSizeOffset = 124;
+const size_t kSizeSize = 12;
+const size_t kChecksumOffset = 148;
+const size_t kChecksumSize = 8;
+const size_t kTypeOffset = 156;
+const size_t kMagicOffset = 257;
+const size_t kPrefixOffset = 345;
+const size_t kPrefixSize = 155;
+
+// The magic of POSIX ustar headers, including its NUL terminator. GNU tar
+// headers have a different magic and use the prefix field for other data.
+const char kUstarMagic[] = "ustar";
+
+// The member types that are used.
+const char kRegularType = '0';
+const char kOldRegularType = '\0';
+const char kContiguousType = '7';
+const char kGnuLongNameType = 'L';
+const char kPaxHeaderType = 'x';
+
+// Read a string field, which is NUL terminated unless it fills the field.
+std::string ReadString(const char* header, size_t offset, size_t size) {
+  const char* field = header + offset;
+  return std::string(field, strnlen(field, size));
+}
+
+// Read a numeric field. These are octal, padded with spaces or NULs, or
+// base-256 with the high bit of the first byte set for values that are too
+// large for octal.
+bool ReadNumber(const char* header, size_t offset, size_t size,
+                uint64_t* value) {
+  const unsigned char* field =
+      reinterpret_cast<const unsigned char*>(header + offset);
+  *value = 0;
+  if (field[0] & 0x80) {
+    // Negative base-256 values are not valid sizes.
+    if (field[0] & 0x40) {
+      return false;
+    }
+    *value = field[0] & 0x3f;
+    for (size_t i = 1; i < size; i++) {
+      if (*value >> 56) {
+        return false;
+      }
+      *value = (*value << 8) | field[i];
+    }
+    return true;
+  }
+
+  size_t i = 0;
+  while (i < size && field[i] == ' ') {
+    i++;
+  }
+  bool has_digits = false;
+  for (; i < size && field[i] >= '0' && field[i] <= '7'; i++) {
+    *value = *value * 8 + (field[i] - '0');
+    has_digits = true;
+  }
+  for (; i < size; i++) {
+    if (field[i] != ' ' && field[i] != '\0') {
+      return false;
+    }
+  }
+  return has_digits;
+}
+
+bool IsZeroBlock(const char* block) {
+  for (size_t i = 0; i < kBlockSize; i++) {
+    if (block[i] != '\0') {
+      return false;
+    }
+  }
+  return true;
+}
+
+// The checksum is the sum of the header bytes, with the checksum field
+// itself counted as spaces. Some old archivers summed signed bytes, so both
+// sums are accepted.
+bool ChecksumMatches(const char* header) {
+  uint64_t expected;
+  if (!ReadNumber(header, kChecksumOffset, kChecksumSize, &expected)) {
+    return false;
+  }
+  uint64_t unsigned_sum = 0;
+  int64_t signed_sum = 0;
+  for (size_t i = 0; i < kBlockSize; i++) {
+    const bool is_checksum =
+        i >= kChecksumOffset && i < kChecksumOffset + kChecksumSize;
+    const char byte = is_checksum ? ' ' : header[i];
+    unsigned_sum += static_cast<unsigned char>(byte);
+    signed_sum += static_cast<signed char>(byte);
+  }
+  return unsigned_sum == expected ||
+         signed_sum == static_cast<int64_t>(expected);
+}
+
+// The name of a member as it is looked up, without a leading "./".
+std::string NormalizeName(absl::string_view name) {
+  while (absl::StartsWith(name, "./")) {
+    name.remove_prefix(2);
+  }
+  return std::string(name);
+}
+
+// Parse the records of a pax extended header, which have the form
+// "<length> <key>=<value>\n", where the length includes the whole record. The
+// path and size override the fields of the next header.
+bool ParsePaxRecords(absl::string_view records,
+                     absl::optional<std::string>* path,
+                     absl::optional<uint64_t>* size) {
+  while (!records.empty()) {
+    const size_t space = records.find(' ');
+    size_t length;
+    if (space == absl::string_view::npos ||
+        !absl::SimpleAtoi(records.substr(0, space), &length) ||
+        length <= space + 1 || length > records.size() ||
+        records[length - 1] != '\n') {
+      return false;
+    }
+    const absl::string_view record =
+        records.substr(space + 1, length - space - 2);
+    const size_t equals = record.find('=');
+    if (equals == absl::string_view::npos) {
+      return false;
+    }
+    const absl::string_view key = record.substr(0, equals);
+    const absl::string_view value = record.substr(equals + 1);
+    if (key == "path") {
+      *path = std::string(value);
+    } else if (key == "size") {
+      uint64_t member_size;
+      if (!absl::SimpleAtoi(value, &member_size)) {
+        return false;
+      }
+      *size = member_size;
+    }
+    records.remove_prefix(length);
+  }
+  return true;
+}
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<AudioArchive>> AudioArchive::Open(
+    const FilePath& path) {
+  auto file_statusor = MappedFile::Open(path);
+  if (!file_statusor.ok()) {
+    return file_statusor.status();
+  }
+  std::unique_ptr<AudioArchive> archive(
+      new AudioArchive(std::move(file_statusor).value()));
+  const absl::Status status = archive->Index(path);
+  if (!status.ok()) {
+    return status;
+  }
+  return archive;
+}
+
+AudioArchive::AudioArchive(std::unique_ptr<MappedFile> file)
+    : file_(std::move(file)) {}
+
+absl::Status AudioArchive::Index(const FilePath& path) {
+  const absl::Span<const char> contents = file_->Contents();
+  auto invalid = [&path](absl::string_view reason) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Invalid tar archive ", path.Path(), ": ", reason));
+  };
+
+  // Long names and pax records apply to the member that follows them.
+  absl::optional<std::string> next_name;
+  absl::optional<uint64_t> next_size;
+  size_t offset = 0;
+  while (offset < contents.size()) {
+    if (contents.size() - offset < kBlockSize) {
+      return invalid("truncated header");
+    }
+    const char* header = contents.data() + offset;
+    // The archive ends with zero blocks.
+    if (IsZeroBlock(header)) {
+      break;
+    }
+    if (!ChecksumMatches(header)) {
+      return invalid(absl::StrCat("bad header checksum at offset ", offset));
+    }
+
+    const char type = header[kTypeOffset];
+    const bool is_regular_file = type == kRegularType ||
+                                 type == kOldRegularType ||
+                                 type == kContiguousType;
+    uint64_t size;
+    if (!ReadNumber(header, kSizeOffset, kSizeSize, &size)) {
+      return invalid(absl::StrCat("bad member size at offset ", offset));
+    }
+    if (is_regular_file && next_size.has_value()) {
+      size = next_size.value();
+    }
+    const size_t data_offset = offset + kBlockSize;
+    if (size > contents.size() - data_offset) {
+      return invalid(absl::StrCat("truncated member at offset ", offset));
+    }
+    const absl::string_view data(contents.data() + data_offset, size);
+
+    if (type == kGnuLongNameType) {
+      next_name = std::string(data.data(), strnlen(data.data(), data.size()));
+    } else if (type == kPaxHeaderType) {
+      if (!ParsePaxRecords(data, &next_name, &next_size)) {
+        return invalid(absl::StrCat("bad pax header at offset ", offset));
+      }
+    } else {
+      if (is_regular_file) {
+        std::string name;
+        if (next_name.has_value()) {
+          name = next_name.value();
+        } else {
+          name = ReadString(header, kNameOffset, kNameSize);
+          const std::string prefix =
+              ReadString(header, kPrefixOffset, kPrefixSize);
+          if (std::memcmp(header + kMagicOffset, kUstarMagic,
+                          sizeof(kUstarMagic)) == 0 &&
+              !prefix.empty()) {
+            name = absl::StrCat(prefix, "/", name);
+          }
+        }
+        // A later member replaces an earlier one with the same name, as it
+        // would when the archive is extracted.
+        members_[NormalizeName(name)] = absl::Span<const char>(data);
+      }
+      next_name.reset();
+      next_size.reset();
+    }
+    offset = data_offset + (size + kBlockSize - 1) / kBlockSize * kBlockSize;
+  }
+  return absl::Status();
+}
+
+absl::optional<absl::Span<const char>> AudioArchive::Find(
+    absl::string_view name) const {
+  const auto it = members_.find(NormalizeName(name));
+  if (it == members_.end()) {
+    return absl::nullopt;
+  }
+  return it->second;
+}
+
+size_t AudioArchive::NumMembers() const { return members_.size(); }
+
+}  // namespace Visqol
@@ -0,0 +1,148 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "audio_prefetcher.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <system_error>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "absl/synchronization/mutex.h"
+
+namespace Visqol {
+
+const size_t AudioPrefetcher::kMaxLoadThreads = 8;
+const size_t AudioPrefetcher::kSignalBytesPerFileByte =
+    sizeof(double) / sizeof(int16_t);
+
+size_t LoadedComparison::SignalBytes() const {
+  return (reference.data_matrix.NumElements() +
+          degraded.data_matrix.NumElements()) *
+         sizeof(double);
+}
+
+AudioPrefetcher::AudioPrefetcher(NextPairFunction next_pair, LoadFunction load,
+                                 size_t depth, size_t max_bytes,
+                                 EstimateFunction estimate)
+    : next_pair_(std::move(next_pair)),
+      load_(std::move(load)),
+      estimate_(std::move(estimate)),
+      depth_(std::max<size_t>(depth, 1)),
+      max_bytes_(max_bytes) {
+  const size_t num_threads = std::min(depth_, kMaxLoadThreads);
+  for (size_t i = 0; i < num_threads; i++) {
+    threads_.emplace_back([this]() { LoadLoop(); });
+  }
+}
+
+AudioPrefetcher::~AudioPrefetcher() {
+  Stop();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+bool AudioPrefetcher::Next(LoadedComparison* comparison) {
+  absl::MutexLock lock(&mutex_);
+  auto next_ready = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return stopped_ || (!slots_.empty() && slots_.front().loaded) ||
+           (exhausted_ && slots_.empty());
+  };
+  mutex_.Await(absl::Condition(&next_ready));
+  if (stopped_ || slots_.empty()) {
+    return false;
+  }
+
+  loaded_bytes_ -= slots_.front().comparison.SignalBytes();
+  *comparison = std::move(slots_.front().comparison);
+  slots_.pop_front();
+  return true;
+}
+
+void AudioPrefetcher::Stop() {
+  absl::MutexLock lock(&mutex_);
+  stopped_ = true;
+}
+
+size_t AudioPrefetcher::EstimateSignalBytes(
+    const ReferenceDegradedPathPair& paths) {
+  size_t file_bytes = 0;
+  for (const FilePath* path : {&paths.reference, &paths.degraded}) {
+    std::error_code error;
+    if (std::filesystem::is_regular_file(path->Path(), error)) {
+      const uintmax_t size = std::filesystem::file_size(path->Path(), error);
+      if (!error) {
+        file_bytes += size;
+      }
+    }
+  }
+  return file_bytes * kSignalBytesPerFileByte;
+}
+
+void AudioPrefetcher::LoadLoop() {
+  while (true) {
+    Slot* slot;
+    {
+      absl::MutexLock manifest_lock(&manifest_mutex_);
+      {
+        absl::MutexLock lock(&mutex_);
+        auto has_room = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+          return stopped_ || slots_.size() < depth_;
+        };
+        mutex_.Await(absl::Condition(&has_room));
+        if (stopped_ || exhausted_) {
+          return;
+        }
+      }
+
+      // Read the pair without holding mutex_, since next_pair_ may block.
+      ReferenceDegradedPathPair pair;
+      if (!next_pair_(&pair)) {
+        absl::MutexLock lock(&mutex_);
+        exhausted_ = true;
+        return;
+      }
+      const size_t estimate = estimate_(pair);
+
+      absl::MutexLock lock(&mutex_);
+      // Always allow one comparison to load, however large, so that the batch
+      // makes progress.
+      auto fits = [this, estimate]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+        return stopped_ || slots_.empty() ||
+               loaded_bytes_ + reserved_bytes_ + estimate <= max_bytes_;
+      };
+      mutex_.Await(absl::Condition(&fits));
+      if (stopped_) {
+        return;
+      }
+      slots_.emplace_back();
+      slot = &slots_.back();
+      slot->comparison.index = next_index_++;
+      slot->comparison.paths = pair;
+      slot->reserved_bytes = estimate;
+      reserved_bytes_ += estimate;
+    }
+
+    // The slot is not read by other threads until it is marked as loaded.
+    load_(&slot->comparison);
+
+    absl::MutexLock lock(&mutex_);
+    slot->loaded = true;
+    reserved_bytes_ -= slot->reserved_bytes;
+    loaded_bytes_ += slot->comparison.SignalBytes();
+  }
+}
+}  // namespace Visqol
@@ -0,0 +1,86 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "audio_signal_view.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/base/macros.h"
+#include "amatrix.h"
+
+namespace Visqol {
+
+AudioSignalView::AudioSignalView(const AudioSignal& signal)
+    : samples_(signal.data_matrix.data(), signal.data_matrix.NumRows()),
+      sample_rate_(signal.sample_rate) {}
+
+AudioSignalView::AudioSignalView(absl::Span<const double> samples,
+                                 size_t sample_rate)
+    : samples_(samples), sample_rate_(sample_rate) {}
+
+AudioSignalView AudioSignalView::Slice(size_t start, size_t end) const {
+  end = std::min(end, NumSamples());
+  start = std::min(start, end);
+  const size_t samples_start = num_leading_zeros_;
+  const size_t samples_end = samples_start + samples_.size();
+  const size_t first = std::clamp(start, samples_start, samples_end);
+  const size_t last = std::clamp(end, samples_start, samples_end);
+
+  AudioSignalView view = *this;
+  view.samples_ = samples_.subspan(first - samples_start, last - first);
+  view.num_leading_zeros_ =
+      std::min(end, samples_start) - std::min(start, samples_start);
+  view.num_trailing_zeros_ =
+      std::max(end, samples_end) - std::max(start, samples_end);
+  return view;
+}
+
+AudioSignalView AudioSignalView::Padded(size_t num_leading_zeros,
+                                        size_t num_trailing_zeros) const {
+  AudioSignalView view = *this;
+  view.num_leading_zeros_ += num_leading_zeros;
+  view.num_trailing_zeros_ += num_trailing_zeros;
+  return view;
+}
+
+AudioSignalView AudioSignalView::Scaled(double gain) const {
+  AudioSignalView view = *this;
+  view.gain_ *= gain;
+  return view;
+}
+
+void AudioSignalView::CopySamples(size_t start, size_t count,
+                                  double* out) const {
+  ABSL_ASSERT(start + count <= NumSamples());
+  const AudioSignalView range = Slice(start, start + count);
+  std::fill_n(out, range.num_leading_zeros_, 0.0);
+  out += range.num_leading_zeros_;
+  if (gain_ == 1.0) {
+    out = std::copy(range.samples_.begin(), range.samples_.end(), out);
+  } else {
+    out = std::transform(range.samples_.begin(), range.samples_.end(), out,
+                         [this](double sample) { return gain_ * sample; });
+  }
+  std::fill_n(out, range.num_trailing_zeros_, 0.0);
+}
+
+AudioSignal AudioSignalView::ToSignal() const {
+  AMatrix<double> data_matrix(NumSamples(), 1);
+  if (NumSamples() > 0) {
+    CopySamples(0, NumSamples(), data_matrix.begin());
+  }
+  return AudioSignal{std::move(data_matrix), sample_rate_};
+}
+}  // namespace Visqol
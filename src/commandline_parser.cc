@@ -14,8 +14,6 @@
 
 #include "commandline_parser.h"
 
-#include <fstream>
-#include <sstream>
 #include <string>
 #include <vector>
 
@@ -28,11 +26,16 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "manifest_reader.h"
+#include "wav_reader.h"
 
 ABSL_FLAG(std::string, reference_file, "",
-          "The wav file path used as the reference audio.");
+          "The wav file path used as the reference audio. Use `-` to read "
+          "the reference audio from the standard input.");
 ABSL_FLAG(std::string, degraded_file, "",
-          "The wav file path used as the degraded audio.");
+          "The wav file path used as the degraded audio. Use `-` to read "
+          "the degraded audio from the standard input.");
 ABSL_FLAG(std::string, batch_input_csv, "",
           "Used to specify a path to a CSV file with the format: \n"
           "------------------\n"
@@ -41,7 +44,14 @@ ABSL_FLAG(std::string, batch_input_csv, "",
           "ref2.wav,deg2.wav\n"
           "------------------\n"
           "If the `batch_input_csv` flag is used, the `reference_file` \n"
-          "and `degraded_file` flags will be ignored.");
+          "and `degraded_file` flags will be ignored. Use `-` to read the \n"
+          "batch input from the standard input.");
+ABSL_FLAG(std::string, batch_input_archive, "",
+          "The path to an uncompressed tar archive holding the audio files of "
+          "the batch. The paths in the `batch_input_csv` file are then the "
+          "names of members of the archive, which is mapped into memory "
+          "once instead of opening each file. Cannot be used with "
+          "`result_cache_dir`.");
 ABSL_FLAG(std::string, results_csv, "",
           "Used to specify a path that the similarity score results will be "
           "output to \n"
@@ -88,6 +98,55 @@ ABSL_FLAG(int, search_window_radius, 60,
           "optimal match.");
 ABSL_FLAG(bool, disable_global_alignment, false, "Disables global alignment");
 ABSL_FLAG(bool, disable_realignment, false, "Disables realignment");
+ABSL_FLAG(bool, bounded_realignment, false,
+          "Restricts patch realignment to lags of up to half a spectrogram "
+          "frame hop. This is faster, but scores for badly aligned inputs may "
+          "differ from the conformance scores.");
+ABSL_FLAG(bool, resample_input, false,
+          "Resample the input audio when it is loaded, to 48kHz in audio mode "
+          "or to 16kHz in speech mode, instead of scoring it at its own "
+          "sample rate.");
+ABSL_FLAG(bool, multirate_filterbank, false,
+          "Filter the low frequency gammatone bands at a reduced sample rate. "
+          "This is faster, but scores may differ slightly from the "
+          "conformance scores.");
+ABSL_FLAG(std::string, raw_pcm_format, "",
+          "Read the input audio as raw interleaved little endian samples in "
+          "this format instead of as WAV files: s16le, s24le or s32le for "
+          "integer samples, or f32le or f64le for float samples. The sample "
+          "rate and channel count are given by `raw_pcm_sample_rate` and "
+          "`raw_pcm_channels`.");
+ABSL_FLAG(int, raw_pcm_sample_rate, 48000,
+          "The sample rate of raw PCM input, in Hz.");
+ABSL_FLAG(int, raw_pcm_channels, 1,
+          "The number of interleaved channels in raw PCM input.");
+ABSL_FLAG(bool, resume, false,
+          "Resume an interrupted batch run. Comparisons that are already in "
+          "the `results_csv` file are skipped, and only new results are "
+          "appended to it.");
+ABSL_FLAG(int, shard_index, 0,
+          "The index of the batch shard to run, from 0 to `num_shards` - 1. "
+          "Only the pairs assigned to this shard are compared.");
+ABSL_FLAG(int, num_shards, 1,
+          "The number of shards to split the batch into. Pairs are assigned "
+          "to shards by a stable hash of their file paths, so the shards can "
+          "be run by separate processes or hosts. Use visqol_merge_shards to "
+          "combine their results.");
+ABSL_FLAG(std::string, result_cache_dir, "",
+          "A directory to cache comparison results in. Results are keyed by "
+          "the audio content of the files and the scoring configuration, so "
+          "a comparison of the same audio under different file names is only "
+          "scored once. The directory may be shared by concurrent runs.");
+ABSL_FLAG(int, prefetch_depth, 0,
+          "The number of batch comparisons to load ahead on background "
+          "threads while earlier comparisons are scored. 0 loads each "
+          "comparison when it is scored.");
+ABSL_FLAG(int, prefetch_max_mb, 1024,
+          "The megabytes of memory that the loaded audio, and an estimate "
+          "from the file sizes of the comparisons still loading, may use.");
+ABSL_FLAG(int, num_threads, 1,
+          "The number of threads used to run the comparisons in batch mode. "
+          "Results are output in the same order as the batch input.");
 
 namespace Visqol {
 ABSL_CONST_INIT const char kDefaultAudioModelFile[] =
@@ -109,7 +168,9 @@ absl::StatusOr<CommandLineArgs> VisqolCommandLineParser::Parse(int argc,
   FilePath similarity_to_quality_model;
   FilePath result_output_csv;
   FilePath batch_input;
+  FilePath batch_input_archive;
   FilePath debug_output;
+  FilePath result_cache_dir;
   bool verbose;
   bool use_speech;
   bool use_lattice_model;
@@ -117,16 +178,38 @@ absl::StatusOr<CommandLineArgs> VisqolCommandLineParser::Parse(int argc,
   int search_window;
   bool disable_global_alignment;
   bool disable_realignment;
+  bool bounded_realignment;
+  bool resample_input;
+  bool multirate_filterbank;
+  absl::optional<WavReader::PcmFormat> raw_pcm_format;
+  int num_threads;
+  int prefetch_depth;
+  int prefetch_max_mb;
+  bool resume;
+  int shard_index;
+  int num_shards;
 
   batch_input = FilePath(absl::GetFlag(FLAGS_batch_input_csv));
   if (!batch_input.Path().empty()) {
-    error_found |= !FileExists(batch_input);
+    if (batch_input.Path() != ManifestReader::kStdinPath) {
+      error_found |= !FileExists(batch_input);
+    }
   } else {
     reference_file = FilePath(absl::GetFlag(FLAGS_reference_file));
-    error_found |= !FileExists(reference_file);
-
     degraded_file = FilePath(absl::GetFlag(FLAGS_degraded_file));
-    error_found |= !FileExists(degraded_file);
+    if (reference_file.Path() == ManifestReader::kStdinPath &&
+        degraded_file.Path() == ManifestReader::kStdinPath) {
+      ABSL_RAW_LOG(ERROR,
+                   "Only one of the reference and degraded audio can be read "
+                   "from the standard input.");
+      error_found = true;
+    }
+    if (reference_file.Path() != ManifestReader::kStdinPath) {
+      error_found |= !FileExists(reference_file);
+    }
+    if (degraded_file.Path() != ManifestReader::kStdinPath) {
+      error_found |= !FileExists(degraded_file);
+    }
   }
 
   result_output_csv = FilePath(absl::GetFlag(FLAGS_results_csv));
@@ -136,8 +219,72 @@ absl::StatusOr<CommandLineArgs> VisqolCommandLineParser::Parse(int argc,
   verbose = absl::GetFlag(FLAGS_verbose);
   search_window = absl::GetFlag(FLAGS_search_window_radius);
   debug_output = FilePath(absl::GetFlag(FLAGS_output_debug));
+  result_cache_dir = FilePath(absl::GetFlag(FLAGS_result_cache_dir));
+  batch_input_archive = FilePath(absl::GetFlag(FLAGS_batch_input_archive));
+  if (!batch_input_archive.Path().empty()) {
+    if (batch_input.Path().empty()) {
+      ABSL_RAW_LOG(ERROR, "An input archive requires a batch input CSV file.");
+      error_found = true;
+    }
+    // The cache digests the audio files by path, which are not files here.
+    if (!result_cache_dir.Path().empty()) {
+      ABSL_RAW_LOG(ERROR,
+                   "The result cache cannot be used with an input archive.");
+      error_found = true;
+    }
+    error_found |= !FileExists(batch_input_archive);
+  }
   disable_global_alignment = absl::GetFlag(FLAGS_disable_global_alignment);
   disable_realignment = absl::GetFlag(FLAGS_disable_realignment);
+  bounded_realignment = absl::GetFlag(FLAGS_bounded_realignment);
+  resample_input = absl::GetFlag(FLAGS_resample_input);
+  multirate_filterbank = absl::GetFlag(FLAGS_multirate_filterbank);
+  const std::string raw_pcm_format_name = absl::GetFlag(FLAGS_raw_pcm_format);
+  if (!raw_pcm_format_name.empty()) {
+    WavReader::PcmFormat format;
+    format.sample_rate_hz = absl::GetFlag(FLAGS_raw_pcm_sample_rate);
+    const int num_channels = absl::GetFlag(FLAGS_raw_pcm_channels);
+    if (!WavReader::ParseSampleFormat(raw_pcm_format_name,
+                                      &format.sample_format)) {
+      ABSL_RAW_LOG(ERROR, "Unknown raw PCM format: %s",
+                   raw_pcm_format_name.c_str());
+      error_found = true;
+    }
+    if (format.sample_rate_hz < 1 || num_channels < 1) {
+      ABSL_RAW_LOG(ERROR,
+                   "The raw PCM sample rate and number of channels must be at "
+                   "least 1.");
+      error_found = true;
+    }
+    format.num_channels = num_channels;
+    raw_pcm_format = format;
+  }
+  resume = absl::GetFlag(FLAGS_resume);
+  if (resume && result_output_csv.Path().empty()) {
+    ABSL_RAW_LOG(ERROR, "Resuming requires a results CSV file.");
+    error_found = true;
+  }
+  shard_index = absl::GetFlag(FLAGS_shard_index);
+  num_shards = absl::GetFlag(FLAGS_num_shards);
+  if (num_shards < 1 || shard_index < 0 || shard_index >= num_shards) {
+    ABSL_RAW_LOG(ERROR,
+                 "The shard index must be from 0 to the number of shards - 1.");
+    error_found = true;
+  }
+  num_threads = absl::GetFlag(FLAGS_num_threads);
+  if (num_threads < 1) {
+    ABSL_RAW_LOG(ERROR, "The number of threads must be at least 1.");
+    error_found = true;
+  }
+
+  prefetch_depth = absl::GetFlag(FLAGS_prefetch_depth);
+  prefetch_max_mb = absl::GetFlag(FLAGS_prefetch_max_mb);
+  if (prefetch_depth < 0 || prefetch_max_mb < 1) {
+    ABSL_RAW_LOG(ERROR,
+                 "The prefetch depth must be at least 0 and the prefetch "
+                 "memory limit at least 1 MB.");
+    error_found = true;
+  }
 
   similarity_to_quality_model =
       FilePath(absl::GetFlag(FLAGS_similarity_to_quality_model));
@@ -176,6 +323,7 @@ absl::StatusOr<CommandLineArgs> VisqolCommandLineParser::Parse(int argc,
       .similarity_to_quality_mapper_model = similarity_to_quality_model,
       .results_output_csv = result_output_csv,
       .batch_input_csv = batch_input,
+      .batch_input_archive = batch_input_archive,
       .debug_output_path = debug_output,
       .verbose = verbose,
       .use_speech_mode = use_speech,
@@ -183,40 +331,40 @@ absl::StatusOr<CommandLineArgs> VisqolCommandLineParser::Parse(int argc,
       .search_window_radius = search_window,
       .use_lattice_model = use_lattice_model,
       .disable_global_alignment = disable_global_alignment,
-      .disable_realignment = disable_realignment};
+      .disable_realignment = disable_realignment,
+      .bounded_realignment = bounded_realignment,
+      .resample_input = resample_input,
+      .multirate_filterbank = multirate_filterbank,
+      .raw_pcm_format = raw_pcm_format,
+      .num_threads = num_threads,
+      .resume = resume,
+      .shard_index = shard_index,
+      .num_shards = num_shards,
+      .result_cache_dir = result_cache_dir,
+      .prefetch_depth = prefetch_depth,
+      .prefetch_max_mb = prefetch_max_mb};
 }
 
 std::vector<ReferenceDegradedPathPair>
 VisqolCommandLineParser::ReadFilesToCompare(const FilePath& batch_input_path) {
   std::vector<ReferenceDegradedPathPair> file_paths;
-  std::vector<FilePath> line_file_paths;
-  std::ifstream fin(batch_input_path.Path());
-  std::string item, line;
-  const char delimiter = ',';
-
-  if (fin) {
-    getline(fin, line);  // skip the header
-
-    while (getline(fin, line)) {
-      // getline will read up to \n, so in cases where the line ending is \r\n,
-      // we need to manually strip the \r.
-      if (line.back() == '\r') {
-        line.pop_back();
-      }
-      std::istringstream in(line);
-
-      while (std::getline(in, item, delimiter)) {
-        line_file_paths.push_back(FilePath(item));
-      }
-      file_paths.push_back({line_file_paths[0], line_file_paths[1]});
-      line_file_paths.clear();
-    }
-    fin.close();
+  auto reader_statusor = ManifestReader::Open(batch_input_path);
+  if (!reader_statusor.ok()) {
+    ABSL_RAW_LOG(ERROR, "%s", reader_statusor.status().ToString().c_str());
+    return file_paths;
   }
 
+  ReferenceDegradedPathPair pair;
+  while (reader_statusor.value()->Next(&pair)) {
+    file_paths.push_back(pair);
+  }
   return file_paths;
 }
 
+bool VisqolCommandLineParser::IsReadableInput(const FilePath& path) {
+  return path.Path() == ManifestReader::kStdinPath || path.Exists();
+}
+
 bool VisqolCommandLineParser::FileExists(const FilePath& path) {
   bool exists = path.Exists();
   if (!exists) {
@@ -230,8 +378,8 @@ VisqolCommandLineParser::BuildFilePairPaths(const CommandLineArgs& cmd_res) {
   std::vector<ReferenceDegradedPathPair> pairs;
   if (!cmd_res.batch_input_csv.Path().empty()) {
     pairs = ReadFilesToCompare(cmd_res.batch_input_csv);
-  } else if (cmd_res.reference_signal_path.Exists() &&
-             cmd_res.degraded_signal_path.Exists()) {
+  } else if (IsReadableInput(cmd_res.reference_signal_path) &&
+             IsReadableInput(cmd_res.degraded_signal_path)) {
     pairs.push_back(
         {cmd_res.reference_signal_path, cmd_res.degraded_signal_path});
   }
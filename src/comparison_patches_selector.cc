@@ -16,6 +16,7 @@
 
 #include <assert.h>
 
+#include <algorithm>
 #include <limits>
 #include <memory>
 #include <utility>
@@ -33,8 +34,10 @@
 
 namespace Visqol {
 ComparisonPatchesSelector::ComparisonPatchesSelector(
-    std::unique_ptr<PatchSimilarityComparator> sim_comparator)
-    : sim_comparator_{std::move(sim_comparator)} {}
+    std::unique_ptr<PatchSimilarityComparator> sim_comparator,
+    bool bounded_realignment)
+    : sim_comparator_{std::move(sim_comparator)},
+      bounded_realignment_{bounded_realignment} {}
 
 void ComparisonPatchesSelector::FindMostOptimalDegPatch(
     const AMatrix<double>& spectrogram_data, const ImagePatch& ref_patch,
@@ -243,67 +246,65 @@ ComparisonPatchesSelector::FindMostOptimalDegPatches(
 ImagePatch ComparisonPatchesSelector::BuildDegradedPatch(
     const AMatrix<double>& spectrogram_data, int window_beginning,
     size_t window_end, size_t window_height, size_t window_width) const {
-  ImagePatch deg_patch{window_height, window_width};
-  std::vector<double> row;
+  ImagePatch deg_patch =
+      ImagePatch::Filled(window_height, window_width, 0.0);
 
   // We should allow negative starts to allow the degraded signal to come first.
-  // Each row is a frequency band.
-
+  // Frames outside of the spectrogram are left silent.
   int first_real_frame = std::max(0, window_beginning);
   // This is an inclusive end, so subtract 1.
   int last_real_frame = std::min(window_end, spectrogram_data.NumCols() - 1);
-  for (size_t rowIndex = 0; rowIndex < spectrogram_data.NumRows(); rowIndex++) {
-    row =
-        spectrogram_data.RowSubset(rowIndex, first_real_frame, last_real_frame);
-
-    // Insert silence at front for negative indices.
-    if (window_beginning < 0) {
-      row.insert(row.begin(), 0 - window_beginning, 0.0);
-    }
-
-    if (window_end > spectrogram_data.NumCols() - 1) {
-      row.insert(row.end(), window_end - (spectrogram_data.NumCols() - 1), 0.0);
-    }
-
-    deg_patch.SetRow(rowIndex, std::move(row));
+  if (last_real_frame < first_real_frame) {
+    return deg_patch;
   }
+
+  // The spectrogram is column-major with a frequency band per row, so the
+  // frames of the window are a single contiguous block of memory.
+  const size_t num_bands = spectrogram_data.NumRows();
+  const size_t num_leading_frames = first_real_frame - window_beginning;
+  const double* frames_begin =
+      spectrogram_data.data() + first_real_frame * num_bands;
+  const double* frames_end =
+      spectrogram_data.data() + (last_real_frame + 1) * num_bands;
+  std::copy(frames_begin, frames_end,
+            deg_patch.mutData() + num_leading_frames * num_bands);
   return deg_patch;
 }
 
-AudioSignal ComparisonPatchesSelector::Slice(const AudioSignal& in_signal,
-                                             double start_time,
-                                             double end_time) {
-  int start_index = std::max(0, (int)(start_time * in_signal.sample_rate));
-  // The end_index is inclusive for GetRows().
-  int end_index = std::min((int)(in_signal.data_matrix.NumRows() - 1),
-                           (int)(end_time * in_signal.sample_rate));
+AudioSignalView ComparisonPatchesSelector::Slice(
+    const AudioSignalView& in_signal, double start_time, double end_time) {
+  const size_t sample_rate = in_signal.GetSampleRate();
+  const size_t num_samples = in_signal.NumSamples();
+  int start_index = std::max(0, (int)(start_time * sample_rate));
+  // The end_index is exclusive.
+  int end_index =
+      std::min((int)(num_samples - 1), (int)(end_time * sample_rate));
+  auto sliced_signal = in_signal.Slice(start_index, end_index);
 
-  // Note that the underlying armadillo rows() uses an unconventional inclusive
-  // end index.
-  auto sliced_matrix =
-      in_signal.data_matrix.GetRows(start_index, end_index - 1);
-  // Adds silence at the end of degraded patch, if required for alignment.
-  auto end_time_diff =
-      end_time * in_signal.sample_rate - in_signal.data_matrix.NumRows();
+  // Adds silence to the degraded patch, if required for alignment. The
+  // silence for both ends is placed at the start.
+  size_t num_zeros = 0;
+  auto end_time_diff = end_time * sample_rate - num_samples;
   if (end_time_diff > 0) {
-    auto postsilence_matrix = AMatrix<double>::Filled(end_time_diff, 1, 0.0);
-    sliced_matrix = postsilence_matrix.JoinVertically(sliced_matrix);
+    num_zeros += static_cast<size_t>(end_time_diff);
   }
   if (start_time < 0) {
-    auto presilence_matrix = AMatrix<double>::Filled(
-        -1 * start_time * in_signal.sample_rate, 1, 0.0);
-    sliced_matrix = presilence_matrix.JoinVertically(sliced_matrix);
+    num_zeros += static_cast<size_t>(-1 * start_time * sample_rate);
   }
-  AudioSignal sliced_signal{sliced_matrix, in_signal.sample_rate};
-  return sliced_signal;
+  return sliced_signal.Padded(num_zeros, 0);
 }
 
 absl::StatusOr<std::vector<PatchSimilarityResult>>
 ComparisonPatchesSelector::FinelyAlignAndRecreatePatches(
     const std::vector<PatchSimilarityResult>& sim_results,
-    const AudioSignal& ref_signal, const AudioSignal& deg_signal,
+    const AudioSignalView& ref_signal, const AudioSignalView& deg_signal,
     SpectrogramBuilder* spect_builder, const AnalysisWindow& window) const {
   std::vector<PatchSimilarityResult> realigned_results(sim_results.size());
+  // The patches were matched on the spectrogram frame grid, so any remaining
+  // misalignment is around half a frame hop. When bounded, only search lags
+  // up to that.
+  const int64_t max_lag =
+      static_cast<int64_t>(window.size * window.overlap / 2.0);
 
   // The patches are already matched.  Iterate over each pair.
   for (size_t i = 0; i < sim_results.size(); ++i) {
@@ -323,9 +324,12 @@ ComparisonPatchesSelector::FinelyAlignAndRecreatePatches(
     // 2. For any pair, we want to shift the degraded signal to be maximally
     // aligned.
     auto aligned_result =
-        Alignment::AlignAndTruncate(ref_patch_audio, deg_patch_audio);
-    AudioSignal ref_audio_aligned = std::get<0>(aligned_result);
-    AudioSignal deg_audio_aligned = std::get<1>(aligned_result);
+        bounded_realignment_
+            ? Alignment::AlignAndTruncate(ref_patch_audio, deg_patch_audio,
+                                          max_lag)
+            : Alignment::AlignAndTruncate(ref_patch_audio, deg_patch_audio);
+    const AudioSignalView& ref_audio_aligned = std::get<0>(aligned_result);
+    const AudioSignalView& deg_audio_aligned = std::get<1>(aligned_result);
     double lag = std::get<2>(aligned_result);
 
     double new_ref_duration = ref_audio_aligned.GetDuration();
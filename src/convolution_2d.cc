@@ -14,7 +14,7 @@
 
 #include "convolution_2d.h"
 
-#include <utility>
+#include <algorithm>
 
 #include "amatrix.h"
 
@@ -22,33 +22,40 @@ namespace Visqol {
 
 template <class T>
 AMatrix<T> Convolution2D<T>::Valid2DConvWithBoundary(
-    const AMatrix<T>& fir_filter, AMatrix<T> input_matrix) {
-  input_matrix = AddMatrixBoundary(std::move(input_matrix));
+    const AMatrix<T>& fir_filter, const AMatrix<T>& input_matrix) {
+  const AMatrix<T> padded_matrix = AddMatrixBoundary(input_matrix);
 
-  int i_r_c = input_matrix.NumRows();  // input row count
-  int i_c_c = input_matrix.NumCols();  // input col count
-  int f_r_c = fir_filter.NumRows();    // filter row count
-  int f_c_c = fir_filter.NumCols();    // filter col count
-  int o_r_c = i_r_c - f_r_c + 1;       // output row count
-  int o_c_c = i_c_c - f_c_c + 1;       // output col count
+  int i_r_c = padded_matrix.NumRows();  // input row count
+  int i_c_c = padded_matrix.NumCols();  // input col count
+  int f_r_c = fir_filter.NumRows();     // filter row count
+  int f_c_c = fir_filter.NumCols();     // filter col count
+  int o_r_c = i_r_c - f_r_c + 1;        // output row count
+  int o_c_c = i_c_c - f_c_c + 1;        // output col count
   if (o_r_c < 0) o_r_c = 0;
   if (o_c_c < 0) o_c_c = 0;
 
   int filter_size = f_r_c * f_c_c;
 
-  AMatrix<T> out_matrix(o_r_c, o_c_c);
+  AMatrix<T> out_matrix = AMatrix<T>::Filled(o_r_c, o_c_c, 0);
+  const T* input = padded_matrix.data();
+  const T* filter = fir_filter.data();
+  T* output = out_matrix.mutData();
 
-  for (int o_row = 0; o_row < o_r_c; o_row++) {    // output rows
-    for (int o_col = 0; o_col < o_c_c; o_col++) {  // output cols
-      T sum = 0;
-      size_t filter_index = filter_size - 1;
-      for (int f_col = 0; f_col < f_c_c; f_col++) {    // filter cols
-        for (int f_row = 0; f_row < f_r_c; f_row++) {  // filter rows
-          const size_t idx = ((f_col + o_col) * i_r_c) + f_row + o_row;
-          sum += input_matrix(idx) * fir_filter(filter_index--);
+  // Accumulate each filter tap over a whole output column at a time. The
+  // innermost loop walks consecutive rows of both the input and the output,
+  // so it vectorizes, and every output still sums the taps in the same order.
+  for (int o_col = 0; o_col < o_c_c; o_col++) {  // output cols
+    T* out_col = output + (o_col * o_r_c);
+    size_t filter_index = filter_size - 1;
+    for (int f_col = 0; f_col < f_c_c; f_col++) {  // filter cols
+      const T* in_col = input + ((f_col + o_col) * i_r_c);
+      for (int f_row = 0; f_row < f_r_c; f_row++) {  // filter rows
+        const T tap = filter[filter_index--];
+        const T* in = in_col + f_row;
+        for (int o_row = 0; o_row < o_r_c; o_row++) {  // output rows
+          out_col[o_row] += in[o_row] * tap;
         }
       }
-      out_matrix(o_row, o_col) = sum;
     }
   }
 
@@ -56,15 +63,23 @@ AMatrix<T> Convolution2D<T>::Valid2DConvWithBoundary(
 }
 
 template <class T>
-AMatrix<T> Convolution2D<T>::AddMatrixBoundary(AMatrix<T>&& input_matrix) {
+AMatrix<T> Convolution2D<T>::AddMatrixBoundary(const AMatrix<T>& input_matrix) {
   // Pad the matrix by 1 on either side of both dimensions.
   AMatrix<T> output_matrix = CopyMatrixWithinPadding(input_matrix, 1, 1, 1, 1);
-  output_matrix.SetRow(0, output_matrix.GetRow(1));
-  output_matrix.SetRow(output_matrix.NumRows() - 1,
-                       output_matrix.GetRow(output_matrix.NumRows() - 2));
-  output_matrix.SetColumn(0, output_matrix.GetColumn(1));
-  output_matrix.SetColumn(output_matrix.NumCols() - 1,
-                          output_matrix.GetColumn(output_matrix.NumCols() - 2));
+  const size_t num_rows = output_matrix.NumRows();
+  const size_t num_cols = output_matrix.NumCols();
+  T* data = output_matrix.mutData();
+  // Repeat the first and last rows into the padding, then the first and last
+  // columns, which are contiguous.
+  for (size_t col = 0; col < num_cols; col++) {
+    T* column = data + (col * num_rows);
+    column[0] = column[1];
+    column[num_rows - 1] = column[num_rows - 2];
+  }
+  std::copy(data + num_rows, data + (2 * num_rows), data);
+  std::copy(data + ((num_cols - 2) * num_rows),
+            data + ((num_cols - 1) * num_rows),
+            data + ((num_cols - 1) * num_rows));
   return output_matrix;
 }
 
@@ -76,11 +91,14 @@ AMatrix<T> Convolution2D<T>::CopyMatrixWithinPadding(
   AMatrix<T> output_matrix(
       input_matrix.NumRows() + row_prepad_amt + row_postpad_amt,
       input_matrix.NumCols() + col_prepad_amt + col_postpad_amt);
-  for (size_t row_i = 0; row_i < input_matrix.NumRows(); row_i++) {
-    for (size_t col_i = 0; col_i < input_matrix.NumCols(); col_i++) {
-      output_matrix(row_i + row_prepad_amt, col_i + col_prepad_amt) =
-          input_matrix(row_i, col_i);
-    }
+  // Copy a column at a time, as the columns are contiguous in both matrices.
+  const size_t in_rows = input_matrix.NumRows();
+  const size_t out_rows = output_matrix.NumRows();
+  for (size_t col_i = 0; col_i < input_matrix.NumCols(); col_i++) {
+    const T* in_col = input_matrix.data() + (col_i * in_rows);
+    T* out_col = output_matrix.mutData() +
+                 ((col_i + col_prepad_amt) * out_rows) + row_prepad_amt;
+    std::copy(in_col, in_col + in_rows, out_col);
   }
   return output_matrix;
 }
@@ -15,59 +15,68 @@
 #include "envelope.h"
 
 #include <algorithm>
-#include <complex>
-#include <cstdio>
-#include <memory>
-#include <vector>
+#include <cmath>
 
-#include "absl/memory/memory.h"
-#include "fast_fourier_transform.h"
-#include "misc_vector.h"
+#include "fft_manager.h"
+#include "misc_math.h"
 
 namespace Visqol {
-AMatrix<double> Envelope::CalcUpperEnv(const AMatrix<double>& signal) {
-  double mean = MiscVector::Mean(signal);
-  const auto signal_centered = signal - mean;
-  AMatrix<std::complex<double>> hilbert = Hilbert(signal_centered);
-  AMatrix<double> hilbert_amp(hilbert.NumRows(), hilbert.NumCols());
-  // to amplitude
-  for (size_t i = 0; i < hilbert.NumRows(); i++) {
-    hilbert_amp(i) = std::abs(hilbert(i));
-  }
+const size_t Envelope::kBlockSize = 4096;
 
-  return hilbert_amp + mean;
+AMatrix<double> Envelope::CalcUpperEnv(const AMatrix<double>& signal) {
+  return CalcUpperEnv(signal.data(), signal.NumElements());
 }
 
-AMatrix<std::complex<double>> Envelope::Hilbert(const AMatrix<double>& signal) {
-  auto fft_manager = std::make_unique<FftManager>(signal.NumElements());
-  AMatrix<std::complex<double>> freq_domain_signal =
-      FastFourierTransform::Forward1d(fft_manager, signal);
-
-  const bool is_odd = signal.NumRows() % 2 == 1;
-  const bool is_non_empty = signal.NumRows() > 0;
-  const double kInitVal = 0.0;
-  std::vector<double> hilbert_scaling(freq_domain_signal.NumRows(), kInitVal);
-  hilbert_scaling[0] = 1;
+AMatrix<double> Envelope::CalcUpperEnv(const AudioSignalView& signal) {
+  return CalcUpperEnv(signal, signal.NumSamples());
+}
 
-  // even and nonempty, used for scaling
-  if (!is_odd && is_non_empty) {
-    hilbert_scaling[signal.NumRows() / 2] = 1.0;
-  } else if (is_odd && is_non_empty) {
-    hilbert_scaling[signal.NumRows() / 2] = 2.0;
+template <typename Samples>
+AMatrix<double> Envelope::CalcUpperEnv(const Samples& samples, size_t length) {
+  AMatrix<double> upper_env(length, 1);
+  if (length == 0) {
+    return upper_env;
   }
-  const size_t n = (is_odd) ? (freq_domain_signal.NumRows() + 1) / 2
-                            : ((freq_domain_signal.NumRows()) / 2);
-  for (size_t row_index = 1; row_index < n; row_index++) {
-    hilbert_scaling[row_index] = 2.0;
+
+  // First pass: gather the DC and Nyquist bins of the signal. Each block is
+  // summed separately to limit the growth of rounding error.
+  double sum = 0.0;
+  double alternating_sum = 0.0;
+  for (size_t block_start = 0; block_start < length;
+       block_start += kBlockSize) {
+    const size_t block_end = std::min(block_start + kBlockSize, length);
+    double block_sum = 0.0;
+    double block_alternating_sum = 0.0;
+    for (size_t i = block_start; i < block_end; ++i) {
+      block_sum += samples[i];
+      block_alternating_sum += (i % 2 == 0) ? samples[i] : -samples[i];
+    }
+    sum += block_sum;
+    alternating_sum += block_alternating_sum;
   }
+  const double mean = sum / length;
+  // The bins of the mean centered signal.
+  const double dc_bin = sum - mean * length;
+  const double nyquist_bin =
+      alternating_sum - ((length % 2 == 1) ? mean : 0.0);
+
+  // The Hilbert transform was calculated with an FFT of this many points. The
+  // Matlab based scaling doubles every bin between DC and Nyquist, keeps DC,
+  // and keeps Nyquist only if the signal was not zero padded. As only the
+  // real part of the inverse transform was kept, it equals twice the centered
+  // signal minus the DC bin and the dropped share of the Nyquist bin.
+  const size_t fft_size =
+      std::max(MiscMath::NextPowTwo(length), FftManager::kMinFftSize);
+  const double dc_offset = dc_bin / fft_size;
+  const double nyquist_offset =
+      ((length == fft_size) ? 1.0 : 2.0) * nyquist_bin / fft_size;
 
-  AMatrix<std::complex<double>> element_wise_prod(
-      freq_domain_signal.NumElements(), 1);
-  for (size_t i = 0; i < freq_domain_signal.NumRows(); i++) {
-    element_wise_prod(i) = freq_domain_signal(i) * hilbert_scaling[i];
+  // Second pass: calculate the envelope.
+  for (size_t i = 0; i < length; ++i) {
+    const double hilbert = 2.0 * (samples[i] - mean) - dc_offset -
+                           ((i % 2 == 0) ? nyquist_offset : -nyquist_offset);
+    upper_env(i) = std::abs(hilbert) + mean;
   }
-  auto hilbert =
-      FastFourierTransform::Inverse1d(fft_manager, element_wise_prod);
-  return hilbert;
+  return upper_env;
 }
 }  // namespace Visqol
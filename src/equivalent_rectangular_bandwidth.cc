@@ -38,19 +38,20 @@ ErbFiltersResult EquivalentRectangularBandwidth::MakeFilters(
         sample_rate, high_freq);
     high_freq = sample_rate / 2.;
   }
-  auto cf1 = EquivalentRectangularBandwidth::CalcUniformCenterFreqs(
-      low_freq, high_freq, num_channels);
-  auto cf = ComplexValArray{cf1};
+  return MakeFilters(static_cast<double>(sample_rate),
+                     EquivalentRectangularBandwidth::CalcUniformCenterFreqs(
+                         low_freq, high_freq, num_channels));
+}
 
-  double earQ = 9.26449;  // Glasberg and Moore Parameters
-  double minBW = 24.7;
-  double order = 1.0;
+ErbFiltersResult EquivalentRectangularBandwidth::MakeFilters(
+    double sample_rate, const std::vector<double>& center_freqs) {
+  const std::size_t num_channels = center_freqs.size();
+  auto cf = ComplexValArray{center_freqs};
 
   auto B = ComplexValArray{num_channels};
   auto B1 = ComplexValArray{num_channels};
   for (std::size_t i = 0; i < num_channels; i++) {
-    auto erb = pow(pow(cf[i] / earQ, order) + pow(minBW, order), 1.0 / order);
-    B[i] = 1.019 * 2 * M_PI * erb;
+    B[i] = 1.019 * 2 * M_PI * CalcBandwidth(center_freqs[i]);
   }
   double T = 1.0 / sample_rate;
 
@@ -116,6 +117,12 @@ ErbFiltersResult EquivalentRectangularBandwidth::MakeFilters(
   return r;
 }
 
+double EquivalentRectangularBandwidth::CalcBandwidth(double center_freq) {
+  double earQ = 9.26449;  // Glasberg and Moore Parameters
+  double minBW = 24.7;
+  return center_freq / earQ + minBW;
+}
+
 std::vector<double> EquivalentRectangularBandwidth::CalcUniformCenterFreqs(
     double low_freq, double high_freq, std::size_t num_channels) {
   double earQ = 9.26449;  // Glasberg and Moore Parameters
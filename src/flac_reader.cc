@@ -0,0 +1,692 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "flac_reader.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "absl/base/internal/raw_logging.h"
+#include "absl/numeric/bits.h"
+
+namespace Visqol {
+
+namespace {
+
+// The signature at the start of every FLAC stream.
+const char kFlacSignature[] = {'f', 'L', 'a', 'C'};
+
+// The STREAMINFO metadata block, which has to be the first block.
+const uint32_t kStreamInfoBlockType = 0;
+const uint32_t kStreamInfoSize = 34;
+const size_t kMd5SignatureSize = 16;
+
+// The 14 bit code at the start of every frame.
+const uint32_t kFrameSyncCode = 0x3ffe;
+
+// The channel assignments that code a stereo pair as one channel and the
+// difference between the channels, the side channel. Lower values give the
+// number of independently coded channels, minus one.
+const uint32_t kLeftSideStereo = 8;
+const uint32_t kSideRightStereo = 9;
+const uint32_t kMidSideStereo = 10;
+
+// Subframe types. The fixed and LPC types also give the predictor order.
+const uint32_t kConstantSubframe = 0;
+const uint32_t kVerbatimSubframe = 1;
+const uint32_t kFirstFixedSubframe = 8;
+const uint32_t kLastFixedSubframe = 12;
+const uint32_t kFirstLpcSubframe = 32;
+const int kMaxLpcOrder = 32;
+
+// A coefficient precision code that is not allowed.
+const uint32_t kInvalidLpcPrecision = 15;
+
+// The sample sizes of the frame header sample size codes. 0 means the size
+// given in STREAMINFO and -1 marks the reserved code.
+const int kSampleSizes[] = {0, 8, 12, -1, 16, 20, 24, 32};
+
+// A sample rate code that is not allowed.
+const uint32_t kInvalidSampleRateCode = 15;
+
+// The number of bytes read from the stream at a time.
+const size_t kReadChunkSize = 1 << 16;
+
+// The input buffer has this many bytes after the data read from the stream,
+// so that a whole word can always be loaded.
+const size_t kInputPadding = sizeof(uint64_t);
+
+// CRC-8 with the polynomial x^8 + x^2 + x + 1, over the frame header.
+uint8_t Crc8(const uint8_t* data, size_t size) {
+  static const std::array<uint8_t, 256> table = []() {
+    std::array<uint8_t, 256> crcs;
+    for (size_t i = 0; i < crcs.size(); i++) {
+      uint8_t crc = static_cast<uint8_t>(i);
+      for (int bit = 0; bit < 8; bit++) {
+        crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x07)
+                           : static_cast<uint8_t>(crc << 1);
+      }
+      crcs[i] = crc;
+    }
+    return crcs;
+  }();
+  uint8_t crc = 0;
+  for (size_t i = 0; i < size; i++) {
+    crc = table[crc ^ data[i]];
+  }
+  return crc;
+}
+
+// CRC-16 with the polynomial x^16 + x^15 + x^2 + 1, over the whole frame.
+uint16_t Crc16(const uint8_t* data, size_t size) {
+  static const std::array<uint16_t, 256> table = []() {
+    std::array<uint16_t, 256> crcs;
+    for (size_t i = 0; i < crcs.size(); i++) {
+      uint16_t crc = static_cast<uint16_t>(i << 8);
+      for (int bit = 0; bit < 8; bit++) {
+        crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x8005)
+                             : static_cast<uint16_t>(crc << 1);
+      }
+      crcs[i] = crc;
+    }
+    return crcs;
+  }();
+  uint16_t crc = 0;
+  for (size_t i = 0; i < size; i++) {
+    crc = static_cast<uint16_t>((crc << 8) ^ table[(crc >> 8) ^ data[i]]);
+  }
+  return crc;
+}
+
+// Add the predictions of one of the fixed polynomial predictors to the
+// residual that follows the warm-up samples.
+void RestoreFixedPrediction(int order, size_t num_samples, int64_t* samples) {
+  switch (order) {
+    case 1:
+      for (size_t i = 1; i < num_samples; i++) {
+        samples[i] += samples[i - 1];
+      }
+      break;
+    case 2:
+      for (size_t i = 2; i < num_samples; i++) {
+        samples[i] += 2 * samples[i - 1] - samples[i - 2];
+      }
+      break;
+    case 3:
+      for (size_t i = 3; i < num_samples; i++) {
+        samples[i] +=
+            3 * samples[i - 1] - 3 * samples[i - 2] + samples[i - 3];
+      }
+      break;
+    case 4:
+      for (size_t i = 4; i < num_samples; i++) {
+        samples[i] += 4 * samples[i - 1] - 6 * samples[i - 2] +
+                      4 * samples[i - 3] - samples[i - 4];
+      }
+      break;
+  }
+}
+
+// Add the predictions of a linear predictor with quantized coefficients to
+// the residual that follows the warm-up samples.
+void RestoreLpcPrediction(const int64_t* coefs, int order, int shift,
+                          size_t num_samples, int64_t* samples) {
+  for (size_t i = order; i < num_samples; i++) {
+    int64_t prediction = 0;
+    for (int j = 0; j < order; j++) {
+      prediction += coefs[j] * samples[i - 1 - j];
+    }
+    samples[i] += prediction >> shift;
+  }
+}
+}  // namespace
+
+bool FlacReader::HasSignature(std::istream* binary_stream) {
+  return binary_stream->peek() ==
+         std::char_traits<char>::to_int_type(kFlacSignature[0]);
+}
+
+FlacReader::FlacReader(std::istream* binary_stream)
+    : binary_stream_(binary_stream),
+      init_(false),
+      num_channels_(0),
+      sample_rate_hz_(0),
+      bits_per_sample_(0),
+      num_total_samples_(0),
+      input_size_(0),
+      bit_position_(0),
+      end_of_stream_(false),
+      decode_failed_(false),
+      block_size_(0),
+      block_position_(0),
+      num_frames_decoded_(0) {
+  input_buffer_.resize(kReadChunkSize + kInputPadding);
+  init_ = ParseMetadata();
+}
+
+bool FlacReader::ParseMetadata() {
+  for (const char expected : kFlacSignature) {
+    uint32_t byte;
+    if (!ReadBits(8, &byte) ||
+        byte != static_cast<uint8_t>(expected)) {
+      ABSL_RAW_LOG(ERROR, "Missing FLAC signature.");
+      return false;
+    }
+  }
+
+  bool stream_info_found = false;
+  uint32_t is_last_block = 0;
+  while (!is_last_block) {
+    uint32_t block_type, block_size;
+    if (!ReadBits(1, &is_last_block) || !ReadBits(7, &block_type) ||
+        !ReadBits(24, &block_size)) {
+      ABSL_RAW_LOG(ERROR, "FLAC metadata is truncated.");
+      return false;
+    }
+    if (block_type == kStreamInfoBlockType) {
+      if (stream_info_found || block_size != kStreamInfoSize) {
+        ABSL_RAW_LOG(ERROR, "Invalid FLAC STREAMINFO block.");
+        return false;
+      }
+      uint32_t min_block_size, max_block_size, min_frame_size,
+          max_frame_size, sample_rate, channels, bits_per_sample,
+          total_samples_high, total_samples_low;
+      if (!ReadBits(16, &min_block_size) || !ReadBits(16, &max_block_size) ||
+          !ReadBits(24, &min_frame_size) || !ReadBits(24, &max_frame_size) ||
+          !ReadBits(20, &sample_rate) || !ReadBits(3, &channels) ||
+          !ReadBits(5, &bits_per_sample) ||
+          !ReadBits(4, &total_samples_high) ||
+          !ReadBits(32, &total_samples_low) ||
+          !SkipBytes(kMd5SignatureSize)) {
+        ABSL_RAW_LOG(ERROR, "FLAC metadata is truncated.");
+        return false;
+      }
+      sample_rate_hz_ = static_cast<int>(sample_rate);
+      num_channels_ = channels + 1;
+      bits_per_sample_ = static_cast<int>(bits_per_sample) + 1;
+      const uint64_t total_frames =
+          (static_cast<uint64_t>(total_samples_high) << 32) |
+          total_samples_low;
+      num_total_samples_ = static_cast<size_t>(total_frames * num_channels_);
+      stream_info_found = true;
+    } else if (!stream_info_found) {
+      ABSL_RAW_LOG(ERROR, "FLAC stream does not start with STREAMINFO.");
+      return false;
+    } else if (!SkipBytes(block_size)) {
+      ABSL_RAW_LOG(ERROR, "FLAC metadata is truncated.");
+      return false;
+    }
+  }
+
+  if (sample_rate_hz_ == 0) {
+    ABSL_RAW_LOG(ERROR, "Invalid sample rate in FLAC STREAMINFO.");
+    return false;
+  }
+  return true;
+}
+
+bool FlacReader::IsHeaderValid() const { return init_; }
+
+size_t FlacReader::GetNumTotalSamples() const { return num_total_samples_; }
+
+bool FlacReader::IsLengthKnown() const { return num_total_samples_ > 0; }
+
+size_t FlacReader::GetNumChannels() const { return num_channels_; }
+
+int FlacReader::GetSampleRateHz() const { return sample_rate_hz_; }
+
+int FlacReader::GetBitsPerSample() const { return bits_per_sample_; }
+
+double FlacReader::GetDuration() const {
+  if (!init_) {
+    return 0.0;
+  }
+  return static_cast<double>(num_total_samples_) / num_channels_ /
+         sample_rate_hz_;
+}
+
+size_t FlacReader::ReadMonoFrames(size_t num_frames, double* target_buffer) {
+  if (!init_) {
+    return 0;
+  }
+  // Scale integer samples to [-1, 1).
+  const double scale = std::ldexp(1.0, 1 - bits_per_sample_);
+  const double num_channels_double = static_cast<double>(num_channels_);
+  size_t num_frames_read = 0;
+  while (num_frames_read < num_frames) {
+    if (block_position_ == block_size_ && !NextFrame()) {
+      break;
+    }
+    const size_t num_block_frames =
+        std::min(num_frames - num_frames_read, block_size_ - block_position_);
+    // The channels are summed in order before dividing by their number, as
+    // for WAV files, so that both give the same signal.
+    const int64_t* samples = decoded_samples_.data() + block_position_;
+    double* mono = target_buffer + num_frames_read;
+    for (size_t frame = 0; frame < num_block_frames; frame++) {
+      double sum = samples[frame] * scale;
+      for (size_t chan = 1; chan < num_channels_; chan++) {
+        sum += samples[chan * block_size_ + frame] * scale;
+      }
+      mono[frame] = sum / num_channels_double;
+    }
+    block_position_ += num_block_frames;
+    num_frames_read += num_block_frames;
+  }
+  return num_frames_read;
+}
+
+bool FlacReader::NextFrame() {
+  block_size_ = 0;
+  block_position_ = 0;
+  if (!init_ || decode_failed_) {
+    return false;
+  }
+  DiscardReadBytes();
+  if (!EnsureBits(1)) {
+    // The end of the stream.
+    return false;
+  }
+  if (!DecodeFrame()) {
+    ABSL_RAW_LOG(ERROR, "Unable to decode FLAC frame %zu.",
+                 num_frames_decoded_);
+    decode_failed_ = true;
+    block_size_ = 0;
+    return false;
+  }
+  num_frames_decoded_++;
+  return true;
+}
+
+bool FlacReader::DecodeFrame() {
+  uint32_t sync_code, reserved, blocking_strategy, block_size_code,
+      sample_rate_code, channel_assignment, sample_size_code;
+  if (!ReadBits(14, &sync_code) || sync_code != kFrameSyncCode ||
+      !ReadBits(1, &reserved) || reserved != 0 ||
+      !ReadBits(1, &blocking_strategy) || !ReadBits(4, &block_size_code) ||
+      !ReadBits(4, &sample_rate_code) || !ReadBits(4, &channel_assignment) ||
+      !ReadBits(3, &sample_size_code) || !ReadBits(1, &reserved) ||
+      reserved != 0) {
+    return false;
+  }
+
+  // The frame or sample number is coded like a UTF-8 character. Only its
+  // length is needed.
+  uint32_t coded_number_byte;
+  if (!ReadBits(8, &coded_number_byte)) {
+    return false;
+  }
+  const int coded_number_size =
+      absl::countl_one(static_cast<uint8_t>(coded_number_byte));
+  if (coded_number_size == 1 || coded_number_size > 7) {
+    return false;
+  }
+  for (int i = 1; i < coded_number_size; i++) {
+    if (!ReadBits(8, &coded_number_byte) ||
+        (coded_number_byte & 0xc0) != 0x80) {
+      return false;
+    }
+  }
+
+  uint32_t block_size;
+  if (block_size_code == 0) {
+    return false;
+  } else if (block_size_code == 1) {
+    block_size = 192;
+  } else if (block_size_code <= 5) {
+    block_size = 576 << (block_size_code - 2);
+  } else if (block_size_code <= 7) {
+    if (!ReadBits(block_size_code == 6 ? 8 : 16, &block_size)) {
+      return false;
+    }
+    block_size++;
+  } else {
+    block_size = 256 << (block_size_code - 8);
+  }
+
+  // The sample rate of the frame is not needed, as it is the same as the
+  // rate in STREAMINFO, but it may be followed by more bits.
+  if (sample_rate_code == kInvalidSampleRateCode) {
+    return false;
+  } else if (sample_rate_code >= 12) {
+    uint32_t sample_rate;
+    if (!ReadBits(sample_rate_code == 12 ? 8 : 16, &sample_rate)) {
+      return false;
+    }
+  }
+
+  const size_t num_channels =
+      channel_assignment < kLeftSideStereo ? channel_assignment + 1 : 2;
+  const int sample_size = kSampleSizes[sample_size_code];
+  if (channel_assignment > kMidSideStereo || num_channels != num_channels_ ||
+      sample_size < 0 || (sample_size > 0 && sample_size != bits_per_sample_)) {
+    return false;
+  }
+
+  // The header is checked before using the block size it gives. The frame
+  // starts at the start of the input buffer.
+  const size_t header_size = bit_position_ / 8;
+  uint32_t header_crc;
+  if (!ReadBits(8, &header_crc) ||
+      header_crc != Crc8(input_buffer_.data(), header_size)) {
+    return false;
+  }
+
+  block_size_ = block_size;
+  decoded_samples_.resize(num_channels_ * block_size_);
+  for (size_t chan = 0; chan < num_channels_; chan++) {
+    // The side channel needs an extra bit.
+    const bool is_side_channel =
+        (channel_assignment == kLeftSideStereo && chan == 1) ||
+        (channel_assignment == kSideRightStereo && chan == 0) ||
+        (channel_assignment == kMidSideStereo && chan == 1);
+    if (!DecodeSubframe(bits_per_sample_ + (is_side_channel ? 1 : 0),
+                        decoded_samples_.data() + chan * block_size_)) {
+      return false;
+    }
+  }
+
+  // The frame is padded to a whole byte and ends with a CRC of all of it.
+  bit_position_ = (bit_position_ + 7) / 8 * 8;
+  const size_t frame_size = bit_position_ / 8;
+  uint32_t frame_crc;
+  if (!ReadBits(16, &frame_crc) ||
+      frame_crc != Crc16(input_buffer_.data(), frame_size)) {
+    return false;
+  }
+
+  int64_t* first = decoded_samples_.data();
+  int64_t* second = first + block_size_;
+  switch (channel_assignment) {
+    case kLeftSideStereo:
+      for (size_t i = 0; i < block_size_; i++) {
+        second[i] = first[i] - second[i];
+      }
+      break;
+    case kSideRightStereo:
+      for (size_t i = 0; i < block_size_; i++) {
+        first[i] += second[i];
+      }
+      break;
+    case kMidSideStereo:
+      for (size_t i = 0; i < block_size_; i++) {
+        // The mid channel lost its lowest bit, which is the same as the
+        // lowest bit of the side channel.
+        const int64_t side = second[i];
+        const int64_t mid = first[i] * 2 + (side & 1);
+        first[i] = (mid + side) >> 1;
+        second[i] = (mid - side) >> 1;
+      }
+      break;
+  }
+  return true;
+}
+
+bool FlacReader::DecodeSubframe(int bits_per_sample, int64_t* samples) {
+  uint32_t padding, type, has_wasted_bits;
+  if (!ReadBits(1, &padding) || padding != 0 || !ReadBits(6, &type) ||
+      !ReadBits(1, &has_wasted_bits)) {
+    return false;
+  }
+  // Low bits that are zero in every sample can be left out.
+  int wasted_bits = 0;
+  if (has_wasted_bits) {
+    uint32_t num_wasted_bits;
+    if (!ReadUnary(&num_wasted_bits) ||
+        num_wasted_bits + 1 >= static_cast<uint32_t>(bits_per_sample)) {
+      return false;
+    }
+    wasted_bits = num_wasted_bits + 1;
+    bits_per_sample -= wasted_bits;
+  }
+
+  if (type == kConstantSubframe) {
+    int64_t value;
+    if (!ReadSignedBits(bits_per_sample, &value)) {
+      return false;
+    }
+    std::fill(samples, samples + block_size_, value);
+  } else if (type == kVerbatimSubframe) {
+    for (size_t i = 0; i < block_size_; i++) {
+      if (!ReadSignedBits(bits_per_sample, &samples[i])) {
+        return false;
+      }
+    }
+  } else if (type >= kFirstFixedSubframe && type <= kLastFixedSubframe) {
+    const int order = type - kFirstFixedSubframe;
+    if (static_cast<size_t>(order) > block_size_) {
+      return false;
+    }
+    for (int i = 0; i < order; i++) {
+      if (!ReadSignedBits(bits_per_sample, &samples[i])) {
+        return false;
+      }
+    }
+    if (!DecodeResidual(order, samples + order)) {
+      return false;
+    }
+    RestoreFixedPrediction(order, block_size_, samples);
+  } else if (type >= kFirstLpcSubframe) {
+    const int order = type - kFirstLpcSubframe + 1;
+    if (static_cast<size_t>(order) > block_size_) {
+      return false;
+    }
+    for (int i = 0; i < order; i++) {
+      if (!ReadSignedBits(bits_per_sample, &samples[i])) {
+        return false;
+      }
+    }
+    uint32_t precision;
+    int64_t shift;
+    if (!ReadBits(4, &precision) || precision == kInvalidLpcPrecision ||
+        !ReadSignedBits(5, &shift) || shift < 0) {
+      return false;
+    }
+    int64_t coefs[kMaxLpcOrder];
+    for (int i = 0; i < order; i++) {
+      if (!ReadSignedBits(precision + 1, &coefs[i])) {
+        return false;
+      }
+    }
+    if (!DecodeResidual(order, samples + order)) {
+      return false;
+    }
+    RestoreLpcPrediction(coefs, order, static_cast<int>(shift), block_size_,
+                         samples);
+  } else {
+    // A reserved subframe type.
+    return false;
+  }
+
+  if (wasted_bits > 0) {
+    const int64_t wasted_scale = int64_t{1} << wasted_bits;
+    for (size_t i = 0; i < block_size_; i++) {
+      samples[i] *= wasted_scale;
+    }
+  }
+  return true;
+}
+
+bool FlacReader::DecodeResidual(int predictor_order, int64_t* residual) {
+  uint32_t coding_method, partition_order;
+  if (!ReadBits(2, &coding_method) || coding_method > 1 ||
+      !ReadBits(4, &partition_order)) {
+    return false;
+  }
+  // The two coding methods only differ in the size of the Rice parameter.
+  const int parameter_bits = coding_method == 0 ? 4 : 5;
+  const uint32_t escape_parameter = (1u << parameter_bits) - 1;
+  const size_t num_partitions = size_t{1} << partition_order;
+  const size_t partition_size = block_size_ >> partition_order;
+  if (block_size_ % num_partitions != 0 ||
+      partition_size < static_cast<size_t>(predictor_order)) {
+    return false;
+  }
+
+  for (size_t partition = 0; partition < num_partitions; partition++) {
+    // The first partition does not include the warm-up samples.
+    const size_t num_values =
+        partition_size - (partition == 0 ? predictor_order : 0);
+    uint32_t parameter;
+    if (!ReadBits(parameter_bits, &parameter)) {
+      return false;
+    }
+    if (parameter == escape_parameter) {
+      // The partition is not Rice coded, but has values of a fixed size.
+      uint32_t value_bits;
+      if (!ReadBits(5, &value_bits)) {
+        return false;
+      }
+      for (size_t i = 0; i < num_values; i++) {
+        if (!ReadSignedBits(value_bits, &residual[i])) {
+          return false;
+        }
+      }
+    } else {
+      for (size_t i = 0; i < num_values; i++) {
+        uint32_t quotient, remainder;
+        if (!ReadUnary(&quotient) || !ReadBits(parameter, &remainder)) {
+          return false;
+        }
+        // Undo the folding of signed values onto unsigned ones.
+        const uint64_t folded =
+            (static_cast<uint64_t>(quotient) << parameter) | remainder;
+        residual[i] = static_cast<int64_t>(folded >> 1) ^
+                      -static_cast<int64_t>(folded & 1);
+      }
+    }
+    residual += num_values;
+  }
+  return true;
+}
+
+bool FlacReader::EnsureBits(size_t num_bits) {
+  const size_t num_bytes = (bit_position_ + num_bits + 7) / 8;
+  while (input_size_ < num_bytes) {
+    if (end_of_stream_) {
+      return false;
+    }
+    if (input_buffer_.size() < input_size_ + kReadChunkSize + kInputPadding) {
+      input_buffer_.resize(input_size_ + kReadChunkSize + kInputPadding);
+    }
+    binary_stream_->read(
+        reinterpret_cast<char*>(input_buffer_.data() + input_size_),
+        kReadChunkSize);
+    const size_t num_bytes_read = binary_stream_->gcount();
+    input_size_ += num_bytes_read;
+    if (num_bytes_read < kReadChunkSize) {
+      end_of_stream_ = true;
+    }
+  }
+  return true;
+}
+
+uint64_t FlacReader::LoadWord() const {
+  const uint8_t* bytes = input_buffer_.data() + bit_position_ / 8;
+  uint64_t word = 0;
+  for (size_t i = 0; i < sizeof(word); i++) {
+    word = (word << 8) | bytes[i];
+  }
+  return word << (bit_position_ % 8);
+}
+
+bool FlacReader::ReadBits(int num_bits, uint32_t* value) {
+  if (!EnsureBits(num_bits)) {
+    return false;
+  }
+  *value = num_bits == 0
+               ? 0
+               : static_cast<uint32_t>(LoadWord() >> (64 - num_bits));
+  bit_position_ += num_bits;
+  return true;
+}
+
+bool FlacReader::ReadSignedBits(int num_bits, int64_t* value) {
+  uint64_t bits;
+  if (num_bits > 32) {
+    uint32_t high, low;
+    if (!ReadBits(num_bits - 32, &high) || !ReadBits(32, &low)) {
+      return false;
+    }
+    bits = (static_cast<uint64_t>(high) << 32) | low;
+  } else {
+    uint32_t low;
+    if (!ReadBits(num_bits, &low)) {
+      return false;
+    }
+    bits = low;
+  }
+  *value = static_cast<int64_t>(bits);
+  if (num_bits > 0 && ((bits >> (num_bits - 1)) & 1)) {
+    *value -= int64_t{1} << num_bits;
+  }
+  return true;
+}
+
+bool FlacReader::ReadUnary(uint32_t* value) {
+  uint32_t num_zeros = 0;
+  while (true) {
+    if (!EnsureBits(1)) {
+      return false;
+    }
+    // At most 56 bits of a loaded word are after the read position.
+    const size_t num_bits =
+        std::min<size_t>(input_size_ * 8 - bit_position_, 56);
+    const uint64_t word = LoadWord() & ~(~uint64_t{0} >> num_bits);
+    if (word != 0) {
+      const int num_word_zeros = absl::countl_zero(word);
+      bit_position_ += num_word_zeros + 1;
+      *value = num_zeros + num_word_zeros;
+      return true;
+    }
+    num_zeros += num_bits;
+    bit_position_ += num_bits;
+  }
+}
+
+bool FlacReader::SkipBytes(size_t size) {
+  const size_t num_buffered = input_size_ - bit_position_ / 8;
+  if (size <= num_buffered) {
+    bit_position_ += size * 8;
+    return true;
+  }
+  input_size_ = 0;
+  bit_position_ = 0;
+  const std::streamsize num_unbuffered = size - num_buffered;
+  if (end_of_stream_) {
+    return false;
+  }
+  binary_stream_->ignore(num_unbuffered);
+  if (binary_stream_->gcount() != num_unbuffered) {
+    end_of_stream_ = true;
+    return false;
+  }
+  return true;
+}
+
+void FlacReader::DiscardReadBytes() {
+  const size_t num_read_bytes = bit_position_ / 8;
+  std::memmove(input_buffer_.data(), input_buffer_.data() + num_read_bytes,
+               input_size_ - num_read_bytes);
+  input_size_ -= num_read_bytes;
+  bit_position_ -= num_read_bytes * 8;
+}
+
+}  // namespace Visqol
@@ -36,9 +36,8 @@ GammatoneSpectrogramBuilder::GammatoneSpectrogramBuilder(
     : filter_bank_(filter_bank), speech_mode_(use_speech_mode) {}
 
 absl::StatusOr<Spectrogram> GammatoneSpectrogramBuilder::Build(
-    const AudioSignal& signal, const AnalysisWindow& window) {
-  const AMatrix<double>& sig = signal.data_matrix;
-  size_t sample_rate = signal.sample_rate;
+    const AudioSignalView& signal, const AnalysisWindow& window) {
+  size_t sample_rate = signal.GetSampleRate();
   double max_freq = speech_mode_ ? kSpeechModeMaxFreq : sample_rate / 2.0;
 
   // Get gammatone coeffients.
@@ -56,21 +55,20 @@ absl::StatusOr<Spectrogram> GammatoneSpectrogramBuilder::Build(
   size_t hop_size = window.size * window.overlap;
 
   // Ensure that the signal is large enough.
-  if (sig.NumRows() <= window.size) {
+  if (signal.NumSamples() <= window.size) {
     return absl::InvalidArgumentError(
-        absl::StrCat("Too few samples (", sig.NumRows(),
+        absl::StrCat("Too few samples (", signal.NumSamples(),
                      ") in signal to  build spectrogram (", window.size,
                      " required minimum)."));
   }
-  size_t num_cols = 1 + floor((sig.NumRows() - window.size) / hop_size);
+  size_t num_cols = 1 + floor((signal.NumSamples() - window.size) / hop_size);
   AMatrix<double> out_matrix(filter_bank_.GetNumBands(), num_cols);
 
-  auto sig_val_arr = sig.GetColumn(0).ToValArray();
+  std::valarray<double> frame(window.size);
   for (size_t i = 0; i < out_matrix.NumCols(); i++) {
     const size_t start_col = i * hop_size;
-    // Select the next frame from the input signal to filter.
-    const std::slice_array<double> frame =
-        sig_val_arr[std::slice(start_col, window.size, 1)];
+    // Copy the next frame from the input signal to filter.
+    signal.CopySamples(start_col, window.size, &frame[0]);
 
     // Apply a Hann window to reduce artifacts.
     const std::valarray<double> windowed_frame = window.ApplyHannWindow(frame);
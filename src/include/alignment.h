@@ -17,39 +17,222 @@
 #ifndef VISQOL_INCLUDE_ALIGNMENT_H
 #define VISQOL_INCLUDE_ALIGNMENT_H
 
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
 #include <utility>
+#include <vector>
+
+#include "amatrix.h"
+#include "audio_signal_view.h"
 
 namespace Visqol {
-struct AudioSignal;
 
 /**
  * Perform an alignment on two given signals. Used to adjust for codec initial
  * padding.
+ *
+ * The aligned signals are returned as views of the input signals, so no
+ * samples are copied. The input signals must outlive the returned views.
  */
 class Alignment {
  public:
   /**
    * For a given reference signal, align a second degraded signal with it,
-   * returning a new aligned degraded signal.
+   * returning a view of the aligned degraded signal.
+   *
+   * @param reference_signal The reference signal.
+   * @param degraded_signal The degraded signal to align.
+   * @return A tuple of the aligned degraded signal and its lag in seconds.
+   */
+  static std::tuple<AudioSignalView, double> GloballyAlign(
+      const AudioSignalView& reference_signal,
+      const AudioSignalView& degraded_signal);
+
+  /**
+   * For a given reference signal, align a second degraded signal with it,
+   * using a precomputed upper envelope of the reference. This avoids
+   * recomputing the envelope when one reference is aligned with many
+   * degraded signals.
    *
    * @param reference_signal The reference signal.
+   * @param reference_upper_env The upper envelope of the reference signal.
    * @param degraded_signal The degraded signal to align.
    * @return A tuple of the aligned degraded signal and its lag in seconds.
    */
-  static std::tuple<AudioSignal, double> GloballyAlign(
-      const AudioSignal& reference_signal, const AudioSignal& degraded_signal);
+  static std::tuple<AudioSignalView, double> GloballyAlign(
+      const AudioSignalView& reference_signal,
+      const AMatrix<double>& reference_upper_env,
+      const AudioSignalView& degraded_signal);
+
+  /**
+   * For a given reference signal, align a second degraded signal with it,
+   * considering only lags of at most max_lag samples in either direction.
+   * Only the correlation at those lags is computed, directly in the time
+   * domain and coarse to fine, so no FFT of the signals is needed.
+   *
+   * @param reference_signal The reference signal.
+   * @param degraded_signal The degraded signal to align.
+   * @param max_lag The largest lag in samples to consider.
+   * @return A tuple of the aligned degraded signal and its lag in seconds.
+   */
+  static std::tuple<AudioSignalView, double> GloballyAlign(
+      const AudioSignalView& reference_signal,
+      const AudioSignalView& degraded_signal, int64_t max_lag);
+
   /**
    * Aligns a degraded signal to the reference signal, truncating them to
    * be the same length.
    *
    * @param reference_signal The reference signal.
    * @param degraded_signal The degraded signal.
-   * @return A std::tuple of two new signals and the lag of the degraded.
-   *   The start position will be what it was for the reference_signal, and the
-   *   durations will be truncated as needed so that they are the same length.
+   * @return A std::tuple of views of the two signals and the lag of the
+   *   degraded. The start position will be what it was for the
+   *   reference_signal, and the durations will be truncated as needed so that
+   *   they are the same length.
    **/
-  static std::tuple<AudioSignal, AudioSignal, double> AlignAndTruncate(
-      const AudioSignal& reference_signal, const AudioSignal& degraded_signal);
+  static std::tuple<AudioSignalView, AudioSignalView, double> AlignAndTruncate(
+      const AudioSignalView& reference_signal,
+      const AudioSignalView& degraded_signal);
+
+  /**
+   * Aligns a degraded signal to the reference signal, considering only lags
+   * of at most max_lag samples, and truncates them to be the same length.
+   *
+   * @param reference_signal The reference signal.
+   * @param degraded_signal The degraded signal.
+   * @param max_lag The largest lag in samples to consider.
+   * @return A std::tuple of views of the two signals and the lag of the
+   *   degraded.
+   **/
+  static std::tuple<AudioSignalView, AudioSignalView, double> AlignAndTruncate(
+      const AudioSignalView& reference_signal,
+      const AudioSignalView& degraded_signal, int64_t max_lag);
+
+ private:
+  /**
+   * The factor by which the upper envelopes are decimated before the coarse
+   * lag search.
+   */
+  static const size_t kEnvelopeDecimationFactor;
+
+  /**
+   * The number of decimated samples either side of a lag that are searched
+   * again at the next finer decimation stage.
+   */
+  static const int64_t kRefinementRadius;
+
+  /**
+   * The number of coarse correlation peaks that are refined at the
+   * intermediate decimation stage. More than one is kept because the decimated
+   * correlation can rank near-equal peaks differently from the full rate
+   * correlation.
+   */
+  static const size_t kNumCoarseCandidates;
+
+  /**
+   * The factor by which the upper envelopes are decimated when refining the
+   * coarse peaks, before the final search at the full sample rate.
+   */
+  static const size_t kIntermediateDecimationFactor;
+
+  /**
+   * The number of refined peaks that are searched again at the full sample
+   * rate.
+   */
+  static const size_t kNumFineCandidates;
+
+  /**
+   * Envelopes shorter than this are searched at the full sample rate in a
+   * single pass, since decimation would not save any work.
+   */
+  static const size_t kMinLengthForCoarseSearch;
+
+  /**
+   * Find the lag between two upper envelopes. For long envelopes, the lag is
+   * first found on heavily decimated copies of the envelopes. The strongest
+   * coarse peaks are then refined with a bounded-lag correlation on lightly
+   * decimated copies, and the best of those again at the full sample rate.
+   *
+   * @param reference_env The upper envelope of the reference signal.
+   * @param degraded_env The upper envelope of the degraded signal.
+   * @return The best lag in samples, using the XCorr lag convention.
+   */
+  static int64_t FindEnvelopeLag(const AMatrix<double>& reference_env,
+                                 const AMatrix<double>& degraded_env);
+
+  /**
+   * Find the lag between two upper envelopes, considering only lags of at
+   * most max_lag samples in either direction. Small bounds are searched at
+   * the full sample rate. Otherwise the coarse correlation is computed
+   * directly at the decimated lags that cover the bound, and refined as in
+   * the unbounded search without leaving the bound.
+   *
+   * @param reference_env The upper envelope of the reference signal.
+   * @param degraded_env The upper envelope of the degraded signal.
+   * @param max_lag The largest lag in samples to consider.
+   * @return The best lag in samples, using the XCorr lag convention.
+   */
+  static int64_t FindEnvelopeLag(const AMatrix<double>& reference_env,
+                                 const AMatrix<double>& degraded_env,
+                                 int64_t max_lag);
+
+  /**
+   * Refine the strongest peaks of a coarse correlation of the decimated
+   * envelopes, first on lightly decimated envelopes and then at the full
+   * sample rate.
+   *
+   * @param reference_env The upper envelope of the reference signal.
+   * @param degraded_env The upper envelope of the degraded signal.
+   * @param coarse_corrs The correlation of the heavily decimated envelopes,
+   *   ordered from the lowest lag.
+   * @param lowest_coarse_lag The decimated lag of the first coarse
+   *   correlation.
+   * @param max_lag The largest lag in samples that the result may have.
+   * @return The best lag in samples, using the XCorr lag convention.
+   */
+  static int64_t RefineCoarseLag(const AMatrix<double>& reference_env,
+                                 const AMatrix<double>& degraded_env,
+                                 const std::vector<double>& coarse_corrs,
+                                 int64_t lowest_coarse_lag, int64_t max_lag);
+
+  /**
+   * Decimate a column vector by averaging each consecutive block of samples.
+   * A shorter final block is averaged over the samples it contains.
+   *
+   * @param signal The column vector to decimate.
+   * @param factor The number of samples in each block.
+   * @return The decimated column vector.
+   */
+  static AMatrix<double> DecimateByBlockMean(const AMatrix<double>& signal,
+                                             size_t factor);
+
+  /**
+   * Shift the degraded signal by the given lag. Lags of more than half the
+   * reference length are ignored.
+   *
+   * @param reference_signal The reference signal.
+   * @param degraded_signal The degraded signal to shift.
+   * @param best_lag The lag in samples, using the XCorr lag convention.
+   * @return A tuple of the aligned degraded signal and its lag in seconds.
+   */
+  static std::tuple<AudioSignalView, double> ApplyLag(
+      const AudioSignalView& reference_signal,
+      const AudioSignalView& degraded_signal, int64_t best_lag);
+
+  /**
+   * Truncate a reference and an aligned degraded signal to the same length.
+   *
+   * @param reference_signal The reference signal.
+   * @param degraded_signal The degraded signal before alignment.
+   * @param alignment_result The aligned degraded signal and its lag.
+   * @return A std::tuple of views of the two signals and the lag of the
+   *   degraded.
+   */
+  static std::tuple<AudioSignalView, AudioSignalView, double> Truncate(
+      const AudioSignalView& reference_signal,
+      const AudioSignalView& degraded_signal,
+      const std::tuple<AudioSignalView, double>& alignment_result);
 };
 }  // namespace Visqol
 
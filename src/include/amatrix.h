@@ -17,6 +17,12 @@
 #ifndef VISQOL_INCLUDE_AMATRIX_H
 #define VISQOL_INCLUDE_AMATRIX_H
 
+// The visqol_lib build target defines ARMA_ALIEN_MEM_ALLOC_FUNCTION and
+// ARMA_ALIEN_MEM_FREE_FUNCTION, for it and its dependents, so that armadillo
+// allocates the memory of every matrix through the MatrixArena. Armadillo
+// calls these functions, so they must be declared before it is included.
+#include "matrix_arena.h"
+
 #include <armadillo>
 #include <memory>
 #include <valarray>
@@ -45,6 +51,7 @@ class AMatrix {
   AMatrix<T>() {}
   AMatrix<T>(const arma::Mat<T>& mat);
   AMatrix<T>(const AMatrix<T>& other);
+  AMatrix<T>(AMatrix<T>&& other) noexcept;
   AMatrix<T>(const std::vector<T>& col);
   AMatrix<T>(const absl::Span<T>& col);
   AMatrix<T>(const std::valarray<T>& va);
@@ -59,16 +66,44 @@ class AMatrix {
   T operator()(size_t elementIndex) const;
   bool operator==(const AMatrix<T>& other) const;
   AMatrix<T>& operator=(const AMatrix<T>& other);
+  AMatrix<T>& operator=(AMatrix<T>&& other) noexcept;
   AMatrix<T> operator+(const AMatrix<T>& other) const;
   AMatrix<T> operator+(T v) const;
   AMatrix<T> operator*(T v) const;
   AMatrix<T> operator-(T v) const;
   AMatrix<T> operator/(T v) const;
   AMatrix<T> operator-(const AMatrix<T>& m) const;
+
+  /**
+   * Compound assignment operators. These update the matrix in place, without
+   * allocating the temporary that the binary operators above return.
+   */
+  AMatrix<T>& operator+=(const AMatrix<T>& other);
+  AMatrix<T>& operator+=(T v);
+  AMatrix<T>& operator-=(const AMatrix<T>& m);
+  AMatrix<T>& operator-=(T v);
+  AMatrix<T>& operator*=(T v);
+  AMatrix<T>& operator/=(T v);
   static AMatrix<T> Filled(size_t rows, size_t cols, T initialValue);
 
   AMatrix<T> PointWiseProduct(const AMatrix<T>& m) const;
   AMatrix<T> PointWiseDivide(const AMatrix<T>& m) const;
+  AMatrix<T>& PointWiseProductInPlace(const AMatrix<T>& m);
+  AMatrix<T>& PointWiseDivideInPlace(const AMatrix<T>& m);
+
+  /**
+   * Fused multiply-add: adds a(i) * b(i) * scale to every element i of this
+   * matrix in a single pass, without materializing the product of a and b.
+   * The operations are performed in that order, so the result is identical to
+   * the unfused *this + a.PointWiseProduct(b) * scale.
+   *
+   * @param a The first factor, of the same dimensions as this matrix.
+   * @param b The second factor, of the same dimensions as this matrix.
+   * @param scale The scalar applied to each product.
+   *
+   * @return A reference to this matrix.
+   */
+  AMatrix<T>& MultiplyAdd(const AMatrix<T>& a, const AMatrix<T>& b, T scale);
   AMatrix<T> Transpose() const;
   AMatrix<double> Abs() const;
   std::vector<T> RowSubset(size_t row, size_t startColumnIndex,
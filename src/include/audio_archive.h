@@ -0,0 +1,104 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef VISQOL_INCLUDE_AUDIO_ARCHIVE_H
+#define VISQOL_INCLUDE_AUDIO_ARCHIVE_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "file_path.h"
+#include "mapped_file.h"
+
+namespace Visqol {
+
+/**
+ * This class gives access to the audio files packed in an uncompressed tar
+ * archive. The archive is mapped into memory once and its members are
+ * indexed by name when it is opened, so reading a member needs no further
+ * file system access and no copy of its contents.
+ *
+ * POSIX ustar archives are supported, including GNU long names and the
+ * path and size records of pax extended headers, as written by GNU tar and
+ * Python's tarfile module. Only regular files are indexed. A leading "./" is
+ * removed from member names, so that archives created from "." can be
+ * addressed by the names of the files they hold.
+ *
+ * The archive is immutable once opened, so it may be shared between threads.
+ */
+class AudioArchive {
+ public:
+  /**
+   * Open an archive and index its members.
+   *
+   * @param path The path to the tar archive.
+   *
+   * @return The archive, else an error status if it could not be mapped or
+   *    is not a valid tar archive.
+   */
+  static absl::StatusOr<std::unique_ptr<AudioArchive>> Open(
+      const FilePath& path);
+
+  AudioArchive(const AudioArchive&) = delete;
+  AudioArchive& operator=(const AudioArchive&) = delete;
+
+  /**
+   * Find the contents of a member of the archive.
+   *
+   * @param name The name of the member.
+   *
+   * @return The contents of the member, valid for the lifetime of the
+   *    archive, or no value if there is no member with this name.
+   */
+  absl::optional<absl::Span<const char>> Find(absl::string_view name) const;
+
+  /**
+   * @return The number of regular files in the archive.
+   */
+  size_t NumMembers() const;
+
+ private:
+  explicit AudioArchive(std::unique_ptr<MappedFile> file);
+
+  /**
+   * Build the index of the members of the archive.
+   *
+   * @param path The path of the archive, for error messages.
+   *
+   * @return An 'OK' status if the archive is valid, else an error status.
+   */
+  absl::Status Index(const FilePath& path);
+
+  /**
+   * The mapped archive, which holds the contents of every member.
+   */
+  std::unique_ptr<MappedFile> file_;
+
+  /**
+   * The contents of each regular file in the archive, by member name.
+   */
+  std::unordered_map<std::string, absl::Span<const char>> members_;
+};
+}  // namespace Visqol
+
+#endif  // VISQOL_INCLUDE_AUDIO_ARCHIVE_H
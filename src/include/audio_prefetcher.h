@@ -0,0 +1,243 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VISQOL_INCLUDE_AUDIO_PREFETCHER_H
+#define VISQOL_INCLUDE_AUDIO_PREFETCHER_H
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
+#include "audio_signal.h"
+#include "file_path.h"
+#include "src/proto/similarity_result.pb.h"  // Generated by cc_proto_library rule
+
+namespace Visqol {
+
+/**
+ * A comparison of a batch, with the audio it needs for scoring.
+ */
+struct LoadedComparison {
+  /**
+   * The index of the comparison in the batch.
+   */
+  size_t index = 0;
+
+  /**
+   * The paths of the reference and degraded files.
+   */
+  ReferenceDegradedPathPair paths;
+
+  /**
+   * The reference signal, as loaded by LoadAsMono.
+   */
+  AudioSignal reference;
+
+  /**
+   * The degraded signal, as loaded by LoadAsMono.
+   */
+  AudioSignal degraded;
+
+  /**
+   * The key of the comparison in the result cache, if a cache is used.
+   */
+  std::string cache_key;
+
+  /**
+   * The result of the comparison, if it is already known without scoring,
+   * e.g. because it was cached. The signals are not loaded in this case.
+   */
+  absl::optional<SimilarityResultMsg> result;
+
+  /**
+   * The memory used by the loaded signals, in bytes.
+   */
+  size_t SignalBytes() const;
+};
+
+/**
+ * This class loads the audio of the upcoming comparisons of a batch on
+ * background threads, so that reading and decoding the files overlaps with
+ * scoring the earlier comparisons.
+ *
+ * At most a configured number of comparisons are loaded ahead of those taken
+ * by Next. Each comparison reserves an estimate of its memory when it starts
+ * loading, which is replaced by the memory of its signals once loaded, and
+ * none is started that would take the loaded and reserved memory over a
+ * configured limit. Comparisons are returned in batch order.
+ *
+ * The pairs are read under their own lock, so a load thread that waits for
+ * the next pair, e.g. from a manifest on the standard input, does not hold up
+ * Next or Stop. The destructor still waits for that read to return.
+ */
+class AudioPrefetcher {
+ public:
+  /**
+   * Produces the next pair to compare, returning false when there are none
+   * left. This is only called by one thread at a time.
+   */
+  using NextPairFunction = std::function<bool(ReferenceDegradedPathPair*)>;
+
+  /**
+   * Fills in the audio, or the result, of a comparison given its paths. This
+   * is called from several threads at once.
+   */
+  using LoadFunction = std::function<void(LoadedComparison*)>;
+
+  /**
+   * Estimates the memory that the signals of a comparison will use once
+   * loaded, in bytes, given its paths.
+   */
+  using EstimateFunction =
+      std::function<size_t(const ReferenceDegradedPathPair&)>;
+
+  /**
+   * The largest number of threads used to load comparisons.
+   */
+  static const size_t kMaxLoadThreads;
+
+  /**
+   * The memory that a mono signal of doubles uses per byte of a 16 bit audio
+   * file, the densest common encoding.
+   */
+  static const size_t kSignalBytesPerFileByte;
+
+  /**
+   * Construct a prefetcher and start loading the first comparisons.
+   *
+   * @param next_pair Produces the pairs of the batch.
+   * @param load Loads the audio of a comparison.
+   * @param depth The number of comparisons that may be loaded ahead. Must be
+   *    at least 1.
+   * @param max_bytes No comparison is started that would take the memory of
+   *    the loaded signals and of the estimates of those still loading over
+   *    this limit. At least one comparison is always loaded, however large it
+   *    is.
+   * @param estimate Estimates the memory of a comparison before it is loaded.
+   */
+  AudioPrefetcher(NextPairFunction next_pair, LoadFunction load, size_t depth,
+                  size_t max_bytes,
+                  EstimateFunction estimate = EstimateSignalBytes);
+
+  /**
+   * Stop loading and wait for the load threads to finish.
+   */
+  ~AudioPrefetcher();
+
+  AudioPrefetcher(const AudioPrefetcher&) = delete;
+  AudioPrefetcher& operator=(const AudioPrefetcher&) = delete;
+
+  /**
+   * Take the next comparison of the batch, waiting for it to be loaded. This
+   * is thread safe.
+   *
+   * @param comparison Set to the next comparison, if there is one.
+   *
+   * @return True if a comparison was taken. False at the end of the batch, or
+   *    once Stop has been called.
+   */
+  bool Next(LoadedComparison* comparison);
+
+  /**
+   * Stop loading comparisons. Later calls to Next return false.
+   */
+  void Stop();
+
+  /**
+   * Estimate the memory of a comparison from the sizes of its files, as if
+   * they held 16 bit samples. Files whose size is unknown, such as pipes,
+   * count as empty.
+   *
+   * @param paths The paths of the reference and degraded files.
+   *
+   * @return The estimated memory of the loaded signals, in bytes.
+   */
+  static size_t EstimateSignalBytes(const ReferenceDegradedPathPair& paths);
+
+ private:
+  /**
+   * A comparison that is being loaded or waiting to be taken.
+   */
+  struct Slot {
+    LoadedComparison comparison;
+    bool loaded = false;
+    // The estimated memory reserved while the slot is loading.
+    size_t reserved_bytes = 0;
+  };
+
+  /**
+   * The body of each load thread.
+   */
+  void LoadLoop();
+
+  const NextPairFunction next_pair_;
+  const LoadFunction load_;
+  const EstimateFunction estimate_;
+  const size_t depth_;
+  const size_t max_bytes_;
+
+  /**
+   * Serialises reading the pairs and starting their slots, so that slots are
+   * added in batch order. It is acquired before mutex_, and Next and Stop
+   * never acquire it.
+   */
+  absl::Mutex manifest_mutex_ ABSL_ACQUIRED_BEFORE(mutex_);
+
+  /**
+   * The index of the next comparison to start loading.
+   */
+  size_t next_index_ ABSL_GUARDED_BY(manifest_mutex_) = 0;
+
+  absl::Mutex mutex_;
+
+  /**
+   * The comparisons that are being loaded or waiting to be taken, in batch
+   * order. References to slots stay valid while other slots are added and
+   * removed at the ends.
+   */
+  std::deque<Slot> slots_ ABSL_GUARDED_BY(mutex_);
+
+  /**
+   * The memory used by the signals of the loaded slots.
+   */
+  size_t loaded_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  /**
+   * The memory reserved by the slots that are still loading.
+   */
+  size_t reserved_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  /**
+   * True once next_pair_ has returned false.
+   */
+  bool exhausted_ ABSL_GUARDED_BY(mutex_) = false;
+
+  /**
+   * True once Stop has been called.
+   */
+  bool stopped_ ABSL_GUARDED_BY(mutex_) = false;
+
+  std::vector<std::thread> threads_;
+};
+}  // namespace Visqol
+
+#endif  // VISQOL_INCLUDE_AUDIO_PREFETCHER_H
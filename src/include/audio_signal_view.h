@@ -0,0 +1,144 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VISQOL_INCLUDE_AUDIO_SIGNAL_VIEW_H
+#define VISQOL_INCLUDE_AUDIO_SIGNAL_VIEW_H
+
+#include <cstddef>
+
+#include "absl/types/span.h"
+#include "audio_signal.h"
+
+namespace Visqol {
+
+/**
+ * A read-only view of the samples of a mono audio signal. The view can be
+ * sliced, padded with silence at either end and scaled by a gain, all without
+ * copying the samples, so aligning and slicing signals costs O(1).
+ *
+ * The view does not own the samples, which must outlive it.
+ */
+class AudioSignalView {
+ public:
+  AudioSignalView() = default;
+
+  /**
+   * View the first channel of a signal. AudioSignals convert implicitly, so
+   * that they can be passed wherever a view is consumed.
+   *
+   * @param signal The signal to view. It must outlive the view.
+   */
+  AudioSignalView(const AudioSignal& signal);  // NOLINT(runtime/explicit)
+
+  /**
+   * A view of a temporary signal would be left dangling.
+   */
+  AudioSignalView(AudioSignal&& signal) = delete;
+
+  /**
+   * View a span of samples.
+   *
+   * @param samples The samples to view. They must outlive the view.
+   * @param sample_rate The sample rate of the samples.
+   */
+  AudioSignalView(absl::Span<const double> samples, size_t sample_rate);
+
+  /**
+   * @return The number of samples, including the silence padding.
+   */
+  size_t NumSamples() const {
+    return num_leading_zeros_ + samples_.size() + num_trailing_zeros_;
+  }
+
+  /**
+   * @return The sample rate of the signal.
+   */
+  size_t GetSampleRate() const { return sample_rate_; }
+
+  /**
+   * Get the duration (in seconds) of the signal.
+   */
+  double GetDuration() const {
+    return NumSamples() / static_cast<double>(sample_rate_);
+  }
+
+  /**
+   * @return The sample at the given index, with the gain applied.
+   */
+  double operator[](size_t index) const {
+    if (index < num_leading_zeros_ ||
+        index >= num_leading_zeros_ + samples_.size()) {
+      return 0.0;
+    }
+    return gain_ * samples_[index - num_leading_zeros_];
+  }
+
+  /**
+   * Get a view of a range of the samples. The range is clamped to the
+   * signal.
+   *
+   * @param start The index of the first sample of the range.
+   * @param end The index one past the last sample of the range.
+   *
+   * @return A view of the samples in [start, end).
+   */
+  AudioSignalView Slice(size_t start, size_t end) const;
+
+  /**
+   * Get a view of the signal with silence added at either end.
+   *
+   * @param num_leading_zeros The number of zeros to add before the signal.
+   * @param num_trailing_zeros The number of zeros to add after the signal.
+   *
+   * @return The padded view.
+   */
+  AudioSignalView Padded(size_t num_leading_zeros,
+                         size_t num_trailing_zeros) const;
+
+  /**
+   * Get a view of the signal scaled by a gain.
+   *
+   * @param gain The factor to scale the samples by.
+   *
+   * @return The scaled view.
+   */
+  AudioSignalView Scaled(double gain) const;
+
+  /**
+   * Copy a range of the samples, with the gain applied.
+   *
+   * @param start The index of the first sample to copy.
+   * @param count The number of samples to copy. The range must lie within
+   *    the signal.
+   * @param out The buffer to copy the samples to.
+   */
+  void CopySamples(size_t start, size_t count, double* out) const;
+
+  /**
+   * @return A mono signal holding a copy of the samples of the view.
+   */
+  AudioSignal ToSignal() const;
+
+ private:
+  absl::Span<const double> samples_;
+  size_t num_leading_zeros_ = 0;
+  size_t num_trailing_zeros_ = 0;
+  double gain_ = 1.0;
+  size_t sample_rate_ = 0;
+};
+}  // namespace Visqol
+
+#endif  // VISQOL_INCLUDE_AUDIO_SIGNAL_VIEW_H
@@ -22,7 +22,9 @@
 #include <vector>
 
 #include "absl/status/statusor.h"
+#include "absl/types/optional.h"
 #include "file_path.h"
+#include "wav_reader.h"
 
 namespace Visqol {
 
@@ -69,6 +71,13 @@ struct CommandLineArgs {
    */
   FilePath batch_input_csv;
 
+  /**
+   * The path to an uncompressed tar archive holding the audio files of the
+   * batch. If set, the paths in the batch CSV file are the names of members
+   * of the archive. Optional.
+   */
+  FilePath batch_input_archive;
+
   /**
    * The path to a txt file for storing additional debug info generated by the
    * comparisons. Optional.
@@ -116,6 +125,64 @@ struct CommandLineArgs {
   * If true, disables patch-wise realignment.
   **/
   bool disable_realignment;
+
+  /**
+  * If true, patch-wise realignment only searches small lags.
+  **/
+  bool bounded_realignment = false;
+
+  /**
+  * If true, the input audio is resampled to the sample rate of the mode.
+  **/
+  bool resample_input = false;
+
+  /**
+  * If true, the low frequency bands are filtered at a reduced sample rate.
+  **/
+  bool multirate_filterbank = false;
+
+  /**
+  * If set, the input audio is read as raw PCM in this format.
+  **/
+  absl::optional<WavReader::PcmFormat> raw_pcm_format;
+
+  /**
+  * The number of worker threads used to run the comparisons.
+  **/
+  int num_threads = 1;
+
+  /**
+  * If true, comparisons already in the results CSV are skipped and only new
+  * results are appended.
+  **/
+  bool resume = false;
+
+  /**
+  * The index of the batch shard to run, from 0 to num_shards - 1.
+  **/
+  int shard_index = 0;
+
+  /**
+  * The number of shards the batch is split into. Each pair is assigned to a
+  * shard by a stable hash of its file paths.
+  **/
+  int num_shards = 1;
+
+  /**
+  * The directory to cache comparison results in. Optional.
+  **/
+  FilePath result_cache_dir;
+
+  /**
+  * The number of batch comparisons to load ahead of scoring. If 0, each
+  * comparison is loaded when it is scored.
+  **/
+  int prefetch_depth = 0;
+
+  /**
+  * The memory limit in megabytes of the audio loaded ahead of scoring.
+  **/
+  int prefetch_max_mb = 1024;
 };
 
 /**
@@ -156,6 +223,16 @@ class VisqolCommandLineParser {
    */
   static bool FileExists(const FilePath& path);
 
+  /**
+   * For a given input audio path, check if it can be read: either the file
+   * exists or the path refers to the standard input.
+   *
+   * @param path A FilePath to check.
+   *
+   * @return True if the input can be read, else false.
+   */
+  static bool IsReadableInput(const FilePath& path);
+
   /**
    * Parses a batch CSV file to return a vector of file path pairs
    * for comparison.
@@ -22,6 +22,7 @@
 
 #include "absl/status/statusor.h"
 #include "amatrix.h"
+#include "audio_signal_view.h"
 #include "image_patch_creator.h"
 #include "patch_similarity_comparator.h"
 #include "spectrogram_builder.h"
@@ -38,9 +39,16 @@ class ComparisonPatchesSelector {
   /**
    * Constructor that takes a patch similarity comparator for performing the
    * patch comparison.
+   *
+   * @param sim_comparator The comparator used to measure patch similarity.
+   * @param bounded_realignment If true, patch realignment only searches lags
+   *    of up to half a spectrogram frame hop, which is much cheaper than a
+   *    search over every lag. Scores may then differ from the conformance
+   *    scores for badly aligned or mismatched inputs.
    */
   ComparisonPatchesSelector(
-      std::unique_ptr<PatchSimilarityComparator> sim_comparator);
+      std::unique_ptr<PatchSimilarityComparator> sim_comparator,
+      bool bounded_realignment = false);
 
   /**
    * For each patch provided (from the reference spectrogram) find the most
@@ -89,21 +97,22 @@ class ComparisonPatchesSelector {
   absl::StatusOr<std::vector<PatchSimilarityResult>>
   FinelyAlignAndRecreatePatches(
       const std::vector<PatchSimilarityResult>& sim_results,
-      const AudioSignal& ref_signal, const AudioSignal& deg_signal,
+      const AudioSignalView& ref_signal, const AudioSignalView& deg_signal,
       SpectrogramBuilder* spect_builder, const AnalysisWindow& window) const;
 
  private:
   /**
-   * Extract a subregion of an audio signal.
+   * Extract a subregion of an audio signal, without copying its samples.
    *
    * @param in_signal An AudioSignal.
    * @param start_time The start time of the sliced audio in seconds.
    * @param end_time The end time of the sliced audio in seconds.
    *
-   * @return A new AudioSignal containing the subregion.
+   * @return A view of the subregion, padded with silence where it extends
+   *    past the signal.
    */
-  static AudioSignal Slice(const AudioSignal& in_signal, double start_time,
-                           double end_time);
+  static AudioSignalView Slice(const AudioSignalView& in_signal,
+                               double start_time, double end_time);
 
   /**
    * Based on the input locations and dimensions, build a patch from the input
@@ -194,6 +203,11 @@ class ComparisonPatchesSelector {
    * The patch comparator to use for comparisons.
    */
   const std::unique_ptr<PatchSimilarityComparator> sim_comparator_;
+
+  /**
+   * True if patch realignment should only search a bounded range of lags.
+   */
+  const bool bounded_realignment_;
 };
 }  // namespace Visqol
 
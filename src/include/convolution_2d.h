@@ -36,7 +36,7 @@ class Convolution2D {
    * @return The resulting 'valid' 2d convolution.
    */
   static AMatrix<T> Valid2DConvWithBoundary(const AMatrix<T>& fir_filter,
-                                            AMatrix<T> input_matrix);
+                                            const AMatrix<T>& input_matrix);
 
  private:
   /**
@@ -46,7 +46,7 @@ class Convolution2D {
    *
    * @return The padded matrix.
    */
-  static AMatrix<T> AddMatrixBoundary(AMatrix<T>&& input_matrix);
+  static AMatrix<T> AddMatrixBoundary(const AMatrix<T>& input_matrix);
 
   /**
    * Copies a matrix into another matrix, adding the specified amounts of empty
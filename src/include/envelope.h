@@ -17,9 +17,10 @@
 #ifndef VISQOL_INCLUDE_ENVELOPE_H
 #define VISQOL_INCLUDE_ENVELOPE_H
 
-#include <complex>
+#include <cstddef>
 
 #include "amatrix.h"
+#include "audio_signal_view.h"
 
 namespace Visqol {
 
@@ -32,22 +33,47 @@ class Envelope {
    * For a given signal, calculate the upper envelope.
    * Assumes a single dimensional input matrix.
    *
+   * The envelope is the magnitude of the signal's Hilbert transform, as
+   * produced by the original FFT based implementation (itself based on the
+   * Matlab implementation for Hilbert). That implementation only kept the
+   * real part of the inverse transform, which reduces to a scaled copy of the
+   * signal minus its DC and Nyquist bins. The envelope is therefore computed
+   * in two streaming passes over the signal, without an FFT and without any
+   * buffers proportional to the signal length other than the output. There
+   * are no block boundary effects, and the result matches the single
+   * precision FFT implementation to within 1e-6 of the envelope's largest
+   * magnitude.
+   *
    * @param signal The input single dimensional matrix representing the signal.
    * @return The upper envelope for the input signal.
    */
   static AMatrix<double> CalcUpperEnv(const AMatrix<double>& signal);
 
+  /**
+   * For a given signal view, calculate the upper envelope of its samples,
+   * including any silence padding and gain. This avoids copying a sliced or
+   * aligned signal just to calculate its envelope.
+   *
+   * @param signal The signal to calculate the envelope of.
+   * @return The upper envelope for the input signal.
+   */
+  static AMatrix<double> CalcUpperEnv(const AudioSignalView& signal);
+
  private:
   /**
-   * Perform a Hilbert Transform on a given single dimensional input signal.
-   * Based on the Matlab implementation for Hilbert.
+   * Calculate the upper envelope of a sequence of samples.
    *
-   * @param signal The input single dimensional signal to perform the Hilbert
-   *               transform on.
-   * @return The matrix of complex doubles containing the result of the Hilbert
-   *         Transform.
+   * @param samples The samples, indexable by position.
+   * @param length The number of samples.
+   * @return The upper envelope of the samples.
+   */
+  template <typename Samples>
+  static AMatrix<double> CalcUpperEnv(const Samples& samples, size_t length);
+
+  /**
+   * The number of samples accumulated per partial sum.
    */
-  static AMatrix<std::complex<double>> Hilbert(const AMatrix<double>& signal);
+  static const size_t kBlockSize;
 };
 }  // namespace Visqol
 
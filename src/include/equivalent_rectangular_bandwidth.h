@@ -63,6 +63,30 @@ class EquivalentRectangularBandwidth {
                                       std::size_t num_channels, double low_freq,
                                       double high_freq);
 
+  /**
+   * Calculate the filter coefficients for a given set of center frequencies.
+   * This allows a subset of the bands from the other MakeFilters overload to
+   * be designed for a different (e.g. decimated) sample rate.
+   *
+   * @param sample_rate The sample rate that the filters will be applied at.
+   * @param center_freqs The center frequencies of the bands, which should all
+   *    be below half the sample rate.
+   *
+   * @return The given center frequencies and their filter coefficients.
+   */
+  static ErbFiltersResult MakeFilters(double sample_rate,
+                                      const std::vector<double>& center_freqs);
+
+  /**
+   * Calculate the equivalent rectangular bandwidth of an auditory filter,
+   * using the Glasberg and Moore parameters.
+   *
+   * @param center_freq The center frequency of the filter.
+   *
+   * @return The bandwidth of the filter in Hz.
+   */
+  static double CalcBandwidth(double center_freq);
+
  private:
   /**
    * Compute N center frequencies that are uniformly spaced between the given
@@ -0,0 +1,275 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef VISQOL_INCLUDE_FLAC_READER_H_
+#define VISQOL_INCLUDE_FLAC_READER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <vector>
+
+namespace Visqol {
+
+/**
+ *  Streaming FLAC decoder that supports all of the subframe types and
+ *  stereo decorrelation modes of the format, for any number of channels and
+ *  sample sizes up to 32 bits.
+ *
+ *  The stream is decoded one frame at a time, so only the compressed data of
+ *  the frame being decoded is held in memory, and it is only read forwards,
+ *  so it does not need to be seekable. Each frame is checked against its
+ *  CRC; the MD5 signature of the whole stream is not checked.
+ */
+class FlacReader {
+ public:
+  /**
+   * Check whether a stream starts with the FLAC signature, without consuming
+   * any of it. Only the first byte can be examined without reading from the
+   * stream, which is enough to tell FLAC ("fLaC") from RIFF WAVE ("RIFF").
+   * The rest of the signature is checked when the stream is decoded.
+   *
+   * @param binary_stream Binary input stream to check.
+   * @return True if the stream looks like a FLAC stream.
+   */
+  static bool HasSignature(std::istream* binary_stream);
+
+  /**
+   * Constructor decodes the FLAC signature and metadata blocks.
+   *
+   * @param binary_stream Binary input stream to read from.
+   */
+  explicit FlacReader(std::istream* binary_stream);
+
+  /**
+   * True if the FLAC metadata was successfully parsed.
+   */
+  bool IsHeaderValid() const;
+
+  /**
+   * Returns the total number of interleaved samples given in the metadata.
+   * Returns 0 if the length is not known.
+   */
+  size_t GetNumTotalSamples() const;
+
+  /**
+   * True if the metadata gives the number of samples in the stream.
+   */
+  bool IsLengthKnown() const;
+
+  /**
+   * Returns number of channels.
+   */
+  size_t GetNumChannels() const;
+
+  /**
+   * Returns sample rate in Hertz.
+   */
+  int GetSampleRateHz() const;
+
+  /**
+   * Returns the number of bits in each sample.
+   */
+  int GetBitsPerSample() const;
+
+  /**
+   * Returns the duration of the stream in seconds, or 0 if it is not known.
+   */
+  double GetDuration() const;
+
+  /**
+   * Reads frames from the stream, downmixes them to mono and normalizes them
+   * to the range [-1, 1) by the full scale of the sample size. The samples of
+   * each frame are averaged.
+   *
+   * FLAC frames are decoded as they are needed, so any number of frames can
+   * be read while only holding a single decoded FLAC frame. Reading stops at
+   * the end of the stream or at the first frame that cannot be decoded.
+   *
+   * @param num_frames Number of frames to read.
+   * @param target_buffer Target buffer for num_frames mono samples.
+   * @return Number of frames written to the target buffer.
+   */
+  size_t ReadMonoFrames(size_t num_frames, double* target_buffer);
+
+ private:
+  /**
+   * Parses the signature and metadata blocks.
+   *
+   * @return True on success.
+   */
+  bool ParseMetadata();
+
+  /**
+   * Decodes the next FLAC frame, if the stream has one. Logs an error if the
+   * frame cannot be decoded.
+   *
+   * @return True on success, false at the end of the stream or on an error.
+   */
+  bool NextFrame();
+
+  /**
+   * Decodes the FLAC frame at the read position into decoded_samples_.
+   *
+   * @return True on success.
+   */
+  bool DecodeFrame();
+
+  /**
+   * Decodes a subframe, i.e. the samples of one channel of a frame.
+   *
+   * @param bits_per_sample The sample size of the subframe.
+   * @param samples Target buffer for block_size_ samples.
+   * @return True on success.
+   */
+  bool DecodeSubframe(int bits_per_sample, int64_t* samples);
+
+  /**
+   * Decodes the Rice coded prediction residual of a subframe.
+   *
+   * @param predictor_order The number of warm-up samples before the residual.
+   * @param residual Target buffer for block_size_ - predictor_order values.
+   * @return True on success.
+   */
+  bool DecodeResidual(int predictor_order, int64_t* residual);
+
+  /**
+   * Makes sure that the input buffer holds at least the given number of
+   * bits after the read position, reading more of the stream if needed.
+   *
+   * @param num_bits Number of bits needed.
+   * @return False if the stream ends before that many bits.
+   */
+  bool EnsureBits(size_t num_bits);
+
+  /**
+   * Returns the 64 bits at the read position, most significant first. The
+   * bits after the end of the data read from the stream are undefined.
+   */
+  uint64_t LoadWord() const;
+
+  /**
+   * Reads an unsigned big endian value of up to 32 bits.
+   */
+  bool ReadBits(int num_bits, uint32_t* value);
+
+  /**
+   * Reads a two's complement value of up to 33 bits.
+   */
+  bool ReadSignedBits(int num_bits, int64_t* value);
+
+  /**
+   * Reads a unary coded value: the number of zero bits before a one bit.
+   */
+  bool ReadUnary(uint32_t* value);
+
+  /**
+   * Skips bytes in the stream. The read position must be byte aligned.
+   *
+   * @param size Number of bytes to skip.
+   * @return True if that many bytes were skipped.
+   */
+  bool SkipBytes(size_t size);
+
+  /**
+   * Moves the unread bytes to the start of the input buffer, so that the
+   * buffer only holds the frame that is about to be decoded and what has
+   * been read after it.
+   */
+  void DiscardReadBytes();
+
+  /**
+   * Binary input stream.
+   */
+  std::istream* binary_stream_;
+
+  /**
+   * Flag indicating if the metadata was parsed successfully.
+   */
+  bool init_;
+
+  /**
+   * Number of audio channels.
+   */
+  size_t num_channels_;
+
+  /**
+   * Sample rate in Hertz.
+   */
+  int sample_rate_hz_;
+
+  /**
+   * Number of bits in each sample.
+   */
+  int bits_per_sample_;
+
+  /**
+   * Total number of interleaved samples, or 0 if it is not known.
+   */
+  size_t num_total_samples_;
+
+  /**
+   * Compressed data read from the stream, followed by padding so that the
+   * bit reader can always load a whole word.
+   */
+  std::vector<uint8_t> input_buffer_;
+
+  /**
+   * Number of bytes of the input buffer read from the stream.
+   */
+  size_t input_size_;
+
+  /**
+   * Read position in the input buffer, in bits.
+   */
+  size_t bit_position_;
+
+  /**
+   * True once the stream has no more data.
+   */
+  bool end_of_stream_;
+
+  /**
+   * True once a frame could not be decoded, after which nothing more is read.
+   */
+  bool decode_failed_;
+
+  /**
+   * The samples of the last decoded frame, one channel after the other.
+   */
+  std::vector<int64_t> decoded_samples_;
+
+  /**
+   * The number of samples per channel in the last decoded frame.
+   */
+  size_t block_size_;
+
+  /**
+   * The number of samples per channel of the last decoded FLAC frame that
+   * have already been read.
+   */
+  size_t block_position_;
+
+  /**
+   * The number of FLAC frames decoded so far, for error messages.
+   */
+  size_t num_frames_decoded_;
+};
+
+}  // namespace Visqol
+
+#endif  // VISQOL_INCLUDE_FLAC_READER_H_
@@ -49,7 +49,7 @@ class GammatoneSpectrogramBuilder : public SpectrogramBuilder {
                                        const bool use_speech_mode);
 
   // Docs inherited from parent.
-  absl::StatusOr<Spectrogram> Build(const AudioSignal& signal,
+  absl::StatusOr<Spectrogram> Build(const AudioSignalView& signal,
                                     const AnalysisWindow& window) override;
 
  private:
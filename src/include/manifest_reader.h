@@ -0,0 +1,122 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VISQOL_INCLUDE_MANIFEST_READER_H
+#define VISQOL_INCLUDE_MANIFEST_READER_H
+
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "file_path.h"
+
+namespace Visqol {
+
+/**
+ * This class reads the reference/degraded file path pairs from a batch CSV
+ * manifest one row at a time, so that a manifest of any length can be
+ * processed in bounded memory and scoring can start on the first row.
+ *
+ * The first row of the manifest is a header and is skipped. Each following
+ * row holds a reference path and a degraded path separated by a comma. Empty
+ * rows and rows with fewer than two columns are skipped with a warning. Any
+ * columns after the second are ignored.
+ */
+class ManifestReader {
+ public:
+  /**
+   * The path that refers to the standard input rather than a file.
+   */
+  static const char kStdinPath[];
+
+  /**
+   * Open a manifest for reading.
+   *
+   * @param manifest_path The path to the batch CSV file, or kStdinPath to read
+   *    the manifest from the standard input.
+   *
+   * @return The manifest reader if the manifest could be opened, else an
+   *    error status.
+   */
+  static absl::StatusOr<std::unique_ptr<ManifestReader>> Open(
+      const FilePath& manifest_path);
+
+  /**
+   * Read the next file path pair from the manifest.
+   *
+   * @param pair Set to the next pair, if there is one.
+   *
+   * @return True if a pair was read. False at the end of the manifest.
+   */
+  bool Next(ReferenceDegradedPathPair* pair);
+
+  /**
+   * Parse the reference and degraded file paths from the first two columns of
+   * a CSV row. This is also used for the rows of results CSV files, which
+   * start with the same two columns.
+   *
+   * @param line The CSV row, without its line ending.
+   * @param pair Set to the parsed pair, if the row has at least two columns.
+   *
+   * @return True if the row had at least two columns.
+   */
+  static bool ParseRow(const std::string& line,
+                       ReferenceDegradedPathPair* pair);
+
+  /**
+   * Assign a pair to one of a number of shards. The assignment depends only
+   * on the file paths of the pair, so it is the same in every process and on
+   * every host.
+   *
+   * @param pair The pair to assign.
+   * @param num_shards The number of shards. Must be at least 1.
+   *
+   * @return The index of the shard, from 0 to num_shards - 1.
+   */
+  static size_t ShardIndex(const ReferenceDegradedPathPair& pair,
+                           size_t num_shards);
+
+ private:
+  /**
+   * Construct a reader for the given stream.
+   *
+   * @param owned_stream The stream to read, if it is owned by the reader.
+   *    Null when reading the standard input.
+   * @param stream The stream to read.
+   */
+  ManifestReader(std::unique_ptr<std::istream> owned_stream,
+                 std::istream* stream);
+
+  /**
+   * The stream being read, if it is owned by this reader.
+   */
+  std::unique_ptr<std::istream> owned_stream_;
+
+  /**
+   * The stream being read.
+   */
+  std::istream* stream_;
+
+  /**
+   * The number of rows read so far, including the header.
+   */
+  size_t line_number_ = 0;
+};
+}  // namespace Visqol
+
+#endif  // VISQOL_INCLUDE_MANIFEST_READER_H
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VISQOL_INCLUDE_MAPPED_FILE_H
+#define VISQOL_INCLUDE_MAPPED_FILE_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "file_path.h"
+
+namespace Visqol {
+
+/**
+ * A read-only view of the contents of a file. On POSIX systems the file is
+ * memory mapped, so its pages are only read when they are first accessed and
+ * no copy of the contents is made. On other systems the file is read into
+ * memory.
+ */
+class MappedFile {
+ public:
+  /**
+   * Map a file into memory. Only regular files are mapped. Other files, such
+   * as pipes and devices, are not opened at all, so that they can still be
+   * read as a stream.
+   *
+   * @param path The path of the file to map.
+   *
+   * @return The mapped file, else an error status if it is not a regular file
+   *    or could not be opened.
+   */
+  static absl::StatusOr<std::unique_ptr<MappedFile>> Open(const FilePath& path);
+
+  /**
+   * Unmap the file.
+   */
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /**
+   * @return The contents of the file, valid for the lifetime of this object.
+   */
+  absl::Span<const char> Contents() const;
+
+ private:
+  MappedFile() = default;
+
+  /**
+   * The start of the mapping, or nullptr if the file is empty or was read
+   * into buffer_ instead.
+   */
+  void* mapping_ = nullptr;
+
+  /**
+   * The size of the file in bytes.
+   */
+  size_t size_ = 0;
+
+  /**
+   * The contents of the file, on systems without memory mapping.
+   */
+  std::string buffer_;
+};
+}  // namespace Visqol
+
+#endif  // VISQOL_INCLUDE_MAPPED_FILE_H
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VISQOL_INCLUDE_MATRIX_ARENA_H
+#define VISQOL_INCLUDE_MATRIX_ARENA_H
+
+#include <cstddef>
+
+namespace Visqol {
+
+/**
+ * A per-thread pool for the memory of matrices.
+ *
+ * Armadillo allocates the memory of every AMatrix and ImagePatch through
+ * Allocate and Release. A single comparison creates a very large number of
+ * short-lived matrices, so while a Scope is active on a thread, released
+ * memory is kept in that thread's pool and handed out again for matrices of
+ * a similar size instead of going back to the system. When the outermost
+ * Scope of the thread ends, the pooled memory is freed in bulk. Memory
+ * allocated outside a Scope is never pooled, and is not rounded up to a
+ * pooled block size.
+ *
+ * Matrices may outlive the Scope they were created in, and may be released
+ * on a different thread to the one that allocated them. Memory is only ever
+ * pooled once it has been released, so this is always safe.
+ */
+class MatrixArena {
+ public:
+  /**
+   * Pools released matrix memory on the current thread for as long as it is
+   * alive. Scopes may be nested.
+   */
+  class Scope {
+   public:
+    Scope();
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+  };
+
+  /**
+   * Allocate memory for the elements of a matrix.
+   *
+   * @param num_bytes The number of bytes to allocate.
+   *
+   * @return The allocated memory, aligned to kAlignment bytes, or nullptr if
+   *     the allocation failed.
+   */
+  static void* Allocate(size_t num_bytes);
+
+  /**
+   * Release memory returned by Allocate.
+   *
+   * @param memory The memory to release. May be nullptr.
+   */
+  static void Release(void* memory);
+
+  /**
+   * @return The number of bytes pooled for reuse on the current thread.
+   */
+  static size_t PooledBytes();
+
+  /**
+   * The alignment of the memory returned by Allocate, in bytes.
+   */
+  static const size_t kAlignment;
+
+  /**
+   * The capacity of the smallest pooled block, in bytes.
+   */
+  static const size_t kMinBlockBytes;
+
+  /**
+   * Allocations larger than this are never pooled.
+   */
+  static const size_t kMaxBlockBytes;
+
+  /**
+   * The most memory a single thread pools for reuse, in bytes.
+   */
+  static const size_t kMaxPooledBytes;
+};
+}  // namespace Visqol
+
+#endif  // VISQOL_INCLUDE_MATRIX_ARENA_H
@@ -17,14 +17,20 @@
 #ifndef VISQOL_INCLUDE_MISCAUDIO_H
 #define VISQOL_INCLUDE_MISCAUDIO_H
 
+#include <cstdint>
+#include <istream>
+#include <string>
 #include <vector>
 
 #include "absl/types/optional.h"
+#include "absl/types/span.h"
 #include "amatrix.h"
 #include "audio_signal.h"
+#include "audio_signal_view.h"
 #include "file_path.h"
 #include "misc_math.h"
 #include "spectrogram.h"
+#include "wav_reader.h"
 
 namespace Visqol {
 
@@ -54,17 +60,21 @@ class MiscAudio {
    * @param reference The reference signal whose spl is to be matched.
    * @param degraded The degraded signal whose spl is to be scaled.
    *
-   * @return The new degraded signal with an spl that has been scaled to match
-   *    that of the input reference signal.
+   * @return A view of the degraded signal with a gain that scales its spl to
+   *    match that of the input reference signal.
    */
-  static AudioSignal ScaleToMatchSoundPressureLevel(
-      const AudioSignal& reference, const AudioSignal& degraded);
+  static AudioSignalView ScaleToMatchSoundPressureLevel(
+      const AudioSignalView& reference, const AudioSignalView& degraded);
 
   /**
    * For a given audio file, load it in mono. Files with more than 1 channel
    * will be downmixed to mono.
    *
-   * Currently only WAV files are supported.
+   * Regular files are mapped into memory. Other files, such as named pipes
+   * and /dev/fd/N, are read as streams, and the path "-" reads the standard
+   * input.
+   *
+   * WAV and FLAC files are supported, and are told apart by their signature.
    *
    * @param path The path to the audio file to load.
    *
@@ -72,22 +82,114 @@ class MiscAudio {
    */
   static AudioSignal LoadAsMono(const FilePath& path);
 
+  /**
+   * For a given file of raw interleaved PCM samples, load it in mono. Files
+   * with more than 1 channel will be downmixed to mono. The path is opened in
+   * the same way as by LoadAsMono.
+   *
+   * @param path The path to the raw PCM file to load.
+   * @param format The format of the samples in the file.
+   *
+   * @return The mono audio signal.
+   */
+  static AudioSignal LoadRawPcmAsMono(const FilePath& path,
+                                      const WavReader::PcmFormat& format);
+
+  /**
+   * For a given stream of raw interleaved PCM samples, load it in mono. Audio
+   * with more than 1 channel will be downmixed to mono. The stream is read
+   * until it ends.
+   *
+   * @param stream Raw PCM stream to load.
+   * @param format The format of the samples in the stream.
+   * @param filepath Optional filepath for logging purposes.
+   *
+   * @return The mono audio signal.
+   */
+  static AudioSignal LoadRawPcmAsMono(
+      std::istream* stream, const WavReader::PcmFormat& format,
+      absl::optional<std::string> filepath = absl::nullopt);
+
+  /**
+   * For raw interleaved PCM samples held in memory, e.g. a member of a mapped
+   * archive, load them in mono. Audio with more than 1 channel will be
+   * downmixed to mono. The samples are read in place, without copying them.
+   *
+   * @param pcm_data The raw PCM samples.
+   * @param format The format of the samples.
+   * @param filepath Optional filepath for logging purposes.
+   *
+   * @return The mono audio signal.
+   */
+  static AudioSignal LoadRawPcmAsMono(
+      absl::Span<const char> pcm_data, const WavReader::PcmFormat& format,
+      absl::optional<std::string> filepath = absl::nullopt);
+
   /**
    * For a given audio stream, load it in mono. Audio with more than 1 channel
    * will be downmixed to mono.
    *
-   * Currently only WAV streams are supported.
+   * The stream is read forwards in blocks that are downmixed as they are read,
+   * so it does not need to be seekable. If the WAV header does not give the
+   * length of the data, e.g. because it was written to a pipe, the stream is
+   * read until it ends. FLAC streams are decoded one frame at a time as they
+   * are read.
+   *
+   * WAV and FLAC streams are supported, and are told apart by their
+   * signature.
+   *
+   * @param stream Audio stream to load.
+   *
+   * @param filepath Optional filepath for logging purposes.
+   *
+   * @return The mono audio signal.
+   */
+  static AudioSignal LoadAsMono(
+      std::istream* stream,
+      absl::optional<std::string> filepath = absl::nullopt);
+
+  /**
+   * For audio held in memory, e.g. a mapped file, load it in mono. Audio with
+   * more than 1 channel will be downmixed to mono. The samples are read in
+   * place, without copying the interleaved data.
    *
-   * @param string_stream Audio stream to load.
+   * WAV and FLAC data are supported.
    *
+   * @param wav_data The contents of the WAV or FLAC file.
    * @param filepath Optional filepath for logging purposes.
    *
    * @return The mono audio signal.
    */
   static AudioSignal LoadAsMono(
-      std::stringstream* string_stream,
+      absl::Span<const char> wav_data,
       absl::optional<std::string> filepath = absl::nullopt);
 
+  /**
+   * Downmixes interleaved 16-bit samples to mono, normalizing them to the
+   * range [-1, 1), in a single pass. The samples of each frame are averaged.
+   *
+   * The interleaving is assumed to be in the format:
+   * [C1-S1, C2-S1, C1-S2, C2-S2, C1-S3, C2-S3] where C is Channel and S is
+   * Sample.
+   *
+   * @param interleaved The interleaved samples, a whole number of frames.
+   * @param num_channels The number of channels in each frame.
+   * @param mono The target for one sample per frame.
+   */
+  static void InterleavedToMono(absl::Span<const int16_t> interleaved,
+                                size_t num_channels, absl::Span<double> mono);
+
+  /**
+   * Downmixes interleaved samples that are already normalized to mono, in a
+   * single pass. The samples of each frame are averaged.
+   *
+   * @param interleaved The interleaved samples, a whole number of frames.
+   * @param num_channels The number of channels in each frame.
+   * @param mono The target for one sample per frame.
+   */
+  static void InterleavedToMono(absl::Span<const double> interleaved,
+                                size_t num_channels, absl::Span<double> mono);
+
   /**
    * Performs some basic preparation on the input spectrograms so that they are
    * suitable for comparison to each other.
@@ -98,33 +200,27 @@ class MiscAudio {
   static void PrepareSpectrogramsForComparison(Spectrogram& reference,
                                                Spectrogram& degraded);
 
- private:
   /**
-   * For a given audio signal, downmix it to mono. If already mono, no work is
-   * performed. The downmixing is performed by simply averaging the value of
-   * each sample at each index across the channels.
-   *
-   * Assumes that channels are stored in columns with the samples in rows.
+   * Performs the part of the comparison preparation that only depends on a
+   * single spectrogram: conversion to dB and an absolute noise floor.
    *
-   * @param signal The audio signal to downmix to mono.
-   *
-   * @return The downmixed mono audio signal.
+   * @param spectrogram The spectrogram to prepare.
    */
-  static AudioSignal ToMono(const AudioSignal& signal);
+  static void PrepareSpectrogramForComparison(Spectrogram& spectrogram);
 
   /**
-   * For a given data matrix, downmix it to mono. If already mono, no work is
-   * performed. The downmixing is performed by simply averaging the value of
-   * each sample at each index across the channels.
-   *
-   * Assumes that channels are stored in columns with the samples in rows.
-   *
-   * @param signal The data matrix to downmix to mono.
+   * Performs the part of the comparison preparation that depends on both
+   * spectrograms: a per-frame relative noise floor and normalization to a
+   * common 0dB floor. Both spectrograms must already have been prepared with
+   * PrepareSpectrogramForComparison.
    *
-   * @return The downmixed mono data matrix.
+   * @param reference The reference spectrogram.
+   * @param degraded The degraded spectrogram.
    */
-  static AMatrix<double> ToMono(const AMatrix<double>& signal);
+  static void ApplyCommonNoiseFloor(Spectrogram& reference,
+                                    Spectrogram& degraded);
 
+ private:
   /**
    * For a given audio signal, calculate (in dB) the sound pressure level.
    *
@@ -136,25 +232,21 @@ class MiscAudio {
    *
    * @return The signal's sound pressure level in dB.
    */
-  static double CalcSoundPressureLevel(const AudioSignal& signal);
+  static double CalcSoundPressureLevel(const AudioSignalView& signal);
 
+ private:
   /**
-   * Takes a vector that contains samples from multiple channels that have been
-   * interleaved and extracts each individual channel from the interleaved
-   * vector. Each extracted channel is placed in an individual vector and then
-   * all channels are returned in a vector of vectors.
-   *
-   * As an example, for a stero file, the interleaving is assumed to be in the
-   * format: [C1-S1, C2-S1, C1-S2, C2-S2, C1-S3, C2-S3] where C is Channel
-   * and S is Sample.
+   * Read all of the frames from a reader, downmixing them to mono.
    *
-   * @param num_channels The number of channels in the interleaved vector.
-   * @param interleaved_vector The vector of multi-channel interleaved samples.
+   * @param reader The WavReader or FlacReader to read from.
+   * @param filepath Optional filepath for logging purposes.
    *
-   * @return The extracted channels stored in individual vectors.
+   * @return The mono audio signal, or an empty signal if the header is
+   *    invalid or no frames could be read.
    */
-  static std::vector<std::vector<double>> ExtractMultiChannel(
-      const int num_channels, const std::vector<double>& interleaved_vector);
+  template <typename Reader>
+  static AudioSignal ReadAsMono(Reader* reader,
+                                const absl::optional<std::string>& filepath);
 };
 }  // namespace Visqol
 
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VISQOL_INCLUDE_PREPARED_REFERENCE_H
+#define VISQOL_INCLUDE_PREPARED_REFERENCE_H
+
+#include <string>
+#include <vector>
+
+#include "amatrix.h"
+#include "audio_signal.h"
+#include "spectrogram.h"
+
+namespace Visqol {
+
+/**
+ * The artefacts of a reference signal that do not depend on the degraded
+ * signal it is compared against. Preparing these once allows a single
+ * reference to be scored against many degraded signals without recomputing
+ * them for every pair.
+ *
+ * A prepared reference is only valid for comparisons run with the same
+ * processing mode (speech or audio) that it was prepared with.
+ */
+struct PreparedReference {
+  /**
+   * The mono reference signal.
+   */
+  AudioSignal signal;
+
+  /**
+   * The path the reference signal was loaded from, if any.
+   */
+  std::string filepath;
+
+  /**
+   * The upper envelope of the reference signal, used for global alignment.
+   */
+  AMatrix<double> upper_env;
+
+  /**
+   * The reference spectrogram, converted to dB with the absolute noise floor
+   * applied. The per-frame noise floor depends on the degraded signal, so it
+   * is applied to a copy for each comparison.
+   */
+  Spectrogram spectrogram;
+
+  /**
+   * The start indices of the reference patches in the spectrogram.
+   */
+  std::vector<size_t> patch_indices;
+
+  /**
+   * True if the reference was prepared for speech mode.
+   */
+  bool use_speech_mode = false;
+};
+}  // namespace Visqol
+
+#endif  // VISQOL_INCLUDE_PREPARED_REFERENCE_H
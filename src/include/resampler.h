@@ -0,0 +1,90 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef VISQOL_INCLUDE_RESAMPLER_H
+#define VISQOL_INCLUDE_RESAMPLER_H
+
+#include <cstddef>
+
+#include "amatrix.h"
+#include "audio_signal.h"
+
+namespace Visqol {
+
+/**
+ * This class converts audio signals between sample rates with a polyphase
+ * windowed sinc filter.
+ *
+ * The ratio of the rates is reduced to L/M, and the output is computed as if
+ * the input were upsampled by L, low pass filtered and downsampled by M. Only
+ * the L phases of the filter that are needed are evaluated, each one a short
+ * dot product with the input. When L is large the phases are interpolated
+ * from a table of kMaxNumPhases of them.
+ */
+class Resampler {
+ public:
+  /**
+   * The number of zero crossings of the sinc on each side of its centre. More
+   * zero crossings give a sharper transition band at a higher cost.
+   */
+  static const size_t kNumZeroCrossings;
+
+  /**
+   * The cutoff frequency of the low pass filter, as a fraction of the lower
+   * of the input and output Nyquist frequencies.
+   */
+  static const double kCutoff;
+
+  /**
+   * The shape parameter of the Kaiser window applied to the sinc.
+   */
+  static const double kKaiserBeta;
+
+  /**
+   * The largest number of filter phases that are stored. Rates whose reduced
+   * ratio L/M has a larger L, e.g. 44099 to 48000 Hz, interpolate between
+   * this many phases rather than storing all L of them.
+   */
+  static const size_t kMaxNumPhases;
+
+  /**
+   * Resample a signal to the given sample rate. If the signal already has
+   * that rate it is returned unchanged.
+   *
+   * @param signal The signal to resample.
+   * @param output_rate The sample rate of the returned signal.
+   *
+   * @return The resampled signal.
+   */
+  static AudioSignal Resample(const AudioSignal& signal, size_t output_rate);
+
+  /**
+   * Resample each column of a matrix from one sample rate to another.
+   *
+   * @param samples The samples to resample, with a column per channel.
+   * @param input_rate The sample rate of the input samples.
+   * @param output_rate The sample rate of the returned samples.
+   *
+   * @return The resampled samples, with ceil(rows * output_rate / input_rate)
+   *    rows.
+   */
+  static AMatrix<double> Resample(const AMatrix<double>& samples,
+                                  size_t input_rate, size_t output_rate);
+};
+}  // namespace Visqol
+
+#endif  // VISQOL_INCLUDE_RESAMPLER_H
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VISQOL_INCLUDE_RESULT_CACHE_H
+#define VISQOL_INCLUDE_RESULT_CACHE_H
+
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "file_path.h"
+#include "mapped_file.h"
+#include "src/proto/similarity_result.pb.h"  // Generated by cc_proto_library rule
+
+namespace Visqol {
+
+/**
+ * This class is an on-disk cache of comparison results. Results are keyed by
+ * the audio content of the reference and degraded files, rather than their
+ * paths, and by the configuration they were scored with. A renamed or copied
+ * file is therefore still found in the cache, while a file that is changed in
+ * place is not.
+ *
+ * Each result is stored in its own file under the cache directory. Records
+ * are written to a temporary file and then renamed into place, so any number
+ * of threads and processes on a host may share a cache directory. Temporary
+ * files left behind by interrupted writes are removed when the cache is
+ * opened.
+ *
+ * The configuration key should include everything that affects the result,
+ * including the content of the model file.
+ */
+class ResultCache {
+ public:
+  /**
+   * Open a cache directory, creating it if it does not exist.
+   *
+   * @param cache_dir The directory the results are stored in.
+   * @param configuration_key Identifies the configuration the cached results
+   *    are scored with, e.g. from VisqolManager::ConfigurationKey.
+   *
+   * @return The cache if the directory could be created, else an error status.
+   */
+  static absl::StatusOr<ResultCache> Open(const FilePath& cache_dir,
+                                          const std::string& configuration_key);
+
+  /**
+   * Compute the key of a comparison from the content of its audio files. The
+   * contents are usually mapped with MapAudioFile, so that the same bytes can
+   * be decoded if the comparison is not cached.
+   *
+   * @param ref_contents The contents of the reference audio file.
+   * @param deg_contents The contents of the degraded audio file.
+   *
+   * @return The key.
+   */
+  std::string MakeKey(absl::Span<const char> ref_contents,
+                      absl::Span<const char> deg_contents) const;
+
+  /**
+   * Look up the result of a comparison. This is thread safe.
+   *
+   * @param key The key of the comparison from MakeKey.
+   *
+   * @return The cached result, or no value if the comparison is not cached.
+   */
+  absl::optional<SimilarityResultMsg> Lookup(const std::string& key) const;
+
+  /**
+   * Store the result of a comparison, replacing any result already stored for
+   * it. This is thread safe.
+   *
+   * @param key The key of the comparison from MakeKey.
+   * @param sim_res_msg The result of the comparison.
+   *
+   * @return An 'OK' status if the result was stored, else an error status.
+   */
+  absl::Status Store(const std::string& key,
+                     const SimilarityResultMsg& sim_res_msg) const;
+
+  /**
+   * Map an audio file into memory, so that its content can be digested for
+   * the key and then decoded without reading the file again.
+   *
+   * Only regular files are mapped, since reading a pipe or the standard input
+   * would consume the audio before it is scored.
+   *
+   * @param path The path to the audio file.
+   *
+   * @return The mapped file, else an error status if the file is not a
+   *    regular file or could not be opened.
+   */
+  static absl::StatusOr<std::unique_ptr<MappedFile>> MapAudioFile(
+      const FilePath& path);
+
+  /**
+   * Compute a digest of the audio content of a file. For WAV files only the
+   * format and sample data chunks are included, so the digest does not depend
+   * on metadata chunks. Other files are digested in full.
+   *
+   * @param contents The contents of the audio file.
+   *
+   * @return The digest as a hex string.
+   */
+  static std::string AudioDigest(absl::Span<const char> contents);
+
+  /**
+   * Compute a digest of arbitrary content, e.g. a model file, with the same
+   * hash as the audio digests.
+   *
+   * @param contents The content to digest.
+   *
+   * @return The digest as a hex string.
+   */
+  static std::string ContentDigest(absl::Span<const char> contents);
+
+ private:
+  ResultCache(const FilePath& cache_dir, const std::string& configuration_key);
+
+  /**
+   * The path of the record file for a key.
+   */
+  std::string RecordPath(const std::string& key) const;
+
+  FilePath cache_dir_;
+  std::string configuration_key_;
+};
+}  // namespace Visqol
+
+#endif  // VISQOL_INCLUDE_RESULT_CACHE_H
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VISQOL_INCLUDE_RESULTS_CHECKPOINT_H
+#define VISQOL_INCLUDE_RESULTS_CHECKPOINT_H
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+
+#include "absl/status/statusor.h"
+#include "file_path.h"
+
+namespace Visqol {
+
+/**
+ * This class records which comparisons of a batch have already been written
+ * to a results CSV file, so that an interrupted batch can be resumed without
+ * repeating them.
+ */
+class ResultsCheckpoint {
+ public:
+  /**
+   * Load the comparisons that have been written to a results CSV file. If the
+   * final record of the file was only partly written, it is removed from the
+   * file so that results can be appended after the last complete record. A
+   * missing file is treated as an empty checkpoint.
+   *
+   * @param results_csv The path to the results CSV file.
+   *
+   * @return The checkpoint if the file could be read and repaired, else an
+   *    error status.
+   */
+  static absl::StatusOr<ResultsCheckpoint> Load(const FilePath& results_csv);
+
+  /**
+   * Check if a comparison has already been completed. Each completed record
+   * matches only one pair, so a pair that appears twice in a batch is only
+   * skipped as often as it was completed.
+   *
+   * @param pair The reference and degraded file paths of the comparison.
+   *
+   * @return True if the comparison was completed and should be skipped.
+   */
+  bool ConsumeIfCompleted(const ReferenceDegradedPathPair& pair);
+
+  /**
+   * @return The number of completed comparisons that were loaded.
+   */
+  size_t NumCompleted() const { return num_completed_; }
+
+ private:
+  /**
+   * Build the key used to look up a comparison.
+   */
+  static std::string MakeKey(const std::string& reference,
+                             const std::string& degraded);
+
+  /**
+   * The number of times each comparison was completed, keyed by MakeKey.
+   */
+  std::unordered_map<std::string, size_t> completed_;
+
+  /**
+   * The number of completed comparisons that were loaded.
+   */
+  size_t num_completed_ = 0;
+};
+}  // namespace Visqol
+
+#endif  // VISQOL_INCLUDE_RESULTS_CHECKPOINT_H
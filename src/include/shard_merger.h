@@ -0,0 +1,115 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VISQOL_INCLUDE_SHARD_MERGER_H
+#define VISQOL_INCLUDE_SHARD_MERGER_H
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "file_path.h"
+
+namespace Visqol {
+
+/**
+ * This class combines the outputs of a batch that was split into shards with
+ * the --shard_index and --num_shards options back into a single output in
+ * batch manifest order.
+ */
+class ShardMerger {
+ public:
+  /**
+   * Merge the results CSV files of the shards of a batch.
+   *
+   * @param manifest_path The batch CSV file that the shards were run from.
+   * @param shard_paths The results CSV file of each shard.
+   * @param output_path The path to write the merged results CSV to. Any
+   *    existing file is replaced.
+   *
+   * @return An 'OK' status if every pair in the manifest had a result. Else,
+   *    an error status. The results that were found are written either way.
+   */
+  static absl::Status MergeResultsCSV(const FilePath& manifest_path,
+                                      const std::vector<FilePath>& shard_paths,
+                                      const FilePath& output_path);
+
+  /**
+   * Merge the debug JSON files of the shards of a batch.
+   *
+   * @param manifest_path The batch CSV file that the shards were run from.
+   * @param shard_paths The debug JSON file of each shard.
+   * @param output_path The path to write the merged debug JSON to. Any
+   *    existing file is replaced.
+   *
+   * @return An 'OK' status if every pair in the manifest had a result. Else,
+   *    an error status. The results that were found are written either way.
+   */
+  static absl::Status MergeDebugJSON(const FilePath& manifest_path,
+                                     const std::vector<FilePath>& shard_paths,
+                                     const FilePath& output_path);
+
+  /**
+   * Split a debug JSON file, which is a concatenation of JSON objects, into
+   * the text of each object.
+   *
+   * @param text The contents of the debug JSON file.
+   *
+   * @return The text of each object, else an error status if the text is not
+   *    a sequence of complete objects.
+   */
+  static absl::StatusOr<std::vector<std::string>> SplitJsonObjects(
+      const std::string& text);
+
+ private:
+  /**
+   * The records of each shard output, keyed by their reference and degraded
+   * paths. A pair that appears more than once in the manifest has one record
+   * per appearance.
+   */
+  using RecordsByPair =
+      std::unordered_map<std::string, std::deque<std::string>>;
+
+  /**
+   * Build the key used to look up the records of a pair.
+   */
+  static std::string MakeKey(const std::string& reference,
+                             const std::string& degraded);
+
+  /**
+   * Write the records in the order of the pairs in the manifest.
+   *
+   * @param manifest_path The batch CSV file that the shards were run from.
+   * @param header Text written before the first record.
+   * @param separator Text written after each record.
+   * @param records The records to write. Written records are removed.
+   * @param output_path The path to write the records to.
+   *
+   * @return An 'OK' status if every pair in the manifest had a record. Else,
+   *    an error status.
+   */
+  static absl::Status WriteInManifestOrder(const FilePath& manifest_path,
+                                           const std::string& header,
+                                           const std::string& separator,
+                                           RecordsByPair* records,
+                                           const FilePath& output_path);
+};
+}  // namespace Visqol
+
+#endif  // VISQOL_INCLUDE_SHARD_MERGER_H
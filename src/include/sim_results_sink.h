@@ -0,0 +1,195 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VISQOL_INCLUDE_SIM_RESULTS_SINK_H
+#define VISQOL_INCLUDE_SIM_RESULTS_SINK_H
+
+#include <cstddef>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
+#include "file_path.h"
+#include "src/proto/similarity_result.pb.h"  // Generated by cc_proto_library rule
+
+namespace Visqol {
+
+/**
+ * This class writes the results of a batch of comparisons. Unlike
+ * SimilarityResultsWriter, it keeps the output files open for its lifetime and
+ * buffers the writes. The buffers are written once they grow large, by a
+ * background thread once they are older than the flush interval, and when the
+ * sink is destroyed.
+ *
+ * Results are identified by their index in the batch and may be submitted
+ * from multiple threads in any order. They are written in index order. At
+ * most a bounded number of results are held waiting for an earlier result;
+ * submitting a result beyond that bound blocks until the earlier results have
+ * been written.
+ */
+class SimilarityResultsSink {
+ public:
+  /**
+   * The default number of results that may be held waiting for an earlier
+   * result to be submitted.
+   */
+  static const size_t kDefaultMaxPendingResults;
+
+  /**
+   * The number of buffered bytes after which the buffer is written to the
+   * output files.
+   */
+  static const size_t kFlushThresholdBytes;
+
+  /**
+   * The longest time that results are buffered before being written to the
+   * output files.
+   */
+  static const absl::Duration kFlushInterval;
+
+  /**
+   * Constructs a sink and opens its output files. Results are appended if the
+   * files already exist.
+   *
+   * @param verbose If true, write the full results to console.
+   * @param results_output_csv If this path is not empty, the basic comparison
+   *    results will be written here in CSV format.
+   * @param debug_output_path If this path is not empty, the comparison results
+   *    will be written to this file in JSON format.
+   * @param use_speech_mode True if the comparisons were run in speech mode.
+   * @param use_lattice True if the comparisons used a lattice model.
+   * @param max_pending_results The number of results that may be held waiting
+   *    for an earlier result to be submitted.
+   * @param flush_interval The longest time that results are buffered before
+   *    being written to the output files.
+   */
+  SimilarityResultsSink(bool verbose, const FilePath& results_output_csv,
+                        const FilePath& debug_output_path,
+                        bool use_speech_mode, bool use_lattice,
+                        size_t max_pending_results = kDefaultMaxPendingResults,
+                        absl::Duration flush_interval = kFlushInterval);
+
+  /**
+   * Writes any remaining results and closes the output files.
+   */
+  ~SimilarityResultsSink();
+
+  SimilarityResultsSink(const SimilarityResultsSink&) = delete;
+  SimilarityResultsSink& operator=(const SimilarityResultsSink&) = delete;
+
+  /**
+   * Submit the result of the comparison at the given index in the batch. This
+   * is thread safe.
+   *
+   * @param index The index of the comparison in the batch.
+   * @param sim_res_msg The comparison result to write.
+   */
+  void Submit(size_t index, const SimilarityResultMsg& sim_res_msg);
+
+  /**
+   * Mark the comparison at the given index as finished without a result, e.g.
+   * because it failed. Nothing is written for it. This is thread safe.
+   *
+   * @param index The index of the comparison in the batch.
+   */
+  void Skip(size_t index);
+
+  /**
+   * Write all buffered output to the output files. Results still waiting for
+   * an earlier result are not written.
+   */
+  void Flush();
+
+ private:
+  /**
+   * Hold a result, or its absence, until all earlier results are written.
+   * Blocks while the index is too far ahead of the next index to write.
+   */
+  void Enqueue(size_t index, absl::optional<SimilarityResultMsg> sim_res_msg);
+
+  /**
+   * The body of the flush thread. Writes the buffers once they are older than
+   * the flush interval, even if no further results are submitted.
+   */
+  void FlushLoop();
+
+  /**
+   * Write all pending results that are next in index order.
+   */
+  void WritePendingInOrder() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /**
+   * Format a single result into the buffers.
+   */
+  void BufferResult(const SimilarityResultMsg& sim_res_msg)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /**
+   * Write the buffers to the output files.
+   */
+  void FlushLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const bool verbose_;
+  const bool use_speech_mode_;
+  const bool use_lattice_;
+  const size_t max_pending_results_;
+  const absl::Duration flush_interval_;
+
+  absl::Mutex mutex_;
+
+  /**
+   * The index of the next result to write.
+   */
+  size_t next_index_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  /**
+   * Results that were submitted before an earlier result. An empty value
+   * marks a skipped comparison.
+   */
+  std::map<size_t, absl::optional<SimilarityResultMsg>> pending_
+      ABSL_GUARDED_BY(mutex_);
+
+  std::ofstream csv_file_ ABSL_GUARDED_BY(mutex_);
+  std::ofstream debug_file_ ABSL_GUARDED_BY(mutex_);
+
+  /**
+   * True if the CSV header still has to be written.
+   */
+  bool write_csv_header_ ABSL_GUARDED_BY(mutex_);
+
+  std::string csv_buffer_ ABSL_GUARDED_BY(mutex_);
+  std::string debug_buffer_ ABSL_GUARDED_BY(mutex_);
+
+  /**
+   * The time the buffers were last written to the output files.
+   */
+  absl::Time last_flush_ ABSL_GUARDED_BY(mutex_);
+
+  /**
+   * True once the flush thread has been asked to stop.
+   */
+  bool stopped_ ABSL_GUARDED_BY(mutex_) = false;
+
+  std::thread flush_thread_;
+};
+}  // namespace Visqol
+
+#endif  // VISQOL_INCLUDE_SIM_RESULTS_SINK_H
@@ -58,7 +58,6 @@ class SimilarityResultsWriter {
     }
   }
 
- private:
   /**
    * Write the results of the comparison, along with some basic debug info, to
    * console.
@@ -91,6 +90,99 @@ class SimilarityResultsWriter {
     }
   }
 
+  /**
+   * Format the header row of the results CSV file.
+   *
+   * @param sim_res_msg A comparison result, used for the number of frequency
+   *    bands.
+   * @param output_moslqo If true, write a column for the mean opinion score.
+   * @param output_fvnsim If true, write a column with the average nsim value
+   *    per frequency.
+   *
+   * @return The header row, including the trailing newline.
+   */
+  static std::string FormatCSVHeader(const SimilarityResultMsg& sim_res_msg,
+                                     const bool output_moslqo = true,
+                                     const bool output_fvnsim = true,
+                                     const bool output_stddev = true,
+                                     const bool output_fvdegenergy = true) {
+    std::stringstream ss;
+    ss << "reference,degraded";
+    if (output_moslqo) {
+      ss << ",moslqo";
+    }
+
+    if (output_fvnsim) {
+      for (size_t i = 0; i < sim_res_msg.fvnsim_size(); i++) {
+        ss << ",fvnsim" << i;
+      }
+    }
+    if (output_fvnsim) {
+      for (size_t i = 0; i < sim_res_msg.fvnsim10_size(); i++) {
+        ss << ",fvnsim10_" << i;
+      }
+    }
+    if (output_stddev) {
+      for (size_t i = 0; i < sim_res_msg.fstdnsim_size(); i++) {
+        ss << ",fstdnsim" << i;
+      }
+    }
+    if (output_fvdegenergy) {
+      for (size_t i = 0; i < sim_res_msg.fvdegenergy_size(); i++) {
+        ss << ",fvdegenergy" << i;
+      }
+    }
+    ss << std::endl;
+    return ss.str();
+  }
+
+  /**
+   * Format the reference and degraded filepath, along with the resulting
+   * MOS-LQO from their comparison, as a row of the results CSV file.
+   *
+   * @param sim_res_msg The comparison result to format.
+   * @param output_moslqo If true, write a column for the mean opinion score.
+   * @param output_fvnsim If true, write a column with the average nsim value
+   *    per frequency.
+   *
+   * @return The CSV row, including the trailing newline.
+   */
+  static std::string FormatCSVRow(const SimilarityResultMsg& sim_res_msg,
+                                  const bool output_moslqo = true,
+                                  const bool output_fvnsim = true,
+                                  const bool output_stddev = true,
+                                  const bool output_fvdegenergy = true) {
+    std::stringstream ss;
+    ss << sim_res_msg.reference_filepath() << ","
+       << sim_res_msg.degraded_filepath();
+
+    if (output_moslqo) {
+      ss << "," << std::setprecision(9) << sim_res_msg.moslqo();
+    }
+
+    if (output_fvnsim) {
+      for (size_t i = 0; i < sim_res_msg.fvnsim_size(); i++) {
+        ss << "," << std::setprecision(9) << sim_res_msg.fvnsim(i);
+      }
+      for (size_t i = 0; i < sim_res_msg.fvnsim10_size(); i++) {
+        ss << "," << std::setprecision(9) << sim_res_msg.fvnsim10(i);
+      }
+    }
+    if (output_stddev) {
+      for (size_t i = 0; i < sim_res_msg.fstdnsim_size(); i++) {
+        ss << "," << std::setprecision(9) << sim_res_msg.fstdnsim(i);
+      }
+    }
+    if (output_fvdegenergy) {
+      for (size_t i = 0; i < sim_res_msg.fvdegenergy_size(); i++) {
+        ss << "," << std::setprecision(9) << sim_res_msg.fvdegenergy(i);
+      }
+    }
+    ss << std::endl;
+    return ss.str();
+  }
+
+ private:
   /**
    * Format the FVNSIM and center frequency band debug info.
    *
@@ -215,61 +307,11 @@ class SimilarityResultsWriter {
     out_file.open(csv_res_path.Path(), std::ios_base::app);
 
     if (write_header) {
-      out_file << "reference,degraded";
-      if (output_moslqo) {
-        out_file << ",moslqo";
-      }
-
-      if (output_fvnsim) {
-        for (size_t i = 0; i < sim_res_msg.fvnsim_size(); i++) {
-          out_file << ",fvnsim" << i;
-        }
-      }
-      if (output_fvnsim) {
-        for (size_t i = 0; i < sim_res_msg.fvnsim10_size(); i++) {
-          out_file << ",fvnsim10_" << i;
-        }
-      }
-      if (output_stddev) {
-        for (size_t i = 0; i < sim_res_msg.fstdnsim_size(); i++) {
-          out_file << ",fstdnsim" << i;
-        }
-      }
-      if (output_fvdegenergy) {
-        for (size_t i = 0; i < sim_res_msg.fvdegenergy_size(); i++) {
-          out_file << ",fvdegenergy" << i;
-        }
-      }
-      out_file << std::endl;
+      out_file << FormatCSVHeader(sim_res_msg, output_moslqo, output_fvnsim,
+                                  output_stddev, output_fvdegenergy);
     }
-
-    out_file << sim_res_msg.reference_filepath() << ","
-             << sim_res_msg.degraded_filepath();
-
-    if (output_moslqo) {
-      out_file << "," << std::setprecision(9) << sim_res_msg.moslqo();
-    }
-
-    if (output_fvnsim) {
-      for (size_t i = 0; i < sim_res_msg.fvnsim_size(); i++) {
-        out_file << "," << std::setprecision(9) << sim_res_msg.fvnsim(i);
-      }
-      for (size_t i = 0; i < sim_res_msg.fvnsim10_size(); i++) {
-        out_file << "," << std::setprecision(9) << sim_res_msg.fvnsim10(i);
-      }
-    }
-    if (output_stddev) {
-      for (size_t i = 0; i < sim_res_msg.fstdnsim_size(); i++) {
-        out_file << "," << std::setprecision(9) << sim_res_msg.fstdnsim(i);
-      }
-    }
-    if (output_fvdegenergy) {
-      for (size_t i = 0; i < sim_res_msg.fvdegenergy_size(); i++) {
-        out_file << "," << std::setprecision(9) << sim_res_msg.fvdegenergy(i);
-      }
-    }
-
-    out_file << std::endl;
+    out_file << FormatCSVRow(sim_res_msg, output_moslqo, output_fvnsim,
+                             output_stddev, output_fvdegenergy);
     out_file.close();
   }
 };
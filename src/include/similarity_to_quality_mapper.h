@@ -36,6 +36,8 @@ class SimilarityToQualityMapper {
 
   /**
    * Map a vector of quality measures across frequency bands to a MOSLQO.
+   * Implementations must be safe to call from multiple threads at once, so
+   * that a single loaded model can be shared between comparisons.
    *
    * @param fvnsim_vector A vector of neurogram similarity (NSIM) score
    *     means indexed by frequency band.  This is called 'FVNSIM' in the
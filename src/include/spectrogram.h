@@ -25,6 +25,13 @@ namespace Visqol {
 
 /**
  * This class represents a spectrogram representation of a signal.
+ *
+ * The data is a matrix with one row per frequency band and one column per
+ * frame. The matrix is stored column-major, so the bands of a frame are
+ * contiguous in memory and each frame directly follows the previous one. Any
+ * run of consecutive frames, such as a patch, is therefore a single contiguous
+ * block of NumRows() * num_frames values, and per-frame and per-patch
+ * processing should walk the data in that order rather than by band.
  */
 class Spectrogram {
  public:
@@ -19,7 +19,7 @@
 
 #include "absl/status/statusor.h"
 #include "analysis_window.h"
-#include "audio_signal.h"
+#include "audio_signal_view.h"
 #include "spectrogram.h"
 
 namespace Visqol {
@@ -44,12 +44,14 @@ class SpectrogramBuilder {
    * specified by the analysis window.
    *
    * @param signal The signal to produce a spectrogram representation of.
+   *    Frames are read from the view as they are needed, so the signal is
+   *    never copied as a whole.
    * @param window The analysis window that specifies the length and overlap of
    *    each Hamming window.
    *
    * @return The spectrogram representation of the input signal.
    */
-  virtual absl::StatusOr<Spectrogram> Build(const AudioSignal& signal,
+  virtual absl::StatusOr<Spectrogram> Build(const AudioSignalView& signal,
                                             const AnalysisWindow& window) = 0;
 };
 }  // namespace Visqol
@@ -19,6 +19,7 @@
 #include <memory>
 
 #include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
 #include "similarity_to_quality_mapper.h"
 #include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
 #include "tensorflow/lite/interpreter.h"
@@ -50,6 +51,12 @@ class TFLiteQualityMapper : public SimilarityToQualityMapper {
   std::unique_ptr<tflite::Interpreter> interpreter_;
   std::unique_ptr<TfLiteDelegate, std::function<void(TfLiteDelegate*)>>
       delegate_;
+
+  /**
+   * The interpreter's tensors are shared state, so predictions from
+   * different threads are run one at a time.
+   */
+  mutable absl::Mutex predict_mutex_;
 };
 
 }  // namespace Visqol
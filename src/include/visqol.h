@@ -23,9 +23,11 @@
 #include "absl/types/span.h"
 #include "analysis_window.h"
 #include "audio_signal.h"
+#include "audio_signal_view.h"
 #include "comparison_patches_selector.h"
 #include "file_path.h"
 #include "image_patch_creator.h"
+#include "prepared_reference.h"
 #include "similarity_result.h"
 #include "similarity_to_quality_mapper.h"
 #include "spectrogram.h"
@@ -63,13 +65,66 @@ class Visqol {
    *    associated debug info. Else, return an error status.
    */
   absl::StatusOr<SimilarityResult> CalculateSimilarity(
-      const AudioSignal& ref_signal, AudioSignal& deg_signal,
+      const AudioSignal& ref_signal, const AudioSignalView& deg_signal,
       SpectrogramBuilder* spect_builder, const AnalysisWindow& window,
       const ImagePatchCreator* patch_creator,
       const ComparisonPatchesSelector* comparison_patches_selector,
       const SimilarityToQualityMapper* sim_to_qual_mapper,
       const int search_window, const bool disable_realignment) const;
 
+  /**
+   * Perform a comparison of a degraded signal against a reference that has
+   * already been prepared with PrepareReference. The result is the same as
+   * calling CalculateSimilarity with the reference signal, but the reference
+   * spectrogram and patch indices are not recomputed.
+   *
+   * @param reference The prepared reference signal for comparison.
+   * @param deg_signal The degraded signal for comparison.
+   * @param spect_builder The spectrogram builder used for building the
+   *    degraded spectrogram. It must be configured the same as the builder
+   *    used to prepare the reference.
+   * @param window The Hamming window used for analysis of the signals.
+   * @param patch_creator Used for creating patches for comparison from the
+   *    signal's spectrograms.
+   * @param comparison_patches_selector Used for selecting and comparing patches
+   *    from the degraded signal with those from the reference signal.
+   * @param sim_to_qual_mapper Used to convert a similarity score to a quality
+   *    score.
+   * @param search_window This parameter is used to determine how far the
+   *    algorithm will search in order to find the most optimal match.
+   * @param disable_realignment Disables refined patch realignment
+   *
+   * @return If the comparison was successful, return the similarity result and
+   *    associated debug info. Else, return an error status.
+   */
+  absl::StatusOr<SimilarityResult> CalculateSimilarity(
+      const PreparedReference& reference, const AudioSignalView& deg_signal,
+      SpectrogramBuilder* spect_builder, const AnalysisWindow& window,
+      const ImagePatchCreator* patch_creator,
+      const ComparisonPatchesSelector* comparison_patches_selector,
+      const SimilarityToQualityMapper* sim_to_qual_mapper,
+      const int search_window, const bool disable_realignment) const;
+
+  /**
+   * Build the parts of a comparison that depend only on the reference signal:
+   * its spectrogram (in dB, with the absolute noise floor applied) and the
+   * indices of its patches. The signal, spectrogram and patch indices of the
+   * returned reference are set; the caller is responsible for the remaining
+   * fields.
+   *
+   * @param ref_signal The reference signal to prepare.
+   * @param spect_builder The spectrogram builder used for building the
+   *    reference spectrogram.
+   * @param window The Hamming window used for analysis of the signal.
+   * @param patch_creator Used for creating the reference patch indices.
+   *
+   * @return If successful, the prepared reference. Else, an error status.
+   */
+  absl::StatusOr<PreparedReference> PrepareReference(
+      const AudioSignal& ref_signal, SpectrogramBuilder* spect_builder,
+      const AnalysisWindow& window,
+      const ImagePatchCreator* patch_creator) const;
+
   /**
    * Produces a set of FVNSIM scores, which represent the similarity between
    * the two signals for each frequency band. This is done by calculating the
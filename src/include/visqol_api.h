@@ -17,6 +17,7 @@
 #ifndef VISQOL_INCLUDE_VISQOL_API_H
 #define VISQOL_INCLUDE_VISQOL_API_H
 
+#include <cstdint>
 #include <string>
 
 #include "absl/status/status.h"
@@ -65,6 +66,22 @@ class VisqolApi {
   absl::StatusOr<SimilarityResultMsg> Measure(
       const absl::Span<double>& reference, const absl::Span<double>& degraded);
 
+  /**
+   * Perform a ViSQOL comparison on interleaved 16-bit input signals. Signals
+   * with more than 1 channel are downmixed to mono by averaging the channels,
+   * as they are when loaded from a file.
+   *
+   * @param reference The interleaved reference input signal.
+   * @param degraded The interleaved degraded input signal.
+   * @param num_channels The number of channels in both signals.
+   *
+   * @return If the comparison completes successfully, the similarity results
+   *    will be returned. If the comparison fails, an error is returned.
+   */
+  absl::StatusOr<SimilarityResultMsg> MeasureInterleaved(
+      absl::Span<const int16_t> reference, absl::Span<const int16_t> degraded,
+      size_t num_channels);
+
  private:
   /**
    * The instance of ViSQOL that will be used for comparing the signals.
@@ -18,18 +18,24 @@
 #define VISQOL_INCLUDE_VISQOLCOMMANDLINE_H
 
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "audio_archive.h"
 #include "comparison_patches_selector.h"
 #include "file_path.h"
 #include "gammatone_spectrogram_builder.h"
 #include "image_patch_creator.h"
+#include "prepared_reference.h"
 #include "similarity_result.h"
 #include "src/proto/similarity_result.pb.h"  // Generated by cc_proto_library rule
 #include "svr_similarity_to_quality_mapper.h"
+#include "wav_reader.h"
 
 namespace Visqol {
 
@@ -94,6 +100,15 @@ class VisqolManager {
    *    similarity to quality.
    * @param disable_global_alignment Disables global alignment
    * @param disable_realignment Disables refined patch realignment
+   * @param bounded_realignment Restricts patch realignment to small lags,
+   *    which is faster but may deviate from the conformance scores.
+   * @param resample_input If true, input signals are resampled to 48kHz in
+   *    audio mode or 16kHz in speech mode before they are compared.
+   * @param multirate_filterbank If true, the low frequency gammatone bands are
+   *    filtered at a reduced sample rate, which is faster but may deviate
+   *    slightly from the conformance scores.
+   * @param raw_pcm_format If set, input files are read as raw interleaved
+   *    samples in this format rather than as WAV files.
    *
    * @return An 'OK' status if initialised successfully, else an error status.
    */
@@ -101,7 +116,12 @@ class VisqolManager {
                     bool use_speech_mode, bool use_unscaled_speech,
                     int search_window, bool use_lattice_model = true,
                     bool disable_global_alignment = false,
-                    bool disable_realignment = false);
+                    bool disable_realignment = false,
+                    bool bounded_realignment = false,
+                    bool resample_input = false,
+                    bool multirate_filterbank = false,
+                    absl::optional<WavReader::PcmFormat> raw_pcm_format =
+                        absl::nullopt);
 
   /**
    * Initializes an instance for use with the given similarity to quality
@@ -120,6 +140,15 @@ class VisqolManager {
    *    similarity to quality.
    * @param disable_global_alignment Disables global alignment
    * @param disable_realignment Disables refined patch realignment
+   * @param bounded_realignment Restricts patch realignment to small lags,
+   *    which is faster but may deviate from the conformance scores.
+   * @param resample_input If true, input signals are resampled to 48kHz in
+   *    audio mode or 16kHz in speech mode before they are compared.
+   * @param multirate_filterbank If true, the low frequency gammatone bands are
+   *    filtered at a reduced sample rate, which is faster but may deviate
+   *    slightly from the conformance scores.
+   * @param raw_pcm_format If set, input files are read as raw interleaved
+   *    samples in this format rather than as WAV files.
    *
    * @return An 'OK' status if initialised successfully, else an error status.
    */
@@ -127,7 +156,34 @@ class VisqolManager {
                     bool use_speech_mode, bool use_unscaled_speech,
                     int search_window, bool use_lattice_model = true,
                     bool disable_global_alignment = false,
-                    bool disable_realignment = false);
+                    bool disable_realignment = false,
+                    bool bounded_realignment = false,
+                    bool resample_input = false,
+                    bool multirate_filterbank = false,
+                    absl::optional<WavReader::PcmFormat> raw_pcm_format =
+                        absl::nullopt);
+
+  /**
+   * Create a new manager with the same configuration as this one. The new
+   * manager has its own comparison state, so it can run comparisons on a
+   * different thread, but shares the loaded similarity to quality model
+   * rather than loading it again.
+   *
+   * @return A StatusOr object that will contain the new manager if this
+   *    manager was initialized, else it will contain the error Status.
+   */
+  absl::StatusOr<std::unique_ptr<VisqolManager>> Clone() const;
+
+  /**
+   * Describe the configuration this manager was initialized with, including
+   * the ViSQOL conformance version. Managers that produce the same results
+   * for the same input have the same configuration key. The model file is
+   * identified by a digest of its content, which is read on each call.
+   *
+   * @return A StatusOr object that will contain the configuration key if this
+   *    manager was initialized, else it will contain the error Status.
+   */
+  absl::StatusOr<std::string> ConfigurationKey() const;
 
   /**
    * Perform a comparison on a single reference/degraded audio file pair.
@@ -153,6 +209,107 @@ class VisqolManager {
   absl::StatusOr<SimilarityResultMsg> Run(const AudioSignal& ref_signal,
                                           AudioSignal& deg_signal);
 
+  /**
+   * Prepare a reference audio file for comparison against many degraded
+   * signals. The returned reference is immutable and may be shared between
+   * threads, but is only valid for managers initialised with the same
+   * processing mode as this one.
+   *
+   * @param ref_signal_path The path to the reference audio file.
+   *
+   * @return A StatusOr object that will contain the prepared reference if it
+   *    was prepared successfully, else it will contain the error Status.
+   */
+  absl::StatusOr<std::shared_ptr<const PreparedReference>> PrepareReference(
+      const FilePath& ref_signal_path);
+
+  /**
+   * Prepare a reference audio signal for comparison against many degraded
+   * signals. The returned reference is immutable and may be shared between
+   * threads, but is only valid for managers initialised with the same
+   * processing mode as this one.
+   *
+   * @param ref_signal The reference audio signal.
+   *
+   * @return A StatusOr object that will contain the prepared reference if it
+   *    was prepared successfully, else it will contain the error Status.
+   */
+  absl::StatusOr<std::shared_ptr<const PreparedReference>> PrepareReference(
+      const AudioSignal& ref_signal);
+
+  /**
+   * Perform a comparison of a degraded audio file against a prepared
+   * reference.
+   *
+   * @param reference The reference prepared with PrepareReference.
+   * @param deg_signal_path The path to the degraded audio file.
+   *
+   * @return A StatusOr object that will contain a SimilarityResultMsg if the
+   *    comparison was successful, else it will contain the error Status.
+   */
+  absl::StatusOr<SimilarityResultMsg> Run(const PreparedReference& reference,
+                                          const FilePath& deg_signal_path);
+
+  /**
+   * Perform a comparison of a degraded audio signal against a prepared
+   * reference. The result is the same as running the comparison with the
+   * reference signal the handle was prepared from.
+   *
+   * @param reference The reference prepared with PrepareReference.
+   * @param deg_signal The degraded audio signal.
+   *
+   * @return A StatusOr object that will contain a SimilarityResultMsg if the
+   *    comparison was successful, else it will contain the error Status.
+   */
+  absl::StatusOr<SimilarityResultMsg> Run(const PreparedReference& reference,
+                                          AudioSignal& deg_signal);
+
+  /**
+   * Read the input files from a packed archive rather than the file system.
+   * The paths given to LoadSignal, and to the Run and PrepareReference
+   * overloads that take paths, are then the names of archive members.
+   * Managers created by Clone share the archive.
+   *
+   * @param archive The archive to read, or null to read the file system.
+   */
+  void SetInputArchive(std::shared_ptr<const AudioArchive> archive);
+
+  /**
+   * Load an input file as mono, in the format that this manager was
+   * initialized to read: raw PCM if a raw PCM format was given, else WAV or
+   * FLAC. The path "-" reads the standard input. If an input archive is set,
+   * the path is the name of a member of the archive, which is decoded in
+   * place.
+   *
+   * @param path The path of the input file.
+   *
+   * @return The mono signal, or an empty signal if it could not be loaded.
+   */
+  AudioSignal LoadSignal(const FilePath& path) const;
+
+  /**
+   * Load the contents of an input file that is already in memory, e.g. a
+   * mapped file, as mono, in the format that this manager was initialized to
+   * read.
+   *
+   * @param contents The contents of the input file.
+   * @param path The path of the input file, for logging.
+   *
+   * @return The mono signal, or an empty signal if it could not be loaded.
+   */
+  AudioSignal LoadSignal(absl::Span<const char> contents,
+                         const FilePath& path) const;
+
+  /**
+   * If this manager was initialized to resample its input, resample a signal
+   * to the sample rate of the processing mode. Otherwise the signal is left
+   * unchanged. Every comparison does this to its input, so calling it ahead
+   * of time, e.g. when the signal is loaded, only moves the work.
+   *
+   * @param signal The signal to resample.
+   */
+  void ResampleInput(AudioSignal* signal) const;
+
  private:
   /**
    * True if the input signals should be processed as speech audio.
@@ -171,6 +328,11 @@ class VisqolManager {
    */
   bool use_unscaled_speech_mos_mapping_ = false;
 
+  /**
+   * The path of the similarity to quality mapping model.
+   */
+  FilePath model_path_;
+
   /**
    * True if the object was successfully initialized, else false.
    */
@@ -192,6 +354,33 @@ class VisqolManager {
    */
   bool disable_realignment_ = false;
 
+  /**
+   * True if per-patch realignment only searches a bounded range of lags.
+   */
+  bool bounded_realignment_ = false;
+
+  /**
+   * True if input signals are resampled to the sample rate of the processing
+   * mode.
+   */
+  bool resample_input_ = false;
+
+  /**
+   * True if the spectrograms are built with a multirate gammatone filter bank.
+   */
+  bool multirate_filterbank_ = false;
+
+  /**
+   * The format of raw PCM input files, if the input files are not WAV files.
+   */
+  absl::optional<WavReader::PcmFormat> raw_pcm_format_;
+
+  /**
+   * The archive the input files are read from, if they are not read from the
+   * file system. This may be shared with managers created by Clone.
+   */
+  std::shared_ptr<const AudioArchive> input_archive_;
+
   /**
    * Used for creating the patches from both the reference and degraded signals
    * for comparison.
@@ -212,9 +401,10 @@ class VisqolManager {
 
   /**
    * Used for generating a quality score for the degraded signal based on the
-   * outcome of the spectrogram comparisons.
+   * outcome of the spectrogram comparisons. This may be shared with managers
+   * created by Clone.
    */
-  std::unique_ptr<SimilarityToQualityMapper> sim_to_qual_;
+  std::shared_ptr<SimilarityToQualityMapper> sim_to_qual_;
 
   /**
    * Initialises the patch creator.
@@ -244,7 +434,7 @@ class VisqolManager {
    * @return An error status if the object was not initialized correctly. Else,
    * an 'ok' status is returned.
    */
-  absl::Status ErrorIfNotInitialized();
+  absl::Status ErrorIfNotInitialized() const;
 
   /**
    * For a given ViSQOL similarity result, populate a similarity result
@@ -271,6 +461,41 @@ class VisqolManager {
    */
   absl::Status ValidateInputAudio(const AudioSignal& ref_signal,
                                   const AudioSignal& deg_signal);
+
+  /**
+   * The sample rate that input signals are resampled to: 48kHz in audio mode
+   * and 16kHz in speech mode.
+   */
+  size_t CanonicalSampleRate() const;
+
+  /**
+   * True if a signal has to be resampled before it is compared.
+   */
+  bool NeedsResampling(const AudioSignal& signal) const;
+
+  /**
+   * Build the prepared reference for a reference signal that has already
+   * been validated.
+   *
+   * @param ref_signal The reference audio signal.
+   *
+   * @return The prepared reference, else an error status.
+   */
+  absl::StatusOr<PreparedReference> BuildPreparedReference(
+      const AudioSignal& ref_signal);
+
+  /**
+   * Perform a comparison of a degraded signal against a prepared reference.
+   * The signals must already have been validated.
+   *
+   * @param reference The prepared reference.
+   * @param deg_signal The degraded audio signal.
+   *
+   * @return A StatusOr object that will contain a SimilarityResultMsg if the
+   *    comparison was successful, else it will contain the error Status.
+   */
+  absl::StatusOr<SimilarityResultMsg> RunPrepared(
+      const PreparedReference& reference, const AudioSignal& deg_signal);
 };
 }  // namespace Visqol
 
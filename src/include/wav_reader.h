@@ -19,19 +19,61 @@
 
 #include <cstdint>
 #include <istream>
+#include <vector>
 
+#include "absl/strings/string_view.h"
 #include "misc_math.h"
 
 namespace Visqol {
 
 /**
- *  Basic RIFF WAVE decoder that supports multichannel 16-bit PCM.
+ *  Basic RIFF WAVE decoder that supports multichannel 16, 24 and 32-bit
+ *  integer PCM and 32 and 64-bit IEEE float, in both the plain and the
+ *  WAVE_FORMAT_EXTENSIBLE formats.
+ *
+ *  The stream is only read forwards, so it does not need to be seekable. The
+ *  data chunk may have the size 0xFFFFFFFF, as written by encoders that
+ *  stream to a pipe, in which case samples are read until the end of the
+ *  stream. Raw interleaved samples without a header can also be read, if
+ *  their format is given.
  *
  *  This class was adapted from the ResonanceAudio project:
  *  https://github.com/resonance-audio/resonance-audio
  */
 class WavReader {
  public:
+  /**
+   * The encodings of the samples that can be decoded.
+   */
+  enum class SampleFormat { kInt16, kInt24, kInt32, kFloat32, kFloat64 };
+
+  /**
+   * The format of raw interleaved little endian samples, which has to be
+   * given because there is no header to read it from.
+   */
+  struct PcmFormat {
+    /**
+     * Sample rate in Hertz.
+     */
+    int sample_rate_hz = 0;
+
+    /**
+     * Number of interleaved channels.
+     */
+    size_t num_channels = 0;
+
+    /**
+     * Encoding of the samples.
+     */
+    SampleFormat sample_format = SampleFormat::kInt16;
+  };
+
+  /**
+   * The largest number of interleaved samples that ReadMonoFrames reads from
+   * the stream at once.
+   */
+  static const size_t kMaxBlockSamples;
+
   /**
    * Constructor decodes WAV header.
    *
@@ -39,6 +81,27 @@ class WavReader {
    */
   explicit WavReader(std::istream* binary_stream);
 
+  /**
+   * Constructor for a stream of raw interleaved samples with no header. The
+   * length of the stream is not known, so samples are read until it ends.
+   *
+   * @param binary_stream Binary input stream to read from.
+   * @param format The format of the samples in the stream.
+   */
+  WavReader(std::istream* binary_stream, const PcmFormat& format);
+
+  /**
+   * Get the sample format with the given name. The names are those used by
+   * common command line audio tools: "s16le", "s24le" and "s32le" for
+   * integer samples and "f32le" and "f64le" for float samples.
+   *
+   * @param name The name of the sample format.
+   * @param sample_format Set to the sample format, if the name is known.
+   * @return True if the name is known.
+   */
+  static bool ParseSampleFormat(absl::string_view name,
+                                SampleFormat* sample_format);
+
   /**
    * True if WAV header was successfully parsed.
    */
@@ -46,10 +109,16 @@ class WavReader {
 
   /**
    * Returns the total number of samples defined in the WAV header. Note that
-   * the actual number of samples in the file can differ.
+   * the actual number of samples in the file can differ. Returns 0 if the
+   * length is not known.
    */
   size_t GetNumTotalSamples() const;
 
+  /**
+   * True if the WAV header gives the number of samples in the stream.
+   */
+  bool IsLengthKnown() const;
+
   /**
    * Returns number of channels.
    */
@@ -60,13 +129,25 @@ class WavReader {
    */
   int GetSampleRateHz() const;
 
+  /**
+   * Returns the encoding of the samples.
+   */
+  SampleFormat GetSampleFormat() const;
+
   /**
    * Returns the duration of the wav file in seconds.
    */
   double GetDuration() const;
 
   /**
-   * Reads samples from WAV file into target buffer.
+   * Returns the offset in bytes from the start of the stream to the first
+   * sample. Only valid if the header was parsed successfully.
+   */
+  uint64_t GetPcmOffsetBytes() const;
+
+  /**
+   * Reads samples from WAV file into target buffer. Only 16-bit samples can be
+   * read this way; for other sample formats nothing is read.
    *
    * @param num_samples Number of samples to read.
    * @param target_buffer Target buffer to write to.
@@ -74,11 +155,28 @@ class WavReader {
    */
   size_t ReadSamples(size_t num_samples, int16_t* target_buffer);
 
+  /**
+   * Reads frames from the WAV file, downmixes them to mono and normalizes them
+   * to the range [-1, 1). Integer samples are scaled by their full scale and
+   * float samples are used as they are. The samples of each frame are
+   * averaged. A partial
+   * frame at the end of the stream has its missing samples set to zero.
+   *
+   * The stream is read in blocks of at most kMaxBlockSamples samples, so any
+   * number of frames can be read without buffering the interleaved samples.
+   *
+   * @param num_frames Number of frames to read.
+   * @param target_buffer Target buffer for num_frames mono samples.
+   * @return Number of frames written to the target buffer.
+   */
+  size_t ReadMonoFrames(size_t num_frames, double* target_buffer);
+
  private:
   /**
    * Calculate the total number of bytes in the data stream.
    *
-   * @return The total number of bytes in the data stream.
+   * @return The total number of bytes in the data stream, or -1 if the stream
+   *    is not seekable.
    */
   int64_t GetCountOfBytesInStream();
 
@@ -89,6 +187,34 @@ class WavReader {
    */
   bool ParseHeader();
 
+  /**
+   * Reads whole samples, in the encoding of the WAV file, into target buffer.
+   *
+   * @param num_samples Number of samples to read.
+   * @param target_buffer Target buffer for num_samples * bytes_per_sample_
+   *    bytes.
+   * @return Number of samples read.
+   */
+  size_t ReadEncodedSamples(size_t num_samples, char* target_buffer);
+
+  /**
+   * Converts encoded samples to normalized doubles.
+   *
+   * @param encoded_samples The samples in the encoding of the WAV file.
+   * @param num_samples Number of samples to convert.
+   * @param target_buffer Target buffer for num_samples doubles.
+   */
+  void DecodeSamples(const char* encoded_samples, size_t num_samples,
+                     double* target_buffer) const;
+
+  /**
+   * Helper method to skip over data in the input stream.
+   *
+   * @param size Number of bytes to skip.
+   * @return Number of bytes skipped.
+   */
+  size_t SkipBinaryDataInStream(size_t size);
+
   /**
    * Helper method to read binary data from input stream.
    *
@@ -133,15 +259,40 @@ class WavReader {
    */
   size_t bytes_per_sample_;
 
+  /**
+   * Encoding of the samples.
+   */
+  SampleFormat sample_format_;
+
   /**
    * Offset into data stream where PCM data begins.
    */
   uint64_t pcm_offset_bytes_;
 
   /**
-   * Total number of bytes in data stream.
+   * Total number of bytes in data stream, or -1 if it is not known.
    */
   int64_t bytes_in_stream_;
+
+  /**
+   * Number of bytes read from or skipped in the data stream.
+   */
+  uint64_t stream_position_;
+
+  /**
+   * True if the data chunk size is given in the WAV header.
+   */
+  bool length_known_;
+
+  /**
+   * Encoded interleaved samples read by ReadMonoFrames.
+   */
+  std::vector<int16_t> block_buffer_;
+
+  /**
+   * Normalized interleaved samples decoded by ReadMonoFrames.
+   */
+  std::vector<double> decoded_block_;
 };
 
 }  // namespace Visqol
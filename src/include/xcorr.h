@@ -46,6 +46,54 @@ class XCorr {
   static int64_t FindLowestLagIndex(const AMatrix<double>& signal_1,
                                     const AMatrix<double>& signal_2);
 
+  /**
+   * Calculate the cross correlation of two signals for every lag from
+   * -(max_len - 1) to (max_len - 1), where max_len is the length of the longer
+   * signal. The lag convention matches FindLowestLagIndex.
+   *
+   * @param signal_1 The first signal in the pair of signals to be correlated.
+   * @param signal_2 The second signal in the pair of signals to be correlated.
+   *
+   * @return The correlation values, with element 0 holding the most negative
+   *    lag.
+   */
+  static std::vector<double> CalcCrossCorrelation(
+      const AMatrix<double>& signal_1, const AMatrix<double>& signal_2);
+
+  /**
+   * Find the best lag between two signals, considering only the lags in the
+   * inclusive range [min_lag, max_lag]. The lag convention matches
+   * FindLowestLagIndex, and ties resolve to the lowest lag.
+   *
+   * The correlation is computed directly in the time domain, so the cost is
+   * O(signal length x lag range). This is cheaper than the FFT based search
+   * when only a handful of lags need to be considered.
+   *
+   * @param signal_1 The first signal in the pair of signals to be correlated.
+   * @param signal_2 The second signal in the pair of signals to be correlated.
+   * @param min_lag The lowest lag to consider.
+   * @param max_lag The highest lag to consider.
+   *
+   * @return The best lag value in the given range.
+   */
+  static int64_t FindLowestLagIndexInRange(const AMatrix<double>& signal_1,
+                                           const AMatrix<double>& signal_2,
+                                           int64_t min_lag, int64_t max_lag);
+
+  /**
+   * Calculate the cross correlation of two signals at a single lag, directly
+   * in the time domain. The lag convention matches FindLowestLagIndex.
+   *
+   * @param signal_1 The first signal in the pair of signals to be correlated.
+   * @param signal_2 The second signal in the pair of signals to be correlated.
+   * @param lag The lag at which to correlate the signals.
+   *
+   * @return The correlation value at the given lag.
+   */
+  static double CalcCorrelationAtLag(const AMatrix<double>& signal_1,
+                                     const AMatrix<double>& signal_2,
+                                     int64_t lag);
+
  private:
   /**
    * Helper function used to calculate the inverse fft of the result of the
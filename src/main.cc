@@ -12,13 +12,162 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
 #include "absl/base/internal/raw_logging.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "audio_archive.h"
+#include "audio_prefetcher.h"
 #include "commandline_parser.h"
-#include "sim_results_writer.h"
+#include "file_path.h"
+#include "manifest_reader.h"
+#include "result_cache.h"
+#include "results_checkpoint.h"
+#include "sim_results_sink.h"
 #include "visqol_manager.h"
 
+namespace {
+
+// Load the audio of a comparison, unless its result is in the cache.
+void LoadComparison(const Visqol::VisqolManager& manager,
+                    const Visqol::ResultCache* cache,
+                    Visqol::LoadedComparison* comparison) {
+  const Visqol::ReferenceDegradedPathPair& paths = comparison->paths;
+  bool loaded = false;
+  if (cache != nullptr) {
+    // Map the files once, so that on a cache miss the same bytes that were
+    // digested for the key are decoded. If the files cannot be mapped they
+    // cannot be read, or are pipes that must not be read twice, so score them
+    // without the cache.
+    auto ref_file = Visqol::ResultCache::MapAudioFile(paths.reference);
+    auto deg_file = Visqol::ResultCache::MapAudioFile(paths.degraded);
+    if (ref_file.ok() && deg_file.ok()) {
+      const absl::Span<const char> ref_contents = ref_file.value()->Contents();
+      const absl::Span<const char> deg_contents = deg_file.value()->Contents();
+      comparison->cache_key = cache->MakeKey(ref_contents, deg_contents);
+      comparison->result = cache->Lookup(comparison->cache_key);
+      if (comparison->result.has_value()) {
+        comparison->result->set_reference_filepath(paths.reference.Path());
+        comparison->result->set_degraded_filepath(paths.degraded.Path());
+        return;
+      }
+      comparison->reference = manager.LoadSignal(ref_contents, paths.reference);
+      comparison->degraded = manager.LoadSignal(deg_contents, paths.degraded);
+      loaded = true;
+    }
+  }
+  if (!loaded) {
+    comparison->reference = manager.LoadSignal(paths.reference);
+    comparison->degraded = manager.LoadSignal(paths.degraded);
+  }
+  // Resample here, so that it is done on the loading threads when the audio
+  // is prefetched.
+  manager.ResampleInput(&comparison->reference);
+  manager.ResampleInput(&comparison->degraded);
+}
+
+// Score a loaded comparison, and add its result to the cache if there is one.
+absl::StatusOr<Visqol::SimilarityResultMsg> ScoreComparison(
+    Visqol::VisqolManager* manager, const Visqol::ResultCache* cache,
+    Visqol::LoadedComparison* comparison) {
+  if (comparison->result.has_value()) {
+    return comparison->result.value();
+  }
+
+  auto status_or = manager->Run(comparison->reference, comparison->degraded);
+  if (status_or.ok()) {
+    status_or->set_reference_filepath(comparison->paths.reference.Path());
+    status_or->set_degraded_filepath(comparison->paths.degraded.Path());
+    if (cache != nullptr && !comparison->cache_key.empty()) {
+      const absl::Status store_status =
+          cache->Store(comparison->cache_key, status_or.value());
+      if (!store_status.ok()) {
+        ABSL_RAW_LOG(WARNING, "%s", store_status.ToString().c_str());
+      }
+    }
+  }
+  return status_or;
+}
+
+// Submit the result of a single comparison to the sink, or log its error.
+// Returns false if processing should stop.
+bool HandleResult(
+    size_t pair_index,
+    const absl::StatusOr<Visqol::SimilarityResultMsg>& status_or,
+    Visqol::SimilarityResultsSink* sink) {
+  // If successful write value, else log an error.
+  if (status_or.ok()) {
+    sink->Submit(pair_index, status_or.value());
+  } else {
+    ABSL_RAW_LOG(ERROR, "Error executing ViSQOL: %s.",
+                 status_or.status().ToString().c_str());
+    sink->Skip(pair_index);
+    // A status of aborted gets thrown when visqol hasn't been init'd.
+    // So if that happens we want to quit processing.
+    if (status_or.status().code() == absl::StatusCode::kAborted) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Produces the next pair to compare, returning false when there are none left.
+using NextPairFunction =
+    std::function<bool(Visqol::ReferenceDegradedPathPair* pair)>;
+
+// Produces the next comparison to score, with its audio loaded, returning
+// false when there are none left. This is thread safe.
+using NextComparisonFunction =
+    std::function<bool(Visqol::LoadedComparison* comparison)>;
+
+// Run the comparisons on a pool of worker threads, each with its own clone of
+// the manager. The sink writes the results in input order.
+int RunInParallel(const Visqol::CommandLineArgs& cmd_args,
+                  const Visqol::VisqolManager& visqol,
+                  const NextComparisonFunction& next_comparison,
+                  const Visqol::ResultCache* cache,
+                  Visqol::SimilarityResultsSink* sink) {
+  std::vector<std::unique_ptr<Visqol::VisqolManager>> managers;
+  for (int i = 0; i < cmd_args.num_threads; i++) {
+    auto clone_statusor = visqol.Clone();
+    if (!clone_statusor.ok()) {
+      ABSL_RAW_LOG(ERROR, "%s", clone_statusor.status().ToString().c_str());
+      return -1;
+    }
+    managers.push_back(std::move(clone_statusor).value());
+  }
+
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> workers;
+  for (auto& manager : managers) {
+    workers.emplace_back([&, manager = manager.get()]() {
+      Visqol::LoadedComparison comparison;
+      while (!stop && next_comparison(&comparison)) {
+        auto status_or = ScoreComparison(manager, cache, &comparison);
+        if (!HandleResult(comparison.index, status_or, sink)) {
+          stop = true;
+        }
+        comparison = Visqol::LoadedComparison();
+      }
+    });
+  }
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  return 0;
+}
+
+}  // namespace
+
 int main(int argc, char** argv) {
   // Parse the command line args.
   auto parse_statusor = Visqol::VisqolCommandLineParser::Parse(argc, argv);
@@ -27,8 +176,74 @@ int main(int argc, char** argv) {
     return -1;
   }
   Visqol::CommandLineArgs cmd_args = parse_statusor.value();
-  auto files_to_compare =
-      Visqol::VisqolCommandLineParser::BuildFilePairPaths(cmd_args);
+
+  // Batch input is read one row at a time, so that scoring can start before
+  // the whole manifest has been read.
+  NextPairFunction next_pair;
+  std::unique_ptr<Visqol::ManifestReader> manifest_reader;
+  std::vector<Visqol::ReferenceDegradedPathPair> files_to_compare;
+  if (!cmd_args.batch_input_csv.Path().empty()) {
+    auto reader_statusor =
+        Visqol::ManifestReader::Open(cmd_args.batch_input_csv);
+    if (!reader_statusor.ok()) {
+      ABSL_RAW_LOG(ERROR, "%s", reader_statusor.status().ToString().c_str());
+      return -1;
+    }
+    manifest_reader = std::move(reader_statusor).value();
+    next_pair = [&manifest_reader](Visqol::ReferenceDegradedPathPair* pair) {
+      return manifest_reader->Next(pair);
+    };
+  } else {
+    files_to_compare =
+        Visqol::VisqolCommandLineParser::BuildFilePairPaths(cmd_args);
+    next_pair = [&files_to_compare,
+                 i = size_t{0}](Visqol::ReferenceDegradedPathPair* pair) mutable {
+      if (i == files_to_compare.size()) {
+        return false;
+      }
+      *pair = files_to_compare[i++];
+      return true;
+    };
+  }
+
+  // Only compare the pairs assigned to this shard.
+  if (cmd_args.num_shards > 1) {
+    next_pair = [shard_index = static_cast<size_t>(cmd_args.shard_index),
+                 num_shards = static_cast<size_t>(cmd_args.num_shards),
+                 next_unsharded_pair = std::move(next_pair)](
+                    Visqol::ReferenceDegradedPathPair* pair) mutable {
+      while (next_unsharded_pair(pair)) {
+        if (Visqol::ManifestReader::ShardIndex(*pair, num_shards) ==
+            shard_index) {
+          return true;
+        }
+      }
+      return false;
+    };
+  }
+
+  // When resuming, skip the pairs that already have a result.
+  if (cmd_args.resume) {
+    auto checkpoint_statusor =
+        Visqol::ResultsCheckpoint::Load(cmd_args.results_output_csv);
+    if (!checkpoint_statusor.ok()) {
+      ABSL_RAW_LOG(ERROR, "%s",
+                   checkpoint_statusor.status().ToString().c_str());
+      return -1;
+    }
+    ABSL_RAW_LOG(INFO, "Resuming after %zu completed comparisons.",
+                 checkpoint_statusor.value().NumCompleted());
+    next_pair = [checkpoint = std::move(checkpoint_statusor).value(),
+                 next_unfiltered_pair = std::move(next_pair)](
+                    Visqol::ReferenceDegradedPathPair* pair) mutable {
+      while (next_unfiltered_pair(pair)) {
+        if (!checkpoint.ConsumeIfCompleted(*pair)) {
+          return true;
+        }
+      }
+      return false;
+    };
+  }
 
   // Init ViSQOL.
   Visqol::VisqolManager visqol;
@@ -36,31 +251,86 @@ int main(int argc, char** argv) {
       cmd_args.similarity_to_quality_mapper_model, cmd_args.use_speech_mode,
       cmd_args.use_unscaled_speech_mos_mapping, cmd_args.search_window_radius,
       cmd_args.use_lattice_model, cmd_args.disable_global_alignment,
-      cmd_args.disable_realignment);
+      cmd_args.disable_realignment, cmd_args.bounded_realignment,
+      cmd_args.resample_input, cmd_args.multirate_filterbank,
+      cmd_args.raw_pcm_format);
   if (!init_status.ok()) {
     ABSL_RAW_LOG(ERROR, "%s", init_status.ToString().c_str());
     return -1;
   }
 
+  if (!cmd_args.batch_input_archive.Path().empty()) {
+    auto archive_statusor =
+        Visqol::AudioArchive::Open(cmd_args.batch_input_archive);
+    if (!archive_statusor.ok()) {
+      ABSL_RAW_LOG(ERROR, "%s", archive_statusor.status().ToString().c_str());
+      return -1;
+    }
+    visqol.SetInputArchive(std::move(archive_statusor).value());
+  }
+
+  std::unique_ptr<Visqol::ResultCache> cache;
+  if (!cmd_args.result_cache_dir.Path().empty()) {
+    auto cache_statusor = Visqol::ResultCache::Open(
+        cmd_args.result_cache_dir, visqol.ConfigurationKey().value());
+    if (!cache_statusor.ok()) {
+      ABSL_RAW_LOG(ERROR, "%s", cache_statusor.status().ToString().c_str());
+      return -1;
+    }
+    cache = std::make_unique<Visqol::ResultCache>(
+        std::move(cache_statusor).value());
+  }
+
+  Visqol::SimilarityResultsSink sink(
+      cmd_args.verbose, cmd_args.results_output_csv,
+      cmd_args.debug_output_path, cmd_args.use_speech_mode,
+      cmd_args.use_lattice_model);
+
+  // Load the audio of each comparison either ahead of time on background
+  // threads, or when it is about to be scored.
+  NextComparisonFunction next_comparison;
+  std::unique_ptr<Visqol::AudioPrefetcher> prefetcher;
+  absl::Mutex next_pair_mutex;
+  size_t next_pair_index = 0;
+  if (cmd_args.prefetch_depth > 0) {
+    prefetcher = std::make_unique<Visqol::AudioPrefetcher>(
+        std::move(next_pair),
+        [&visqol, cache = cache.get()](Visqol::LoadedComparison* comparison) {
+          LoadComparison(visqol, cache, comparison);
+        },
+        cmd_args.prefetch_depth,
+        static_cast<size_t>(cmd_args.prefetch_max_mb) << 20);
+    next_comparison = [&prefetcher](Visqol::LoadedComparison* comparison) {
+      return prefetcher->Next(comparison);
+    };
+  } else {
+    next_comparison = [&](Visqol::LoadedComparison* comparison) {
+      {
+        absl::MutexLock lock(&next_pair_mutex);
+        if (!next_pair(&comparison->paths)) {
+          return false;
+        }
+        comparison->index = next_pair_index++;
+      }
+      LoadComparison(visqol, cache.get(), comparison);
+      return true;
+    };
+  }
+
+  if (cmd_args.num_threads > 1) {
+    return RunInParallel(cmd_args, visqol, next_comparison, cache.get(),
+                         &sink);
+  }
+
   // Iterate over all signal pairs to compare.
-  for (const auto& signal_pair : files_to_compare) {
+  Visqol::LoadedComparison comparison;
+  while (next_comparison(&comparison)) {
     // Run comparison on a single signal pair.
-    auto status_or = visqol.Run(signal_pair.reference, signal_pair.degraded);
-    // If successful write value, else log an error.
-    if (status_or.ok()) {
-      Visqol::SimilarityResultsWriter::Write(
-          cmd_args.verbose, cmd_args.results_output_csv,
-          cmd_args.debug_output_path, status_or.value(),
-          cmd_args.use_speech_mode, cmd_args.use_lattice_model);
-    } else {
-      ABSL_RAW_LOG(ERROR, "Error executing ViSQOL: %s.",
-                   status_or.status().ToString().c_str());
-      // A status of aborted gets thrown when visqol hasn't been init'd.
-      // So if that happens we want to quit processing.
-      if (status_or.status().code() == absl::StatusCode::kAborted) {
-        break;
-      }
+    auto status_or = ScoreComparison(&visqol, cache.get(), &comparison);
+    if (!HandleResult(comparison.index, status_or, &sink)) {
+      break;
     }
+    comparison = Visqol::LoadedComparison();
   }
 
   return 0;
@@ -0,0 +1,126 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "manifest_reader.h"
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/base/attributes.h"
+#include "absl/base/internal/raw_logging.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+
+namespace Visqol {
+
+ABSL_CONST_INIT const char ManifestReader::kStdinPath[] = "-";
+
+namespace {
+// 64 bit FNV-1a, which unlike std::hash and absl::Hash gives the same value in
+// every process.
+const uint64_t kFnvOffsetBasis = 14695981039346656037ULL;
+const uint64_t kFnvPrime = 1099511628211ULL;
+
+uint64_t HashString(uint64_t hash, const std::string& str) {
+  for (const unsigned char c : str) {
+    hash ^= c;
+    hash *= kFnvPrime;
+  }
+  return hash;
+}
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<ManifestReader>> ManifestReader::Open(
+    const FilePath& manifest_path) {
+  std::unique_ptr<ManifestReader> reader;
+  if (manifest_path.Path() == kStdinPath) {
+    reader.reset(new ManifestReader(nullptr, &std::cin));
+  } else {
+    auto file = std::make_unique<std::ifstream>(manifest_path.Path());
+    if (!file->is_open()) {
+      return absl::NotFoundError(absl::StrCat(
+          "Unable to open batch input file: ", manifest_path.Path()));
+    }
+    std::istream* stream = file.get();
+    reader.reset(new ManifestReader(std::move(file), stream));
+  }
+
+  // Skip the header.
+  std::string header;
+  if (std::getline(*reader->stream_, header)) {
+    reader->line_number_++;
+  }
+  return reader;
+}
+
+ManifestReader::ManifestReader(std::unique_ptr<std::istream> owned_stream,
+                               std::istream* stream)
+    : owned_stream_(std::move(owned_stream)), stream_(stream) {}
+
+bool ManifestReader::Next(ReferenceDegradedPathPair* pair) {
+  std::string line;
+  while (std::getline(*stream_, line)) {
+    line_number_++;
+    // getline will read up to \n, so in cases where the line ending is \r\n,
+    // we need to manually strip the \r.
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (line.empty()) {
+      continue;
+    }
+
+    if (!ParseRow(line, pair)) {
+      ABSL_RAW_LOG(WARNING,
+                   "Skipping batch input row %zu, which does not have a "
+                   "reference and a degraded path.",
+                   line_number_);
+      continue;
+    }
+    return true;
+  }
+  return false;
+}
+
+bool ManifestReader::ParseRow(const std::string& line,
+                              ReferenceDegradedPathPair* pair) {
+  const char delimiter = ',';
+  const size_t first_delimiter = line.find(delimiter);
+  if (first_delimiter == std::string::npos) {
+    return false;
+  }
+  const size_t second_delimiter = line.find(delimiter, first_delimiter + 1);
+  pair->reference = FilePath(line.substr(0, first_delimiter));
+  pair->degraded = FilePath(line.substr(
+      first_delimiter + 1, second_delimiter == std::string::npos
+                               ? std::string::npos
+                               : second_delimiter - first_delimiter - 1));
+  return true;
+}
+
+size_t ManifestReader::ShardIndex(const ReferenceDegradedPathPair& pair,
+                                  size_t num_shards) {
+  uint64_t hash = HashString(kFnvOffsetBasis, pair.reference.Path());
+  // Separate the paths so that moving characters between them changes the
+  // hash.
+  hash = HashString(hash, "\n");
+  hash = HashString(hash, pair.degraded.Path());
+  return hash % num_shards;
+}
+}  // namespace Visqol
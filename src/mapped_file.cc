@@ -0,0 +1,113 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#include <fstream>
+#include <sstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+
+namespace Visqol {
+
+#ifdef _WIN32
+absl::StatusOr<std::unique_ptr<MappedFile>> MappedFile::Open(
+    const FilePath& path) {
+  std::ifstream file(path.Path(), std::ios::binary);
+  if (!file) {
+    return absl::NotFoundError(
+        absl::StrCat("Could not open file: ", path.Path()));
+  }
+  std::unique_ptr<MappedFile> mapped_file(new MappedFile());
+  std::stringstream contents;
+  contents << file.rdbuf();
+  mapped_file->buffer_ = contents.str();
+  mapped_file->size_ = mapped_file->buffer_.size();
+  return mapped_file;
+}
+
+MappedFile::~MappedFile() {}
+
+absl::Span<const char> MappedFile::Contents() const {
+  return absl::Span<const char>(buffer_.data(), size_);
+}
+#else
+absl::StatusOr<std::unique_ptr<MappedFile>> MappedFile::Open(
+    const FilePath& path) {
+  // Check the type before opening the file, since opening a pipe connects to
+  // its writer, and closing it again would lose the data it has written.
+  struct stat path_stat;
+  if (stat(path.Path().c_str(), &path_stat) != 0) {
+    return absl::NotFoundError(
+        absl::StrCat("Could not open file: ", path.Path()));
+  }
+  if (!S_ISREG(path_stat.st_mode)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Not a regular file: ", path.Path()));
+  }
+  const int fd = open(path.Path().c_str(), O_RDONLY);
+  if (fd < 0) {
+    return absl::NotFoundError(
+        absl::StrCat("Could not open file: ", path.Path()));
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) {
+    close(fd);
+    return absl::InvalidArgumentError(
+        absl::StrCat("Not a regular file: ", path.Path()));
+  }
+
+  std::unique_ptr<MappedFile> mapped_file(new MappedFile());
+  mapped_file->size_ = static_cast<size_t>(file_stat.st_size);
+  // An empty file cannot be mapped, but needs no mapping either.
+  if (mapped_file->size_ > 0) {
+    void* mapping =
+        mmap(nullptr, mapped_file->size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      close(fd);
+      return absl::InternalError(
+          absl::StrCat("Could not map file: ", path.Path()));
+    }
+    // The file is read front to back.
+    madvise(mapping, mapped_file->size_, MADV_SEQUENTIAL);
+    mapped_file->mapping_ = mapping;
+  }
+  // The mapping stays valid after the descriptor is closed.
+  close(fd);
+  return mapped_file;
+}
+
+MappedFile::~MappedFile() {
+  if (mapping_ != nullptr) {
+    munmap(mapping_, size_);
+  }
+}
+
+absl::Span<const char> MappedFile::Contents() const {
+  return absl::Span<const char>(static_cast<const char*>(mapping_), size_);
+}
+#endif
+}  // namespace Visqol
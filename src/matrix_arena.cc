@@ -0,0 +1,151 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "matrix_arena.h"
+
+#include <new>
+#include <vector>
+
+#include "absl/numeric/bits.h"
+
+namespace Visqol {
+
+const size_t MatrixArena::kAlignment = 32;
+const size_t MatrixArena::kMinBlockBytes = 256;
+const size_t MatrixArena::kMaxBlockBytes = 16 << 20;
+const size_t MatrixArena::kMaxPooledBytes = 64 << 20;
+
+namespace {
+
+// Blocks are pooled in size classes of powers of two, from kMinBlockBytes
+// up to kMaxBlockBytes.
+constexpr size_t kNumSizeClasses = 17;
+
+// Every block starts with a header, which is followed by the memory handed
+// out by Allocate. The header is padded to keep that memory aligned.
+struct BlockHeader {
+  // The size class of the block, or kNumSizeClasses if it is not pooled.
+  size_t size_class;
+  // The number of bytes of the block that follow the header.
+  size_t capacity;
+};
+
+constexpr size_t kHeaderBytes = 32;
+static_assert(sizeof(BlockHeader) <= kHeaderBytes,
+              "The block header does not fit in its padding.");
+
+// The blocks pooled by a thread, by size class.
+struct ThreadCache {
+  ~ThreadCache() { FreeAll(); }
+
+  void FreeAll();
+
+  size_t pooled_bytes = 0;
+  std::vector<BlockHeader*> free_blocks[kNumSizeClasses];
+};
+
+// The number of active scopes on this thread. This is kept apart from the
+// ThreadCache, which is only accessed within a scope, so that matrices that
+// are released during thread or program exit never touch a destroyed cache.
+thread_local int scope_depth = 0;
+
+ThreadCache& GetThreadCache() {
+  thread_local ThreadCache cache;
+  return cache;
+}
+
+void FreeBlock(BlockHeader* block) {
+  ::operator delete(block, std::align_val_t(MatrixArena::kAlignment));
+}
+
+void ThreadCache::FreeAll() {
+  for (auto& blocks : free_blocks) {
+    for (BlockHeader* block : blocks) {
+      FreeBlock(block);
+    }
+    blocks.clear();
+  }
+  pooled_bytes = 0;
+}
+
+size_t SizeClass(size_t num_bytes) {
+  if (num_bytes > MatrixArena::kMaxBlockBytes) {
+    return kNumSizeClasses;
+  }
+  if (num_bytes <= MatrixArena::kMinBlockBytes) {
+    return 0;
+  }
+  return absl::bit_width(num_bytes - 1) -
+         absl::bit_width(MatrixArena::kMinBlockBytes - 1);
+}
+}  // namespace
+
+MatrixArena::Scope::Scope() { scope_depth++; }
+
+MatrixArena::Scope::~Scope() {
+  if (--scope_depth == 0) {
+    GetThreadCache().FreeAll();
+  }
+}
+
+void* MatrixArena::Allocate(size_t num_bytes) {
+  // Outside a scope the memory is usually for a long-lived matrix, such as a
+  // loaded signal, so it is allocated at its exact size and never pooled,
+  // rather than rounded up to its size class.
+  const size_t size_class =
+      scope_depth > 0 ? SizeClass(num_bytes) : kNumSizeClasses;
+  if (size_class < kNumSizeClasses) {
+    ThreadCache& cache = GetThreadCache();
+    auto& blocks = cache.free_blocks[size_class];
+    if (!blocks.empty()) {
+      BlockHeader* block = blocks.back();
+      blocks.pop_back();
+      cache.pooled_bytes -= block->capacity;
+      return reinterpret_cast<char*>(block) + kHeaderBytes;
+    }
+  }
+
+  const size_t capacity = size_class < kNumSizeClasses
+                              ? kMinBlockBytes << size_class
+                              : num_bytes;
+  void* memory = ::operator new(kHeaderBytes + capacity,
+                                std::align_val_t(kAlignment), std::nothrow);
+  if (memory == nullptr) {
+    return nullptr;
+  }
+  BlockHeader* block = new (memory) BlockHeader{size_class, capacity};
+  return reinterpret_cast<char*>(block) + kHeaderBytes;
+}
+
+void MatrixArena::Release(void* memory) {
+  if (memory == nullptr) {
+    return;
+  }
+  BlockHeader* block = reinterpret_cast<BlockHeader*>(
+      static_cast<char*>(memory) - kHeaderBytes);
+  if (scope_depth > 0 && block->size_class < kNumSizeClasses) {
+    ThreadCache& cache = GetThreadCache();
+    if (cache.pooled_bytes + block->capacity <= kMaxPooledBytes) {
+      cache.free_blocks[block->size_class].push_back(block);
+      cache.pooled_bytes += block->capacity;
+      return;
+    }
+  }
+  FreeBlock(block);
+}
+
+size_t MatrixArena::PooledBytes() {
+  return scope_depth > 0 ? GetThreadCache().pooled_bytes : 0;
+}
+}  // namespace Visqol
@@ -0,0 +1,97 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Combines the outputs of the shards of a batch run with --shard_index and
+// --num_shards into a single output in batch manifest order.
+
+#include <string>
+#include <vector>
+
+#include "absl/base/internal/raw_logging.h"
+#include "absl/flags/declare.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/flags/usage.h"
+#include "absl/status/status.h"
+#include "file_path.h"
+#include "shard_merger.h"
+
+// These flags are shared with the visqol binary.
+ABSL_DECLARE_FLAG(std::string, batch_input_csv);
+ABSL_DECLARE_FLAG(std::string, results_csv);
+ABSL_DECLARE_FLAG(std::string, output_debug);
+
+ABSL_FLAG(std::vector<std::string>, shard_results_csv, {},
+          "Comma separated list of the results CSV files of each shard.");
+ABSL_FLAG(std::vector<std::string>, shard_output_debug, {},
+          "Comma separated list of the debug JSON files of each shard.");
+
+namespace {
+
+std::vector<Visqol::FilePath> ToFilePaths(
+    const std::vector<std::string>& paths) {
+  std::vector<Visqol::FilePath> file_paths;
+  for (const std::string& path : paths) {
+    file_paths.push_back(Visqol::FilePath(path));
+  }
+  return file_paths;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  absl::SetProgramUsageMessage(
+      "Merges the results of a sharded ViSQOL batch run in manifest order.\n"
+      "Pass the batch manifest with --batch_input_csv, the shard outputs\n"
+      "with --shard_results_csv and --shard_output_debug, and the merged\n"
+      "outputs with --results_csv and --output_debug.");
+  absl::ParseCommandLine(argc, argv);
+
+  const Visqol::FilePath manifest(absl::GetFlag(FLAGS_batch_input_csv));
+  const std::vector<std::string> shard_csvs =
+      absl::GetFlag(FLAGS_shard_results_csv);
+  const std::vector<std::string> shard_debugs =
+      absl::GetFlag(FLAGS_shard_output_debug);
+  const Visqol::FilePath merged_csv(absl::GetFlag(FLAGS_results_csv));
+  const Visqol::FilePath merged_debug(absl::GetFlag(FLAGS_output_debug));
+
+  if (manifest.Path().empty() ||
+      (shard_csvs.empty() == !merged_csv.Path().empty()) ||
+      (shard_debugs.empty() == !merged_debug.Path().empty()) ||
+      (shard_csvs.empty() && shard_debugs.empty())) {
+    ABSL_RAW_LOG(ERROR,
+                 "Invalid command line argument detected. "
+                 "Run with --helpfull for usage.");
+    return -1;
+  }
+
+  int exit_code = 0;
+  if (!shard_csvs.empty()) {
+    const absl::Status status = Visqol::ShardMerger::MergeResultsCSV(
+        manifest, ToFilePaths(shard_csvs), merged_csv);
+    if (!status.ok()) {
+      ABSL_RAW_LOG(ERROR, "%s", status.ToString().c_str());
+      exit_code = -1;
+    }
+  }
+  if (!shard_debugs.empty()) {
+    const absl::Status status = Visqol::ShardMerger::MergeDebugJSON(
+        manifest, ToFilePaths(shard_debugs), merged_debug);
+    if (!status.ok()) {
+      ABSL_RAW_LOG(ERROR, "%s", status.ToString().c_str());
+      exit_code = -1;
+    }
+  }
+  return exit_code;
+}
@@ -19,12 +19,19 @@
 #include <algorithm>
 #include <cmath>
 #include <fstream>
+#include <functional>
+#include <iostream>
+#include <istream>
 #include <memory>
 #include <sstream>
+#include <streambuf>
 #include <utility>
 #include <vector>
 
 #include "absl/base/internal/raw_logging.h"
+#include "flac_reader.h"
+#include "manifest_reader.h"
+#include "mapped_file.h"
 #include "wav_reader.h"
 
 namespace Visqol {
@@ -34,144 +41,266 @@ const double MiscAudio::kZeroSample = 0.0;
 const double MiscAudio::kSplReferencePoint = 0.00002;
 const double kNoiseFloorRelativeToPeakDb = 45.;
 const double kNoiseFloorAbsoluteDb = -45.;
+// The number of frames read at a time from a stream of unknown length.
+const size_t kLoadBlockFrames = 1 << 16;
+// Scales 16 bit samples to [-1, 1).
+const double kInt16Scale = 1.0 / 32768.0;
 
-AudioSignal MiscAudio::ScaleToMatchSoundPressureLevel(
-    const AudioSignal& reference, const AudioSignal& degraded) {
+namespace {
+// A read-only stream buffer over memory, so that a WAV header can be parsed
+// in place.
+class SpanStreamBuf : public std::streambuf {
+ public:
+  explicit SpanStreamBuf(absl::Span<const char> data) {
+    char* begin = const_cast<char*>(data.data());
+    setg(begin, begin, begin + data.size());
+  }
+
+ protected:
+  // The buffer only has a get area, so the open mode does not matter.
+  pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                   std::ios_base::openmode /*which*/) override {
+    off_type base = 0;
+    if (dir == std::ios_base::cur) {
+      base = gptr() - eback();
+    } else if (dir == std::ios_base::end) {
+      base = egptr() - eback();
+    }
+    const off_type pos = base + off;
+    if (pos < 0 || pos > egptr() - eback()) {
+      return pos_type(off_type(-1));
+    }
+    setg(eback(), eback() + pos, egptr());
+    return pos_type(pos);
+  }
+
+  pos_type seekpos(pos_type pos, std::ios_base::openmode /*which*/) override {
+    return seekoff(off_type(pos), std::ios_base::beg, std::ios_base::in);
+  }
+};
+
+// Scales and averages the samples of each interleaved frame. The channels are
+// summed in order before dividing by their number. The common channel counts
+// have their own loops, with no inner loop, so that the compiler can
+// vectorize them.
+template <typename T>
+void DownmixInterleaved(absl::Span<const T> interleaved, size_t num_channels,
+                        double scale, absl::Span<double> mono) {
+  assert(num_channels > 0 && interleaved.size() % num_channels == 0);
+  const size_t num_frames = interleaved.size() / num_channels;
+  assert(mono.size() >= num_frames);
+  const T* in = interleaved.data();
+  double* out = mono.data();
+  const double num_channels_double = static_cast<double>(num_channels);
+  switch (num_channels) {
+    case 1:
+      for (size_t frame = 0; frame < num_frames; frame++) {
+        out[frame] = in[frame] * scale;
+      }
+      break;
+    case 2:
+      for (size_t frame = 0; frame < num_frames; frame++) {
+        out[frame] =
+            (in[2 * frame] * scale + in[2 * frame + 1] * scale) / 2.0;
+      }
+      break;
+    default:
+      for (size_t frame = 0; frame < num_frames; frame++) {
+        const T* samples = in + frame * num_channels;
+        double sum = samples[0] * scale;
+        for (size_t chan = 1; chan < num_channels; chan++) {
+          sum += samples[chan] * scale;
+        }
+        out[frame] = sum / num_channels_double;
+      }
+  }
+}
+
+// Open the file at the path and load it with the given function. Regular
+// files are mapped into memory and read in place. The standard input, named
+// pipes and other files that cannot be mapped are read as streams.
+AudioSignal LoadFromPath(
+    const FilePath& path,
+    const std::function<AudioSignal(std::istream*)>& load_from_stream) {
+  if (path.Path() == ManifestReader::kStdinPath) {
+    return load_from_stream(&std::cin);
+  }
+  // Pipes and devices are not opened by MappedFile, so they are only opened
+  // once, here, and read as a stream.
+  auto mapped_file_statusor = MappedFile::Open(path);
+  if (mapped_file_statusor.ok()) {
+    SpanStreamBuf stream_buf(mapped_file_statusor.value()->Contents());
+    std::istream stream(&stream_buf);
+    return load_from_stream(&stream);
+  }
+  std::ifstream file(path.Path(), std::ios::binary);
+  if (!file.is_open()) {
+    ABSL_RAW_LOG(ERROR, "Could not find file %s.", path.Path().c_str());
+    return AudioSignal();
+  }
+  return load_from_stream(&file);
+}
+}  // namespace
+
+AudioSignalView MiscAudio::ScaleToMatchSoundPressureLevel(
+    const AudioSignalView& reference, const AudioSignalView& degraded) {
   const double ref_spl = MiscAudio::CalcSoundPressureLevel(reference);
   const double deg_spl = MiscAudio::CalcSoundPressureLevel(degraded);
   const double scale_factor = std::pow(10, (ref_spl - deg_spl) / 20);
-  const auto scaled_mat = degraded.data_matrix * scale_factor;
-  AudioSignal scaled_sig{std::move(scaled_mat), degraded.sample_rate};
-  return scaled_sig;
+  return degraded.Scaled(scale_factor);
 }
 
-double MiscAudio::CalcSoundPressureLevel(const AudioSignal& signal) {
-  const AMatrix<double>& data_matrix = signal.data_matrix;
+double MiscAudio::CalcSoundPressureLevel(const AudioSignalView& signal) {
   double sum = 0;
-  std::for_each(data_matrix.cbegin(), data_matrix.cend(),
-                [&](const double& datum) { sum += std::pow(datum, 2); });
-  const double sound_pressure = std::sqrt(sum / data_matrix.NumElements());
+  for (size_t i = 0; i < signal.NumSamples(); i++) {
+    sum += std::pow(signal[i], 2);
+  }
+  const double sound_pressure = std::sqrt(sum / signal.NumSamples());
   return 20 * std::log10(sound_pressure / kSplReferencePoint);
 }
 
-// Combines the data from all channels into a single channel.
-AMatrix<double> MiscAudio::ToMono(const AMatrix<double>& signal) {
-  // If already Mono, nothing to do.
-  if (signal.NumCols() > kNumChanMono) {
-    auto mono_mat =
-        AMatrix<double>::Filled(signal.NumRows(), kNumChanMono, kZeroSample);
-    for (size_t chan_i = 0; chan_i < signal.NumCols(); chan_i++) {
-      for (size_t sample_i = 0; sample_i < signal.NumRows(); sample_i++) {
-        mono_mat(sample_i, 0) += signal(sample_i, chan_i);
-      }
-    }
-    return mono_mat / signal.NumCols();
-  } else {
-    return signal;
-  }
+AudioSignal MiscAudio::LoadAsMono(const FilePath& path) {
+  return LoadFromPath(path, [&path](std::istream* stream) {
+    return LoadAsMono(stream, path.Path());
+  });
 }
 
-// Combines the data from all channels into a single channel.
-AudioSignal MiscAudio::ToMono(const AudioSignal& signal) {
-  // If already Mono, nothing to do.
-  if (signal.data_matrix.NumCols() > kNumChanMono) {
-    const AMatrix<double> sig_mid_mat(MiscAudio::ToMono(signal.data_matrix));
-    AudioSignal sig_mid;
-    sig_mid.data_matrix = std::move(sig_mid_mat);
-    sig_mid.sample_rate = signal.sample_rate;
-    return sig_mid;
-  } else {
-    return signal;
-  }
+AudioSignal MiscAudio::LoadRawPcmAsMono(const FilePath& path,
+                                        const WavReader::PcmFormat& format) {
+  return LoadFromPath(path, [&path, &format](std::istream* stream) {
+    return LoadRawPcmAsMono(stream, format, path.Path());
+  });
 }
 
-AudioSignal MiscAudio::LoadAsMono(const FilePath& path) {
-  std::ifstream wav_file(path.Path().c_str(), std::ios::binary);
-  if (wav_file) {
-    std::stringstream wav_string_stream;
-    wav_string_stream << wav_file.rdbuf();
-    wav_file.close();
-    return LoadAsMono(&wav_string_stream, path.Path());
-  } else {
-    ABSL_RAW_LOG(ERROR, "Could not find file %s.", path.Path().c_str());
+AudioSignal MiscAudio::LoadRawPcmAsMono(std::istream* stream,
+                                        const WavReader::PcmFormat& format,
+                                        absl::optional<std::string> filepath) {
+  WavReader wav_reader(stream, format);
+  if (!wav_reader.IsHeaderValid()) {
     return AudioSignal();
   }
+  return ReadAsMono(&wav_reader, filepath);
+}
+
+AudioSignal MiscAudio::LoadRawPcmAsMono(absl::Span<const char> pcm_data,
+                                        const WavReader::PcmFormat& format,
+                                        absl::optional<std::string> filepath) {
+  SpanStreamBuf stream_buf(pcm_data);
+  std::istream stream(&stream_buf);
+  return LoadRawPcmAsMono(&stream, format, std::move(filepath));
+}
+
+AudioSignal MiscAudio::LoadAsMono(absl::Span<const char> wav_data,
+                                  absl::optional<std::string> filepath) {
+  SpanStreamBuf stream_buf(wav_data);
+  std::istream stream(&stream_buf);
+  return LoadAsMono(&stream, std::move(filepath));
 }
 
-AudioSignal MiscAudio::LoadAsMono(std::stringstream* string_stream,
+AudioSignal MiscAudio::LoadAsMono(std::istream* stream,
                                   absl::optional<std::string> filepath) {
+  if (FlacReader::HasSignature(stream)) {
+    FlacReader flac_reader(stream);
+    return ReadAsMono(&flac_reader, filepath);
+  }
+  WavReader wav_reader(stream);
+  return ReadAsMono(&wav_reader, filepath);
+}
+
+template <typename Reader>
+AudioSignal MiscAudio::ReadAsMono(
+    Reader* reader, const absl::optional<std::string>& filepath) {
   AudioSignal sig;
-  WavReader wav_reader(string_stream);
-  const size_t num_total_samples = wav_reader.GetNumTotalSamples();
+  const size_t num_total_samples = reader->GetNumTotalSamples();
+  if (!reader->IsHeaderValid() ||
+      (reader->IsLengthKnown() && num_total_samples == 0)) {
+    if (filepath.has_value()) {
+      ABSL_RAW_LOG(ERROR, "Error reading header for file %s.",
+                   filepath->c_str());
+    } else {
+      ABSL_RAW_LOG(ERROR, "Error reading header from audio stream.");
+    }
+    return sig;
+  }
 
-  if (wav_reader.IsHeaderValid() && num_total_samples != 0) {
-    std::vector<int16_t> interleaved_samples(num_total_samples);
-    const auto num_samp_read =
-        wav_reader.ReadSamples(num_total_samples, &interleaved_samples[0]);
+  // The samples are normalized and downmixed by the reader a block at a time,
+  // so the interleaved samples are never held in full.
+  const size_t num_channels = reader->GetNumChannels();
+  arma::Mat<double> mono;
+  size_t num_frames_read = 0;
+  if (reader->IsLengthKnown()) {
+    // The signal has the length given in the header, with any missing
+    // samples at the end set to zero.
+    const size_t num_frames = num_total_samples / num_channels;
+    mono.set_size(num_frames, kNumChanMono);
+    num_frames_read = reader->ReadMonoFrames(num_frames, mono.memptr());
+    std::fill(mono.memptr() + num_frames_read, mono.memptr() + num_frames,
+              kZeroSample);
 
     // Certain wav files are 'mostly valid' and have a slight difference with
     // the reported file length.  Warn for these.
-    if (num_samp_read != num_total_samples) {
+    if (num_frames_read != num_frames) {
       ABSL_RAW_LOG(WARNING,
                    "Number of samples read (%lu) was less than the expected"
                    " number (%lu).",
-                   num_samp_read, num_total_samples);
-    }
-    if (num_samp_read > 0) {
-      const auto interleaved_norm_vec =
-          MiscMath::NormalizeInt16ToDouble(interleaved_samples);
-      const auto multi_chan_norm_vec = ExtractMultiChannel(
-          wav_reader.GetNumChannels(), interleaved_norm_vec);
-
-      const AMatrix<double> outMat(multi_chan_norm_vec);
-      sig.data_matrix = outMat;
-      sig.sample_rate = wav_reader.GetSampleRateHz();
-      sig = MiscAudio::ToMono(sig);
-    } else {
-      if (filepath.has_value()) {
-        ABSL_RAW_LOG(ERROR, "Error reading data for file %s.",
-                     filepath->c_str());
-      } else {
-        ABSL_RAW_LOG(ERROR, "Error reading data from audio stream.");
-      }
+                   num_frames_read * num_channels, num_total_samples);
     }
   } else {
+    // A stream written without knowing its length is read until it ends.
+    std::vector<double> frames;
+    size_t num_block_frames_read;
+    do {
+      frames.resize(num_frames_read + kLoadBlockFrames);
+      num_block_frames_read = reader->ReadMonoFrames(
+          kLoadBlockFrames, frames.data() + num_frames_read);
+      num_frames_read += num_block_frames_read;
+    } while (num_block_frames_read == kLoadBlockFrames);
+    mono.set_size(num_frames_read, kNumChanMono);
+    std::copy(frames.begin(), frames.begin() + num_frames_read,
+              mono.memptr());
+  }
+
+  if (num_frames_read == 0) {
     if (filepath.has_value()) {
-      ABSL_RAW_LOG(ERROR, "Error reading header for file %s.",
-                   filepath->c_str());
+      ABSL_RAW_LOG(ERROR, "Error reading data for file %s.", filepath->c_str());
     } else {
-      ABSL_RAW_LOG(ERROR, "Error reading header from audio stream.");
+      ABSL_RAW_LOG(ERROR, "Error reading data from audio stream.");
     }
+    return sig;
   }
 
+  sig.data_matrix = AMatrix<double>(std::move(mono));
+  sig.sample_rate = reader->GetSampleRateHz();
   return sig;
 }
 
-std::vector<std::vector<double>> MiscAudio::ExtractMultiChannel(
-    const int num_channels, const std::vector<double>& interleaved_vector) {
-  assert(interleaved_vector.size() % num_channels == 0);
-  const size_t sub_vector_size = interleaved_vector.size() / num_channels;
-  std::vector<std::vector<double>> multi_channel_vec(
-      num_channels, std::vector<double>(sub_vector_size));
+void MiscAudio::InterleavedToMono(absl::Span<const int16_t> interleaved,
+                                  size_t num_channels,
+                                  absl::Span<double> mono) {
+  DownmixInterleaved(interleaved, num_channels, kInt16Scale, mono);
+}
 
-  auto itr = interleaved_vector.cbegin();
-  for (size_t sample = 0; sample < sub_vector_size; sample++) {
-    for (int channel = 0; channel < num_channels; channel++) {
-      multi_channel_vec[channel][sample] = *itr;
-      itr++;
-    }
-  }
-  return multi_channel_vec;
+void MiscAudio::InterleavedToMono(absl::Span<const double> interleaved,
+                                  size_t num_channels,
+                                  absl::Span<double> mono) {
+  DownmixInterleaved(interleaved, num_channels, 1.0, mono);
 }
 
 void MiscAudio::PrepareSpectrogramsForComparison(Spectrogram& reference,
                                                  Spectrogram& degraded) {
-  reference.ConvertToDb();
-  degraded.ConvertToDb();
+  PrepareSpectrogramForComparison(reference);
+  PrepareSpectrogramForComparison(degraded);
+  ApplyCommonNoiseFloor(reference, degraded);
+}
 
+void MiscAudio::PrepareSpectrogramForComparison(Spectrogram& spectrogram) {
+  spectrogram.ConvertToDb();
   // An absolute threshold is also applied.
-  reference.RaiseFloor(kNoiseFloorAbsoluteDb);
-  degraded.RaiseFloor(kNoiseFloorAbsoluteDb);
+  spectrogram.RaiseFloor(kNoiseFloorAbsoluteDb);
+}
+
+void MiscAudio::ApplyCommonNoiseFloor(Spectrogram& reference,
+                                      Spectrogram& degraded) {
   // Apply a per-frame relative threshold.
   // Note that this is not an STFT spectrogram, the spectrogram bins
   // here are each the RMS of a band filter output on the time domain signal.
@@ -0,0 +1,206 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "multirate_gammatone_spectrogram_builder.h"
+
+#include <cmath>
+#include <utility>
+#include <valarray>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "amatrix.h"
+#include "analysis_window.h"
+#include "audio_signal.h"
+#include "equivalent_rectangular_bandwidth.h"
+#include "gammatone_spectrogram_builder.h"
+#include "spectrogram.h"
+
+namespace Visqol {
+
+const size_t MultirateGammatoneSpectrogramBuilder::kMaxDecimation = 16;
+const double MultirateGammatoneSpectrogramBuilder::kPassbandFraction = 0.8;
+const double MultirateGammatoneSpectrogramBuilder::kBandwidthMargin = 2.0;
+const size_t MultirateGammatoneSpectrogramBuilder::kHalfBandTaps = 31;
+
+namespace {
+
+// Design a Blackman windowed sinc low pass filter with its cutoff at a
+// quarter of the sample rate. Every other coefficient away from the centre is
+// zero.
+std::vector<double> DesignHalfBandFilter(size_t num_taps) {
+  const int half_length = num_taps / 2;
+  std::vector<double> coeffs(num_taps, 0.0);
+  double sum = 0.0;
+  for (int n = -half_length; n <= half_length; n++) {
+    if (n != 0 && n % 2 == 0) {
+      continue;
+    }
+    const double x = M_PI * n / 2.0;
+    const double sinc = n == 0 ? 1.0 : std::sin(x) / x;
+    const double phase = M_PI * (n + half_length) / half_length;
+    const double window =
+        0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase);
+    coeffs[n + half_length] = 0.5 * sinc * window;
+    sum += coeffs[n + half_length];
+  }
+  // Normalise to unit gain at DC.
+  for (auto& coeff : coeffs) {
+    coeff /= sum;
+  }
+  return coeffs;
+}
+
+// Low pass filter the signal with the half-band filter and keep every other
+// sample. The signal is treated as zero outside of its bounds, which suits
+// the windowed frames that this is applied to.
+std::valarray<double> DecimateByTwo(const std::valarray<double>& signal,
+                                    const std::vector<double>& half_band) {
+  const int half_length = half_band.size() / 2;
+  const int length = signal.size();
+  std::valarray<double> output((signal.size() + 1) / 2);
+  for (int m = 0; m < static_cast<int>(output.size()); m++) {
+    const int centre = 2 * m;
+    double sum = half_band[half_length] * signal[centre];
+    // Only the odd offsets from the centre have non-zero coefficients.
+    for (int n = 1; n <= half_length; n += 2) {
+      const double coeff = half_band[half_length + n];
+      if (centre - n >= 0) {
+        sum += coeff * signal[centre - n];
+      }
+      if (centre + n < length) {
+        sum += coeff * signal[centre + n];
+      }
+    }
+    output[m] = sum;
+  }
+  return output;
+}
+
+}  // namespace
+
+MultirateGammatoneSpectrogramBuilder::MultirateGammatoneSpectrogramBuilder(
+    const GammatoneFilterBank& filter_bank, const bool use_speech_mode)
+    : filter_bank_(filter_bank),
+      speech_mode_(use_speech_mode),
+      half_band_(DesignHalfBandFilter(kHalfBandTaps)) {}
+
+std::vector<MultirateGammatoneSpectrogramBuilder::Tier>
+MultirateGammatoneSpectrogramBuilder::MakeTiers(
+    double sample_rate, const std::vector<double>& center_freqs) const {
+  // The bands are in ascending order of frequency, so the decimation of each
+  // band is no larger than that of the band below it.
+  std::vector<size_t> decimations(center_freqs.size());
+  for (size_t band = 0; band < center_freqs.size(); band++) {
+    const double upper_freq =
+        center_freqs[band] +
+        kBandwidthMargin *
+            EquivalentRectangularBandwidth::CalcBandwidth(center_freqs[band]);
+    size_t decimation = 1;
+    while (decimation < kMaxDecimation &&
+           upper_freq <=
+               kPassbandFraction * sample_rate / (4.0 * decimation)) {
+      decimation *= 2;
+    }
+    decimations[band] = decimation;
+  }
+
+  std::vector<Tier> tiers;
+  size_t end_band = center_freqs.size();
+  while (end_band > 0) {
+    const size_t decimation = decimations[end_band - 1];
+    size_t first_band = end_band - 1;
+    while (first_band > 0 && decimations[first_band - 1] == decimation) {
+      first_band--;
+    }
+    const std::vector<double> tier_freqs(center_freqs.begin() + first_band,
+                                         center_freqs.begin() + end_band);
+    ErbFiltersResult erb_rslt = EquivalentRectangularBandwidth::MakeFilters(
+        sample_rate / decimation, tier_freqs);
+    GammatoneFilterBank tier_bank(tier_freqs.size(), filter_bank_.GetMinFreq());
+    tier_bank.SetFilterCoefficients(AMatrix<double>(erb_rslt.filterCoeffs));
+    tiers.push_back(Tier{decimation, first_band, std::move(tier_bank)});
+    end_band = first_band;
+  }
+  return tiers;
+}
+
+absl::StatusOr<Spectrogram> MultirateGammatoneSpectrogramBuilder::Build(
+    const AudioSignalView& signal, const AnalysisWindow& window) {
+  size_t sample_rate = signal.GetSampleRate();
+  double max_freq = speech_mode_
+                        ? GammatoneSpectrogramBuilder::kSpeechModeMaxFreq
+                        : sample_rate / 2.0;
+
+  // Use the same center frequencies as the single rate builder, ordered from
+  // lowest to highest.
+  ErbFiltersResult erb_rslt = EquivalentRectangularBandwidth::MakeFilters(
+      sample_rate, filter_bank_.GetNumBands(), filter_bank_.GetMinFreq(),
+      max_freq);
+  const std::vector<double> ordered_cfb(erb_rslt.centerFreqs.rbegin(),
+                                        erb_rslt.centerFreqs.rend());
+  std::vector<Tier> tiers = MakeTiers(sample_rate, ordered_cfb);
+
+  // Set up the windowing.
+  size_t hop_size = window.size * window.overlap;
+
+  // Ensure that the signal is large enough.
+  if (signal.NumSamples() <= window.size) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Too few samples (", signal.NumSamples(),
+                     ") in signal to  build spectrogram (", window.size,
+                     " required minimum)."));
+  }
+  size_t num_cols = 1 + floor((signal.NumSamples() - window.size) / hop_size);
+  AMatrix<double> out_matrix(ordered_cfb.size(), num_cols);
+
+  std::valarray<double> frame(window.size);
+  for (size_t i = 0; i < out_matrix.NumCols(); i++) {
+    const size_t start_col = i * hop_size;
+    // Copy the next frame from the input signal to filter.
+    signal.CopySamples(start_col, window.size, &frame[0]);
+
+    // Apply a Hann window to reduce artifacts.
+    std::valarray<double> windowed_frame = window.ApplyHannWindow(frame);
+
+    // Filter each tier, decimating the frame further as the tiers descend in
+    // frequency.
+    size_t decimation = 1;
+    for (auto& tier : tiers) {
+      while (decimation < tier.decimation) {
+        windowed_frame = DecimateByTwo(windowed_frame, half_band_);
+        decimation *= 2;
+      }
+      tier.filter_bank.ResetFilterConditions();
+      const AMatrix<double> filtered_signal =
+          tier.filter_bank.ApplyFilter(windowed_frame);
+      // Set the RMS of each band as its value in this frame.
+      for (size_t row = 0; row < filtered_signal.NumRows(); row++) {
+        double sum_squares = 0.0;
+        for (size_t col = 0; col < filtered_signal.NumCols(); col++) {
+          sum_squares += filtered_signal(row, col) * filtered_signal(row, col);
+        }
+        out_matrix(tier.first_band + row, i) =
+            sqrt(sum_squares / filtered_signal.NumCols());
+      }
+    }
+  }
+
+  Spectrogram spectro(std::move(out_matrix));
+  spectro.SetCenterFreqBands(ordered_cfb);
+  return spectro;
+}
+}  // namespace Visqol
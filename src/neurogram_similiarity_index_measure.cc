@@ -35,38 +35,48 @@ PatchSimilarityResult NeurogramSimiliarityIndexMeasure::MeasurePatchSimilarity(
 
   auto mu_r = Convolution2D<double>::Valid2DConvWithBoundary(window, ref_patch);
   auto mu_d = Convolution2D<double>::Valid2DConvWithBoundary(window, deg_patch);
-  auto ref_mu_sq = mu_r.PointWiseProduct(mu_r);
-  auto deg_mu_sq = mu_d.PointWiseProduct(mu_d);
-  auto mu_r_mu_d = mu_r.PointWiseProduct(mu_d);
   auto ref_neuro_sq = ref_patch.PointWiseProduct(ref_patch);
   auto deg_neuro_sq = deg_patch.PointWiseProduct(deg_patch);
+  auto ref_neuro_deg = ref_patch.PointWiseProduct(deg_patch);
   auto conv2_ref_neuro_sq =
       Convolution2D<double>::Valid2DConvWithBoundary(window, ref_neuro_sq);
-  auto sigma_r_sq = conv2_ref_neuro_sq - ref_mu_sq;
   auto conv2_deg_neuro_sq =
       Convolution2D<double>::Valid2DConvWithBoundary(window, deg_neuro_sq);
-  auto sigma_d_sq = conv2_deg_neuro_sq - deg_mu_sq;
-  auto ref_neuro_deg = ref_patch.PointWiseProduct(deg_patch);
   auto conv2_ref_neuro_deg =
       Convolution2D<double>::Valid2DConvWithBoundary(window, ref_neuro_deg);
-  auto sigma_r_d = conv2_ref_neuro_deg - mu_r_mu_d;
 
-  auto intensity_numer = mu_r_mu_d * 2.0 + c1;
-  auto intensity_denom = ref_mu_sq + deg_mu_sq + c1;
-  auto intensity = intensity_numer.PointWiseDivide(intensity_denom);
+  // Combine the local statistics into the similarity map in a single pass.
+  // Evaluating the intensity and structure terms element by element avoids
+  // allocating a temporary matrix for every intermediate term, while keeping
+  // the order of the floating point operations unchanged.
+  AMatrix<double> sim_map(mu_r.NumRows(), mu_r.NumCols());
+  const double* mu_r_data = mu_r.data();
+  const double* mu_d_data = mu_d.data();
+  const double* conv2_ref_neuro_sq_data = conv2_ref_neuro_sq.data();
+  const double* conv2_deg_neuro_sq_data = conv2_deg_neuro_sq.data();
+  const double* conv2_ref_neuro_deg_data = conv2_ref_neuro_deg.data();
+  double* sim_map_data = sim_map.mutData();
+  const size_t num_elements = sim_map.NumElements();
+  for (size_t i = 0; i < num_elements; i++) {
+    const double ref_mu_sq = mu_r_data[i] * mu_r_data[i];
+    const double deg_mu_sq = mu_d_data[i] * mu_d_data[i];
+    const double mu_r_mu_d = mu_r_data[i] * mu_d_data[i];
+    const double sigma_r_sq = conv2_ref_neuro_sq_data[i] - ref_mu_sq;
+    const double sigma_d_sq = conv2_deg_neuro_sq_data[i] - deg_mu_sq;
+    const double sigma_r_d = conv2_ref_neuro_deg_data[i] - mu_r_mu_d;
+
+    const double intensity =
+        (mu_r_mu_d * 2.0 + c1) / (ref_mu_sq + deg_mu_sq + c1);
 
-  auto structure_numer = sigma_r_d + c3;
-  auto structure_denom = sigma_r_sq.PointWiseProduct(sigma_d_sq);
-  std::transform(structure_denom.begin(), structure_denom.end(),
-                 structure_denom.begin(),
-                 [&](decltype(*structure_denom.begin())& d) {
-                   // Avoid a nan is when stddev is negative.
-                   // This occasionally happens with silent patches,
-                   // which generate an epison negative value.
-                   return (d < 0.) ? c3 : (sqrt(d) + c3);
-                 });
-  auto structure = structure_numer.PointWiseDivide(structure_denom);
-  auto sim_map = intensity.PointWiseProduct(structure);
+    double structure_denom = sigma_r_sq * sigma_d_sq;
+    // Avoid a nan is when stddev is negative.
+    // This occasionally happens with silent patches,
+    // which generate an epison negative value.
+    structure_denom =
+        (structure_denom < 0.) ? c3 : (sqrt(structure_denom) + c3);
+    const double structure = (sigma_r_d + c3) / structure_denom;
+    sim_map_data[i] = intensity * structure;
+  }
 
   // These three matrices correspond to the similarity_result.proto fields
   // such as fvnsim.
@@ -0,0 +1,214 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace Visqol {
+
+const size_t Resampler::kNumZeroCrossings = 48;
+const double Resampler::kCutoff = 0.95;
+const double Resampler::kKaiserBeta = 10.0;
+const size_t Resampler::kMaxNumPhases = 512;
+
+namespace {
+
+// The zeroth order modified Bessel function of the first kind, from its power
+// series.
+double BesselI0(double x) {
+  double sum = 1.0;
+  double term = 1.0;
+  const double quarter_x_squared = x * x / 4.0;
+  for (int k = 1; term > sum * 1e-17; k++) {
+    term *= quarter_x_squared / (static_cast<double>(k) * k);
+    sum += term;
+  }
+  return sum;
+}
+
+// The filter phases for a rate conversion of L/M. Phase p of the L phases
+// holds the taps that compute an output sample p/L input samples after an
+// input sample.
+//
+// When L is large, as for nearly coprime rates, the table instead holds
+// kMaxNumPhases + 1 phases at offsets of 0, 1/kMaxNumPhases, ..., 1 input
+// samples, and the output is interpolated between the two nearest ones.
+struct PolyphaseFilter {
+  size_t upsample_factor;    // L
+  size_t downsample_factor;  // M
+  // The number of phases in the table, less the one at an offset of 1 input
+  // sample when interpolating.
+  size_t num_phases;
+  bool interpolate;
+  // The number of input samples before and after the output sample that
+  // contribute to it.
+  size_t half_length;
+  // The taps of each phase, applied to 2 * half_length consecutive input
+  // samples, stored one phase after another.
+  std::vector<double> taps;
+};
+
+PolyphaseFilter DesignFilter(size_t input_rate, size_t output_rate) {
+  PolyphaseFilter filter;
+  const size_t divisor = std::gcd(input_rate, output_rate);
+  filter.upsample_factor = output_rate / divisor;
+  filter.downsample_factor = input_rate / divisor;
+  filter.interpolate = filter.upsample_factor > Resampler::kMaxNumPhases;
+  filter.num_phases =
+      filter.interpolate ? Resampler::kMaxNumPhases : filter.upsample_factor;
+
+  // When downsampling, the cutoff is lowered to the output Nyquist frequency
+  // and the filter is stretched over proportionally more input samples.
+  const double cutoff =
+      Resampler::kCutoff *
+      std::min(1.0, static_cast<double>(filter.upsample_factor) /
+                        filter.downsample_factor);
+  const double half_width = Resampler::kNumZeroCrossings / cutoff;
+  filter.half_length = static_cast<size_t>(std::ceil(half_width));
+  const size_t num_taps = 2 * filter.half_length;
+
+  const double window_norm = BesselI0(Resampler::kKaiserBeta);
+  const size_t num_table_phases =
+      filter.interpolate ? filter.num_phases + 1 : filter.num_phases;
+  filter.taps.resize(num_table_phases * num_taps);
+  for (size_t phase = 0; phase < num_table_phases; phase++) {
+    double* phase_taps = &filter.taps[phase * num_taps];
+    const double offset = static_cast<double>(phase) / filter.num_phases;
+    double sum = 0.0;
+    for (size_t tap = 0; tap < num_taps; tap++) {
+      // The time of the output sample relative to the input sample.
+      const double t = offset + filter.half_length - 1.0 - tap;
+      double value = 0.0;
+      if (std::abs(t) < half_width) {
+        const double x = M_PI * cutoff * t;
+        const double sinc = (t == 0.0) ? 1.0 : std::sin(x) / x;
+        const double r = t / half_width;
+        value = cutoff * sinc *
+                BesselI0(Resampler::kKaiserBeta * std::sqrt(1.0 - r * r)) /
+                window_norm;
+      }
+      phase_taps[tap] = value;
+      sum += value;
+    }
+    // Normalise each phase to unit gain at DC, so that no phase adds ripple.
+    for (size_t tap = 0; tap < num_taps; tap++) {
+      phase_taps[tap] /= sum;
+    }
+  }
+  return filter;
+}
+
+// The dot product of two arrays. Four partial sums break the dependency
+// between consecutive additions, so that they can be pipelined and
+// vectorised without reassociating floating point arithmetic.
+double DotProduct(const double* h, const double* x, size_t n) {
+  double sum0 = 0.0;
+  double sum1 = 0.0;
+  double sum2 = 0.0;
+  double sum3 = 0.0;
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    sum0 += h[i] * x[i];
+    sum1 += h[i + 1] * x[i + 1];
+    sum2 += h[i + 2] * x[i + 2];
+    sum3 += h[i + 3] * x[i + 3];
+  }
+  for (; i < n; i++) {
+    sum0 += h[i] * x[i];
+  }
+  return (sum0 + sum1) + (sum2 + sum3);
+}
+
+// Resample a single channel. Input outside the signal is zero, so windows
+// that overlap an edge of the signal only read the taps inside it.
+void ResampleChannel(const PolyphaseFilter& filter, const double* input,
+                     size_t num_input, double* output, size_t num_output) {
+  const size_t num_taps = 2 * filter.half_length;
+  for (size_t out = 0; out < num_output; out++) {
+    const uint64_t position =
+        static_cast<uint64_t>(out) * filter.downsample_factor;
+    const uint64_t base = position / filter.upsample_factor;
+    const uint64_t remainder = position % filter.upsample_factor;
+    // The window starts half_length - 1 samples before the base sample.
+    const int64_t start = static_cast<int64_t>(base) -
+                          static_cast<int64_t>(filter.half_length) + 1;
+    const size_t first_tap = start < 0 ? static_cast<size_t>(-start) : 0;
+    const size_t end_tap = static_cast<size_t>(std::clamp<int64_t>(
+        static_cast<int64_t>(num_input) - start, 0,
+        static_cast<int64_t>(num_taps)));
+    if (first_tap >= end_tap) {
+      output[out] = 0.0;
+      continue;
+    }
+    const double* x = input + (start + static_cast<int64_t>(first_tap));
+    const size_t length = end_tap - first_tap;
+    if (!filter.interpolate) {
+      const double* h = &filter.taps[remainder * num_taps + first_tap];
+      output[out] = DotProduct(h, x, length);
+      continue;
+    }
+    // Interpolate between the table phases either side of the offset
+    // remainder / L.
+    const uint64_t scaled = remainder * filter.num_phases;
+    const uint64_t phase = scaled / filter.upsample_factor;
+    const double weight =
+        static_cast<double>(scaled % filter.upsample_factor) /
+        filter.upsample_factor;
+    const double* h = &filter.taps[phase * num_taps + first_tap];
+    const double below = DotProduct(h, x, length);
+    const double above = DotProduct(h + num_taps, x, length);
+    output[out] = below + weight * (above - below);
+  }
+}
+}  // namespace
+
+AudioSignal Resampler::Resample(const AudioSignal& signal,
+                                size_t output_rate) {
+  if (signal.sample_rate == output_rate) {
+    return signal;
+  }
+  AudioSignal resampled;
+  resampled.data_matrix =
+      Resample(signal.data_matrix, signal.sample_rate, output_rate);
+  resampled.sample_rate = output_rate;
+  return resampled;
+}
+
+AMatrix<double> Resampler::Resample(const AMatrix<double>& samples,
+                                    size_t input_rate, size_t output_rate) {
+  if (input_rate == output_rate || input_rate == 0 || output_rate == 0) {
+    return samples;
+  }
+  const PolyphaseFilter filter = DesignFilter(input_rate, output_rate);
+  const size_t num_input = samples.NumRows();
+  const size_t num_output =
+      (static_cast<uint64_t>(num_input) * filter.upsample_factor +
+       filter.downsample_factor - 1) /
+      filter.downsample_factor;
+
+  arma::Mat<double> resampled(num_output, samples.NumCols(), arma::fill::none);
+  for (size_t col = 0; col < samples.NumCols(); col++) {
+    ResampleChannel(filter, samples.MemPtr() + col * num_input, num_input,
+                    resampled.colptr(col), num_output);
+  }
+  return AMatrix<double>(std::move(resampled));
+}
+}  // namespace Visqol
@@ -0,0 +1,305 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "result_cache.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <cstring>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <system_error>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+
+namespace Visqol {
+
+namespace {
+// Temporary record files older than this are left over from interrupted
+// writes, and are removed when a cache is opened.
+const auto kStaleTemporaryAge = std::chrono::hours(1);
+
+// The subdirectory of the cache that temporary record files are written to.
+const char kTemporaryDir[] = "tmp";
+
+uint64_t ReadLittleEndian64(const char* bytes) {
+  const auto* data = reinterpret_cast<const unsigned char*>(bytes);
+  uint64_t value = 0;
+  for (int i = 7; i >= 0; i--) {
+    value = (value << 8) | data[i];
+  }
+  return value;
+}
+
+// A 128 bit hash that consumes two 64 bit words per step, built from the
+// xxHash64 round and avalanche functions. The digests identify audio content
+// across processes and hosts, so they must not depend on a per-process seed
+// or on the host byte order, and are wide enough that collisions between
+// different audio are not a practical concern.
+class ContentHash {
+ public:
+  void Update(const char* data, size_t size) {
+    total_size_ += size;
+    // Complete a block left partly filled by an earlier update.
+    if (pending_size_ > 0) {
+      const size_t fill = std::min(size, kBlockSize - pending_size_);
+      std::memcpy(pending_ + pending_size_, data, fill);
+      pending_size_ += fill;
+      data += fill;
+      size -= fill;
+      if (pending_size_ < kBlockSize) {
+        return;
+      }
+      MixBlock(pending_);
+      pending_size_ = 0;
+    }
+    for (; size >= kBlockSize; data += kBlockSize, size -= kBlockSize) {
+      MixBlock(data);
+    }
+    std::memcpy(pending_, data, size);
+    pending_size_ = size;
+  }
+
+  void Update(const std::string& str) { Update(str.data(), str.size()); }
+
+  std::string Hex() const {
+    // Mix in the zero padded final block and the length, so that inputs
+    // differing only in trailing zeros hash differently.
+    uint64_t low = low_;
+    uint64_t high = high_;
+    if (pending_size_ > 0) {
+      char block[kBlockSize] = {};
+      std::memcpy(block, pending_, pending_size_);
+      low = Round(low, ReadLittleEndian64(block));
+      high = Round(high, ReadLittleEndian64(block + 8));
+    }
+    low = Avalanche(low + RotateLeft(high, 23) + total_size_ * kPrime5);
+    high = Avalanche(high + RotateLeft(low, 41));
+
+    static const char kHexDigits[] = "0123456789abcdef";
+    std::string hex(32, '0');
+    for (int i = 0; i < 16; i++) {
+      hex[15 - i] = kHexDigits[(high >> (4 * i)) & 0xf];
+      hex[31 - i] = kHexDigits[(low >> (4 * i)) & 0xf];
+    }
+    return hex;
+  }
+
+ private:
+  static constexpr size_t kBlockSize = 16;
+  static constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+  static constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+  static constexpr uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+  static constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+  static uint64_t RotateLeft(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+  }
+
+  static uint64_t Round(uint64_t acc, uint64_t word) {
+    return RotateLeft(acc + word * kPrime2, 31) * kPrime1;
+  }
+
+  static uint64_t Avalanche(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= kPrime2;
+    hash ^= hash >> 29;
+    hash *= kPrime3;
+    hash ^= hash >> 32;
+    return hash;
+  }
+
+  void MixBlock(const char* block) {
+    low_ = Round(low_, ReadLittleEndian64(block));
+    high_ = Round(high_, ReadLittleEndian64(block + 8));
+  }
+
+  uint64_t low_ = kPrime1 + kPrime2;
+  uint64_t high_ = kPrime2 ^ kPrime5;
+  uint64_t total_size_ = 0;
+  char pending_[kBlockSize];
+  size_t pending_size_ = 0;
+};
+
+uint32_t ReadLittleEndian32(const char* bytes) {
+  const auto* data = reinterpret_cast<const unsigned char*>(bytes);
+  return static_cast<uint32_t>(data[0]) |
+         (static_cast<uint32_t>(data[1]) << 8) |
+         (static_cast<uint32_t>(data[2]) << 16) |
+         (static_cast<uint32_t>(data[3]) << 24);
+}
+}  // namespace
+
+absl::StatusOr<ResultCache> ResultCache::Open(
+    const FilePath& cache_dir, const std::string& configuration_key) {
+  const std::filesystem::path temp_dir =
+      std::filesystem::path(cache_dir.Path()) / kTemporaryDir;
+  std::error_code error;
+  std::filesystem::create_directories(temp_dir, error);
+  if (error) {
+    return absl::InternalError(absl::StrCat("Unable to create result cache ",
+                                            cache_dir.Path(), ": ",
+                                            error.message()));
+  }
+
+  // Remove the temporary files of writes that were interrupted. Recent ones
+  // may belong to a concurrent run that is still writing them.
+  const auto now = std::filesystem::file_time_type::clock::now();
+  for (std::filesystem::directory_iterator it(temp_dir, error), end;
+       !error && it != end; it.increment(error)) {
+    const auto write_time = it->last_write_time(error);
+    if (!error && now - write_time > kStaleTemporaryAge) {
+      std::filesystem::remove(it->path(), error);
+    }
+    error.clear();
+  }
+  return ResultCache(cache_dir, configuration_key);
+}
+
+ResultCache::ResultCache(const FilePath& cache_dir,
+                         const std::string& configuration_key)
+    : cache_dir_(cache_dir), configuration_key_(configuration_key) {}
+
+std::string ResultCache::MakeKey(absl::Span<const char> ref_contents,
+                                 absl::Span<const char> deg_contents) const {
+  ContentHash key;
+  key.Update(absl::StrCat(AudioDigest(ref_contents), "\n",
+                          AudioDigest(deg_contents), "\n",
+                          configuration_key_));
+  return key.Hex();
+}
+
+absl::optional<SimilarityResultMsg> ResultCache::Lookup(
+    const std::string& key) const {
+  std::ifstream file(RecordPath(key), std::ios_base::binary);
+  if (!file.is_open()) {
+    return absl::nullopt;
+  }
+  std::stringstream contents;
+  contents << file.rdbuf();
+  const std::string record = contents.str();
+
+  // The record starts with the configuration it was scored with, which guards
+  // against the unlikely case of two keys colliding.
+  const size_t header_size = configuration_key_.size() + 1;
+  if (record.size() < header_size ||
+      record.compare(0, configuration_key_.size(), configuration_key_) != 0 ||
+      record[configuration_key_.size()] != '\n') {
+    return absl::nullopt;
+  }
+  SimilarityResultMsg sim_res_msg;
+  if (!sim_res_msg.ParseFromArray(record.data() + header_size,
+                                  record.size() - header_size)) {
+    return absl::nullopt;
+  }
+  return sim_res_msg;
+}
+
+absl::Status ResultCache::Store(const std::string& key,
+                                const SimilarityResultMsg& sim_res_msg) const {
+  const std::filesystem::path record_path(RecordPath(key));
+  std::error_code error;
+  std::filesystem::create_directories(record_path.parent_path(), error);
+  if (error) {
+    return absl::InternalError(absl::StrCat(
+        "Unable to create result cache directory: ", error.message()));
+  }
+
+  // Write the record under a name unique to this writer and rename it into
+  // place, so that readers never see a partly written record.
+  thread_local std::mt19937_64 generator{std::random_device{}()};
+  const std::string temp_path = absl::StrCat(
+      cache_dir_.Path(), "/", kTemporaryDir, "/", key, ".", generator());
+  {
+    std::ofstream file(temp_path, std::ios_base::binary);
+    file << configuration_key_ << '\n';
+    sim_res_msg.SerializeToOstream(&file);
+    file.close();
+    if (file.fail()) {
+      std::filesystem::remove(temp_path, error);
+      return absl::InternalError(
+          absl::StrCat("Unable to write result cache record: ", temp_path));
+    }
+  }
+  std::filesystem::rename(temp_path, record_path, error);
+  if (error) {
+    std::filesystem::remove(temp_path, error);
+    return absl::InternalError(absl::StrCat(
+        "Unable to write result cache record: ", record_path.string()));
+  }
+  return absl::Status();
+}
+
+absl::StatusOr<std::unique_ptr<MappedFile>> ResultCache::MapAudioFile(
+    const FilePath& path) {
+  std::error_code error;
+  if (!std::filesystem::is_regular_file(path.Path(), error)) {
+    return absl::FailedPreconditionError(
+        absl::StrCat("Not a regular audio file: ", path.Path()));
+  }
+  return MappedFile::Open(path);
+}
+
+std::string ResultCache::AudioDigest(absl::Span<const char> contents) {
+  ContentHash digest;
+  const char* data = contents.data();
+  const size_t size = contents.size();
+  if (size < 12 || std::memcmp(data, "RIFF", 4) != 0 ||
+      std::memcmp(data + 8, "WAVE", 4) != 0) {
+    // Not a WAV file, so digest all of it.
+    digest.Update(data, size);
+    return digest.Hex();
+  }
+
+  size_t offset = 12;
+  while (size - offset >= 8) {
+    const char* chunk_header = data + offset;
+    const uint32_t chunk_size = ReadLittleEndian32(chunk_header + 4);
+    const size_t body_size = std::min<uint64_t>(chunk_size, size - offset - 8);
+    if (std::memcmp(chunk_header, "fmt ", 4) == 0 ||
+        std::memcmp(chunk_header, "data", 4) == 0) {
+      digest.Update(chunk_header, 4);
+      digest.Update(chunk_header + 8, body_size);
+    }
+    // Chunks are padded to an even size.
+    const uint64_t padded_size = uint64_t{chunk_size} + (chunk_size & 1);
+    if (padded_size > size - offset - 8) {
+      break;
+    }
+    offset += 8 + padded_size;
+  }
+  return digest.Hex();
+}
+
+std::string ResultCache::ContentDigest(absl::Span<const char> contents) {
+  ContentHash digest;
+  digest.Update(contents.data(), contents.size());
+  return digest.Hex();
+}
+
+std::string ResultCache::RecordPath(const std::string& key) const {
+  // Spread the records over subdirectories so that no directory grows too
+  // large.
+  return absl::StrCat(cache_dir_.Path(), "/", key.substr(0, 2), "/", key);
+}
+}  // namespace Visqol
@@ -0,0 +1,106 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "results_checkpoint.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <fstream>
+#include <string>
+#include <system_error>
+
+#include "absl/base/internal/raw_logging.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "manifest_reader.h"
+
+namespace Visqol {
+
+absl::StatusOr<ResultsCheckpoint> ResultsCheckpoint::Load(
+    const FilePath& results_csv) {
+  ResultsCheckpoint checkpoint;
+  if (!results_csv.Exists()) {
+    return checkpoint;
+  }
+
+  std::ifstream file(results_csv.Path(), std::ios_base::binary);
+  if (!file.is_open()) {
+    return absl::NotFoundError(
+        absl::StrCat("Unable to open results CSV: ", results_csv.Path()));
+  }
+
+  // Records are only complete once their newline has been written. Track the
+  // end of the last complete record so a partial record can be removed.
+  std::string line;
+  bool is_header = true;
+  std::streamoff complete_length = 0;
+  while (std::getline(file, line)) {
+    if (file.eof()) {
+      // The final line has no newline, so it was only partly written.
+      break;
+    }
+    complete_length += line.size() + 1;
+    if (is_header) {
+      is_header = false;
+      continue;
+    }
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    ReferenceDegradedPathPair pair;
+    if (!ManifestReader::ParseRow(line, &pair)) {
+      continue;
+    }
+    checkpoint.completed_[MakeKey(pair.reference.Path(),
+                                  pair.degraded.Path())]++;
+    checkpoint.num_completed_++;
+  }
+  file.close();
+
+  std::error_code error;
+  const auto file_size = std::filesystem::file_size(results_csv.Path(), error);
+  if (!error && file_size > static_cast<uintmax_t>(complete_length)) {
+    ABSL_RAW_LOG(WARNING,
+                 "Removing a partly written record from the end of %s.",
+                 results_csv.Path().c_str());
+    std::filesystem::resize_file(results_csv.Path(), complete_length, error);
+  }
+  if (error) {
+    return absl::InternalError(absl::StrCat("Unable to repair results CSV ",
+                                            results_csv.Path(), ": ",
+                                            error.message()));
+  }
+  return checkpoint;
+}
+
+bool ResultsCheckpoint::ConsumeIfCompleted(
+    const ReferenceDegradedPathPair& pair) {
+  auto it = completed_.find(MakeKey(pair.reference.Path(), pair.degraded.Path()));
+  if (it == completed_.end()) {
+    return false;
+  }
+  if (--it->second == 0) {
+    completed_.erase(it);
+  }
+  return true;
+}
+
+std::string ResultsCheckpoint::MakeKey(const std::string& reference,
+                                       const std::string& degraded) {
+  // Newlines cannot appear in a CSV record, so they separate the paths
+  // unambiguously.
+  return absl::StrCat(reference, "\n", degraded);
+}
+}  // namespace Visqol
@@ -0,0 +1,222 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "shard_merger.h"
+
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/internal/raw_logging.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "google/protobuf/util/json_util.h"
+#include "manifest_reader.h"
+#include "src/proto/similarity_result.pb.h"  // Generated by cc_proto_library rule
+
+namespace Visqol {
+
+namespace {
+// The number of missing pairs that are logged individually.
+const size_t kMaxMissingPairsLogged = 10;
+}  // namespace
+
+absl::Status ShardMerger::MergeResultsCSV(
+    const FilePath& manifest_path, const std::vector<FilePath>& shard_paths,
+    const FilePath& output_path) {
+  std::string header;
+  RecordsByPair records;
+  for (const FilePath& shard_path : shard_paths) {
+    std::ifstream file(shard_path.Path());
+    if (!file.is_open()) {
+      return absl::NotFoundError(
+          absl::StrCat("Unable to open shard results: ", shard_path.Path()));
+    }
+
+    std::string line;
+    bool is_header = true;
+    while (std::getline(file, line)) {
+      if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+      }
+      if (is_header) {
+        is_header = false;
+        if (header.empty()) {
+          header = line;
+        } else if (line != header) {
+          return absl::InvalidArgumentError(absl::StrCat(
+              "The header of ", shard_path.Path(),
+              " does not match the header of the other shards."));
+        }
+        continue;
+      }
+      ReferenceDegradedPathPair pair;
+      if (!ManifestReader::ParseRow(line, &pair)) {
+        continue;
+      }
+      records[MakeKey(pair.reference.Path(), pair.degraded.Path())].push_back(
+          line);
+    }
+  }
+
+  return WriteInManifestOrder(manifest_path,
+                              header.empty() ? "" : header + "\n", "\n",
+                              &records, output_path);
+}
+
+absl::Status ShardMerger::MergeDebugJSON(
+    const FilePath& manifest_path, const std::vector<FilePath>& shard_paths,
+    const FilePath& output_path) {
+  RecordsByPair records;
+  for (const FilePath& shard_path : shard_paths) {
+    std::ifstream file(shard_path.Path());
+    if (!file.is_open()) {
+      return absl::NotFoundError(
+          absl::StrCat("Unable to open shard debug output: ", shard_path.Path()));
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+
+    auto objects_statusor = SplitJsonObjects(contents.str());
+    if (!objects_statusor.ok()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unable to parse ", shard_path.Path(), ": ",
+                       objects_statusor.status().message()));
+    }
+    for (std::string& object : objects_statusor.value()) {
+      SimilarityResultMsg sim_res_msg;
+      if (!google::protobuf::util::JsonStringToMessage(object, &sim_res_msg)
+               .ok()) {
+        return absl::InvalidArgumentError(absl::StrCat(
+            "Unable to parse a result in ", shard_path.Path()));
+      }
+      records[MakeKey(sim_res_msg.reference_filepath(),
+                      sim_res_msg.degraded_filepath())]
+          .push_back(std::move(object));
+    }
+  }
+
+  return WriteInManifestOrder(manifest_path, "", "", &records, output_path);
+}
+
+absl::StatusOr<std::vector<std::string>> ShardMerger::SplitJsonObjects(
+    const std::string& text) {
+  std::vector<std::string> objects;
+  size_t depth = 0;
+  size_t object_start = 0;
+  bool in_string = false;
+  bool escaped = false;
+  for (size_t i = 0; i < text.size(); i++) {
+    const char c = text[i];
+    if (in_string) {
+      if (escaped) {
+        escaped = false;
+      } else if (c == '\\') {
+        escaped = true;
+      } else if (c == '"') {
+        in_string = false;
+      }
+      continue;
+    }
+
+    if (c == '"') {
+      in_string = true;
+    } else if (c == '{') {
+      if (depth == 0) {
+        object_start = i;
+      }
+      depth++;
+    } else if (c == '}') {
+      if (depth == 0) {
+        return absl::InvalidArgumentError("Unmatched '}'.");
+      }
+      depth--;
+      if (depth == 0) {
+        objects.push_back(text.substr(object_start, i - object_start + 1));
+      }
+    } else if (depth == 0 && !std::isspace(static_cast<unsigned char>(c))) {
+      return absl::InvalidArgumentError("Unexpected text between objects.");
+    }
+  }
+  if (depth != 0 || in_string) {
+    return absl::InvalidArgumentError("The final object is incomplete.");
+  }
+  return objects;
+}
+
+std::string ShardMerger::MakeKey(const std::string& reference,
+                                 const std::string& degraded) {
+  // Newlines cannot appear in a CSV record, so they separate the paths
+  // unambiguously.
+  return absl::StrCat(reference, "\n", degraded);
+}
+
+absl::Status ShardMerger::WriteInManifestOrder(const FilePath& manifest_path,
+                                               const std::string& header,
+                                               const std::string& separator,
+                                               RecordsByPair* records,
+                                               const FilePath& output_path) {
+  auto reader_statusor = ManifestReader::Open(manifest_path);
+  if (!reader_statusor.ok()) {
+    return reader_statusor.status();
+  }
+  std::ofstream output(output_path.Path(), std::ios_base::trunc);
+  if (!output.is_open()) {
+    return absl::PermissionDeniedError(
+        absl::StrCat("Unable to open output file: ", output_path.Path()));
+  }
+  output << header;
+
+  size_t num_missing = 0;
+  ReferenceDegradedPathPair pair;
+  while (reader_statusor.value()->Next(&pair)) {
+    auto it = records->find(MakeKey(pair.reference.Path(), pair.degraded.Path()));
+    if (it == records->end()) {
+      if (num_missing < kMaxMissingPairsLogged) {
+        ABSL_RAW_LOG(ERROR, "No result for %s, %s.",
+                     pair.reference.Path().c_str(),
+                     pair.degraded.Path().c_str());
+      }
+      num_missing++;
+      continue;
+    }
+    output << it->second.front() << separator;
+    it->second.pop_front();
+    if (it->second.empty()) {
+      records->erase(it);
+    }
+  }
+  output.close();
+
+  size_t num_unused = 0;
+  for (const auto& pair_records : *records) {
+    num_unused += pair_records.second.size();
+  }
+  if (num_unused > 0) {
+    ABSL_RAW_LOG(WARNING,
+                 "%zu shard results do not match a pair in the manifest and "
+                 "were not written.",
+                 num_unused);
+  }
+  if (num_missing > 0) {
+    return absl::NotFoundError(absl::StrCat(
+        num_missing, " pairs in the manifest have no result in the shards."));
+  }
+  return absl::Status();
+}
+}  // namespace Visqol
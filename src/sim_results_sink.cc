@@ -0,0 +1,185 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sim_results_sink.h"
+
+#include <filesystem>  // NOLINT(build/c++17)
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include "absl/base/internal/raw_logging.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "google/protobuf/util/json_util.h"
+#include "sim_results_writer.h"
+
+namespace Visqol {
+
+const size_t SimilarityResultsSink::kDefaultMaxPendingResults = 256;
+const size_t SimilarityResultsSink::kFlushThresholdBytes = 1 << 16;
+const absl::Duration SimilarityResultsSink::kFlushInterval = absl::Seconds(5);
+
+SimilarityResultsSink::SimilarityResultsSink(
+    bool verbose, const FilePath& results_output_csv,
+    const FilePath& debug_output_path, bool use_speech_mode, bool use_lattice,
+    size_t max_pending_results, absl::Duration flush_interval)
+    : verbose_(verbose),
+      use_speech_mode_(use_speech_mode),
+      use_lattice_(use_lattice),
+      max_pending_results_(max_pending_results),
+      flush_interval_(flush_interval),
+      write_csv_header_(false),
+      last_flush_(absl::Now()) {
+  if (!results_output_csv.Path().empty()) {
+    // If this file does not already exist or is empty, we need to write the
+    // header.
+    std::error_code error;
+    write_csv_header_ =
+        !results_output_csv.Exists() ||
+        std::filesystem::file_size(results_output_csv.Path(), error) == 0;
+    csv_file_.open(results_output_csv.Path(), std::ios_base::app);
+    if (!csv_file_.is_open()) {
+      ABSL_RAW_LOG(ERROR, "Unable to open results CSV: %s",
+                   results_output_csv.Path().c_str());
+    }
+  }
+  if (!debug_output_path.Path().empty()) {
+    debug_file_.open(debug_output_path.Path(), std::ios_base::app);
+    if (!debug_file_.is_open()) {
+      ABSL_RAW_LOG(ERROR, "Unable to open debug output: %s",
+                   debug_output_path.Path().c_str());
+    }
+  }
+  flush_thread_ = std::thread([this]() { FlushLoop(); });
+}
+
+SimilarityResultsSink::~SimilarityResultsSink() {
+  {
+    absl::MutexLock lock(&mutex_);
+    stopped_ = true;
+  }
+  flush_thread_.join();
+
+  absl::MutexLock lock(&mutex_);
+  if (!pending_.empty()) {
+    ABSL_RAW_LOG(WARNING,
+                 "%zu results were never written because an earlier result "
+                 "was not submitted.",
+                 pending_.size());
+  }
+  FlushLocked();
+}
+
+void SimilarityResultsSink::Submit(size_t index,
+                                   const SimilarityResultMsg& sim_res_msg) {
+  Enqueue(index, sim_res_msg);
+}
+
+void SimilarityResultsSink::Skip(size_t index) {
+  Enqueue(index, absl::nullopt);
+}
+
+void SimilarityResultsSink::Flush() {
+  absl::MutexLock lock(&mutex_);
+  FlushLocked();
+}
+
+void SimilarityResultsSink::FlushLoop() {
+  absl::MutexLock lock(&mutex_);
+  while (!stopped_) {
+    // Sleep until the buffers are due to be written or the sink is destroyed.
+    // Any flush in the meantime moves the deadline on.
+    mutex_.AwaitWithDeadline(absl::Condition(&stopped_),
+                             last_flush_ + flush_interval_);
+    if (!stopped_ && absl::Now() - last_flush_ >= flush_interval_) {
+      FlushLocked();
+    }
+  }
+}
+
+void SimilarityResultsSink::Enqueue(
+    size_t index, absl::optional<SimilarityResultMsg> sim_res_msg) {
+  absl::MutexLock lock(&mutex_);
+  // Bound the reorder buffer by waiting for the earlier results. The result
+  // at next_index_ is never blocked, so this always makes progress as long as
+  // every earlier index is eventually submitted.
+  auto within_bound = [this, index]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return index < next_index_ + max_pending_results_;
+  };
+  mutex_.Await(absl::Condition(&within_bound));
+
+  if (index < next_index_ || pending_.count(index) > 0) {
+    ABSL_RAW_LOG(ERROR, "Result %zu was submitted more than once.", index);
+    return;
+  }
+  pending_.emplace(index, std::move(sim_res_msg));
+  WritePendingInOrder();
+}
+
+void SimilarityResultsSink::WritePendingInOrder() {
+  auto it = pending_.begin();
+  while (it != pending_.end() && it->first == next_index_) {
+    if (it->second.has_value()) {
+      BufferResult(it->second.value());
+    }
+    it = pending_.erase(it);
+    next_index_++;
+  }
+
+  if (csv_buffer_.size() + debug_buffer_.size() >= kFlushThresholdBytes) {
+    FlushLocked();
+  }
+}
+
+void SimilarityResultsSink::BufferResult(
+    const SimilarityResultMsg& sim_res_msg) {
+  SimilarityResultsWriter::WriteToConsole(sim_res_msg, verbose_,
+                                          use_speech_mode_, use_lattice_);
+
+  if (debug_file_.is_open()) {
+    std::string debug_json;
+    if (google::protobuf::util::MessageToJsonString(sim_res_msg, &debug_json)
+            .ok()) {
+      debug_buffer_ += debug_json;
+    } else {
+      ABSL_RAW_LOG(ERROR, "Error writing debug JSON: %s ",
+                   sim_res_msg.ShortDebugString().c_str());
+    }
+  }
+
+  if (csv_file_.is_open()) {
+    if (write_csv_header_) {
+      csv_buffer_ += SimilarityResultsWriter::FormatCSVHeader(sim_res_msg);
+      write_csv_header_ = false;
+    }
+    csv_buffer_ += SimilarityResultsWriter::FormatCSVRow(sim_res_msg);
+  }
+}
+
+void SimilarityResultsSink::FlushLocked() {
+  if (csv_file_.is_open() && !csv_buffer_.empty()) {
+    csv_file_ << csv_buffer_;
+    csv_file_.flush();
+    csv_buffer_.clear();
+  }
+  if (debug_file_.is_open() && !debug_buffer_.empty()) {
+    debug_file_ << debug_buffer_;
+    debug_file_.flush();
+    debug_buffer_.clear();
+  }
+  last_flush_ = absl::Now();
+}
+}  // namespace Visqol
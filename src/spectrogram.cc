@@ -52,23 +52,25 @@ void Spectrogram::RaiseFloorPerFrame(double noise_threshold,
   // 'Silent' ambient noise frames are typically in the -1000dB to -25dB range.
   // This means most of the action is at the -25 to -10dB range.
   size_t min_cols = std::min(data_.NumCols(), other.data_.NumCols());
+  const size_t our_num_bands = data_.NumRows();
+  const size_t other_num_bands = other.data_.NumRows();
   for (size_t i = 0; i < min_cols; i++) {
-    auto our_frame = data_.GetColumn(i);
-    auto other_frame = other.data_.GetColumn(i);
+    // Each frame is contiguous, so it is updated in place.
+    auto our_frame = data_.begin() + i * our_num_bands;
+    auto our_frame_end = our_frame + our_num_bands;
+    auto other_frame = other.data_.begin() + i * other_num_bands;
+    auto other_frame_end = other_frame + other_num_bands;
     // Find the max value per frame.
-    double our_max = *std::max_element(our_frame.cbegin(), our_frame.cend());
-    double other_max =
-        *std::max_element(other_frame.cbegin(), other_frame.cend());
+    double our_max = *std::max_element(our_frame, our_frame_end);
+    double other_max = *std::max_element(other_frame, other_frame_end);
     double any_max = std::max(our_max, other_max);
     double floor_db = any_max - noise_threshold;
 
     // Raise the floor by some amount under the max.
-    std::transform(our_frame.begin(), our_frame.end(), our_frame.begin(),
+    std::transform(our_frame, our_frame_end, our_frame,
                    [&](double d) { return std::max(floor_db, d); });
-    std::transform(other_frame.begin(), other_frame.end(), other_frame.begin(),
+    std::transform(other_frame, other_frame_end, other_frame,
                    [&](double d) { return std::max(floor_db, d); });
-    data_.SetColumn(i, std::move(our_frame));
-    other.data_.SetColumn(i, std::move(other_frame));
   }
 }
 
@@ -82,6 +82,7 @@ double TFLiteQualityMapper::PredictQuality(
     const std::vector<double>& fvnsim10_vector,
     const std::vector<double>& fstdnsim_vector,
     const std::vector<double>& fvdegenergy_vector) const {
+  absl::MutexLock lock(&predict_mutex_);
   tflite::SignatureRunner* predict_runner =
       interpreter_->GetSignatureRunner("predict");
 
@@ -34,17 +34,28 @@
 
 namespace Visqol {
 absl::StatusOr<SimilarityResult> Visqol::CalculateSimilarity(
-    const AudioSignal& ref_signal, AudioSignal& deg_signal,
+    const AudioSignal& ref_signal, const AudioSignalView& deg_signal,
     SpectrogramBuilder* spect_builder, const AnalysisWindow& window,
     const ImagePatchCreator* patch_creator,
     const ComparisonPatchesSelector* comparison_patches_selector,
     const SimilarityToQualityMapper* sim_to_qual_mapper,
     const int search_window,
     const bool disable_realignment) const {
-  /////////////////// Stage 1: Preprocessing ///////////////////
-  deg_signal =
-      MiscAudio::ScaleToMatchSoundPressureLevel(ref_signal, deg_signal);
+  const auto reference_result =
+      PrepareReference(ref_signal, spect_builder, window, patch_creator);
+  if (!reference_result.ok()) {
+    return reference_result.status();
+  }
+  return CalculateSimilarity(reference_result.value(), deg_signal,
+                             spect_builder, window, patch_creator,
+                             comparison_patches_selector, sim_to_qual_mapper,
+                             search_window, disable_realignment);
+}
 
+absl::StatusOr<PreparedReference> Visqol::PrepareReference(
+    const AudioSignal& ref_signal, SpectrogramBuilder* spect_builder,
+    const AnalysisWindow& window,
+    const ImagePatchCreator* patch_creator) const {
   // build the reference spectrogram.
   const auto ref_spectro_result = spect_builder->Build(ref_signal, window);
   if (!ref_spectro_result.ok()) {
@@ -53,27 +64,55 @@ absl::StatusOr<SimilarityResult> Visqol::CalculateSimilarity(
     return ref_spectro_result.status();
   }
 
+  PreparedReference reference;
+  reference.signal = ref_signal;
+  reference.spectrogram = ref_spectro_result.value();
+  MiscAudio::PrepareSpectrogramForComparison(reference.spectrogram);
+
+  auto ref_patch_result = patch_creator->CreateRefPatchIndices(
+      reference.spectrogram.Data(), ref_signal, window);
+  if (!ref_patch_result.ok()) {
+    ABSL_RAW_LOG(ERROR, "Error creating reference patch indices: %s",
+                 ref_patch_result.status().ToString().c_str());
+    return ref_patch_result.status();
+  }
+  reference.patch_indices = std::move(ref_patch_result.value());
+  return reference;
+}
+
+absl::StatusOr<SimilarityResult> Visqol::CalculateSimilarity(
+    const PreparedReference& reference, const AudioSignalView& deg_signal,
+    SpectrogramBuilder* spect_builder, const AnalysisWindow& window,
+    const ImagePatchCreator* patch_creator,
+    const ComparisonPatchesSelector* comparison_patches_selector,
+    const SimilarityToQualityMapper* sim_to_qual_mapper,
+    const int search_window,
+    const bool disable_realignment) const {
+  const AudioSignal& ref_signal = reference.signal;
+
+  /////////////////// Stage 1: Preprocessing ///////////////////
+  // The gain is applied as the samples are read, without scaling a copy.
+  const AudioSignalView scaled_deg_signal =
+      MiscAudio::ScaleToMatchSoundPressureLevel(ref_signal, deg_signal);
+
   // build the degraded spectrogram.
-  const auto deg_spectro_result = spect_builder->Build(deg_signal, window);
+  const auto deg_spectro_result =
+      spect_builder->Build(scaled_deg_signal, window);
   if (!deg_spectro_result.ok()) {
     ABSL_RAW_LOG(ERROR, "Error building degraded spectrogram: %s",
                  deg_spectro_result.status().ToString().c_str());
     return deg_spectro_result.status();
   }
 
-  Spectrogram ref_spectrogram = ref_spectro_result.value();
+  // The per-frame noise floor depends on both signals, so it is applied to a
+  // copy of the prepared reference spectrogram.
+  Spectrogram ref_spectrogram = reference.spectrogram;
   Spectrogram deg_spectrogram = deg_spectro_result.value();
-  MiscAudio::PrepareSpectrogramsForComparison(ref_spectrogram, deg_spectrogram);
+  MiscAudio::PrepareSpectrogramForComparison(deg_spectrogram);
+  MiscAudio::ApplyCommonNoiseFloor(ref_spectrogram, deg_spectrogram);
 
   /////////////// Stage 2: Feature selection and similarity measure ////////////
-  auto ref_patch_result = patch_creator->CreateRefPatchIndices(
-      ref_spectrogram.Data(), ref_signal, window);
-  if (!ref_patch_result.ok()) {
-    ABSL_RAW_LOG(ERROR, "Error creating reference patch indices: %s",
-                 ref_patch_result.status().ToString().c_str());
-    return ref_patch_result.status();
-  }
-  auto ref_patch_indices = ref_patch_result.value();
+  const std::vector<size_t>& ref_patch_indices = reference.patch_indices;
   const double frame_duration =
       CalcFrameDuration(window.size * window.overlap, ref_signal.sample_rate);
 
@@ -95,7 +134,8 @@ absl::StatusOr<SimilarityResult> Visqol::CalculateSimilarity(
   } else {
     auto realign_result =
         comparison_patches_selector->FinelyAlignAndRecreatePatches(
-            sim_match_info, ref_signal, deg_signal, spect_builder, window);
+            sim_match_info, ref_signal, scaled_deg_signal, spect_builder,
+            window);
     if (!realign_result.ok()) {
       return realign_result.status();
     }
@@ -178,7 +218,8 @@ AMatrix<double> Visqol::CalcPerPatchMeanFreqBandMeans(
       fvnsim(band) += patch.freq_band_means(band);
     }
   }
-  return fvnsim / sim_match_info.size();
+  fvnsim /= sim_match_info.size();
+  return fvnsim;
 }
 
 AMatrix<double> Visqol::CalcPerPatchMeanFreqBandDegradedEnergy(
@@ -193,7 +234,8 @@ AMatrix<double> Visqol::CalcPerPatchMeanFreqBandDegradedEnergy(
       total_fvdegenergy(band) += patch.freq_band_deg_energy(band);
     }
   }
-  return total_fvdegenergy / sim_match_info.size();
+  total_fvdegenergy /= sim_match_info.size();
+  return total_fvdegenergy;
 }
 
 AMatrix<double> Visqol::CalcPerPatchMeanFreqBandStdDevs(
@@ -209,7 +251,7 @@ AMatrix<double> Visqol::CalcPerPatchMeanFreqBandStdDevs(
       fvnsim(band) += patch.freq_band_means(band);
     }
   }
-  fvnsim = fvnsim / sim_match_info.size();
+  fvnsim /= sim_match_info.size();
 
   // Now that we have the global mean, we can compute the combined
   // variance/stddev.
@@ -230,9 +272,11 @@ AMatrix<double> Visqol::CalcPerPatchMeanFreqBandStdDevs(
     }
   }
 
-  AMatrix<double> result =
-      ((contribution - (fvnsim.PointWiseProduct(fvnsim) * total_frame_count)) /
-       (total_frame_count - 1));
+  // Reuse the contribution storage for the result, and subtract the squared
+  // global means in the same pass as they are computed.
+  AMatrix<double> result = std::move(contribution);
+  result.MultiplyAdd(fvnsim, fvnsim, -total_frame_count);
+  result /= total_frame_count - 1;
   // Square root is not defined for AMatrix, so we can't include it as above.
   // Instead, use a transform on the elements. Also, filter out negative numbers
   // due to precision issues that would cause NaNs.
@@ -14,6 +14,7 @@
 
 #include "visqol_api.h"
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -21,6 +22,7 @@
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "commandline_parser.h"
+#include "misc_audio.h"
 #include "similarity_result.h"
 #include "src/proto/similarity_result.pb.h"  // Generated by cc_proto_library rule
 #include "src/proto/visqol_config.pb.h"  // Generated by cc_proto_library rule
@@ -55,6 +57,7 @@ absl::Status VisqolApi::Create(const VisqolConfig config) {
   bool allow_sr_override = false;
   int search_window = 60;
   bool use_lattice_model = true;
+  bool resample_input = false;
 
   std::string model_file;
   if (config.has_options()) {
@@ -63,6 +66,7 @@ absl::Status VisqolApi::Create(const VisqolConfig config) {
     unscaled_speech_map = config_options.use_unscaled_speech_mos_mapping();
     allow_sr_override = config_options.allow_unsupported_sample_rates();
     use_lattice_model = config_options.use_lattice_model();
+    resample_input = config_options.resample_input();
     model_file = config_options.svr_model_path();
     if (config_options.search_window_radius()) {
       search_window = config_options.search_window_radius();
@@ -83,7 +87,7 @@ absl::Status VisqolApi::Create(const VisqolConfig config) {
   // visqolaudio works). It seems like if we did this for Visqol we could
   // support arbitrary sample rates.
   if (sample_rate_ != k48kSampleRate && speech_mode == false &&
-      allow_sr_override == false) {
+      allow_sr_override == false && resample_input == false) {
     return absl::Status(
         absl::StatusCode::kInvalidArgument,
         "Currently, 48k is the only sample rate supported by ViSQOL Audio. "
@@ -91,9 +95,11 @@ absl::Status VisqolApi::Create(const VisqolConfig config) {
   }
 
   // Initialize ViSQOL with the model file.
-  VISQOL_RETURN_IF_ERROR(visqol_.Init(FilePath(model_file), speech_mode,
-                                      unscaled_speech_map, search_window,
-                                      use_lattice_model));
+  VISQOL_RETURN_IF_ERROR(visqol_.Init(
+      FilePath(model_file), speech_mode, unscaled_speech_map, search_window,
+      use_lattice_model, /*disable_global_alignment=*/false,
+      /*disable_realignment=*/false, /*bounded_realignment=*/false,
+      resample_input));
 
   return absl::Status();
 }
@@ -109,4 +115,22 @@ absl::StatusOr<SimilarityResultMsg> VisqolApi::Measure(
   return sim_result_msg;
 }
 
+absl::StatusOr<SimilarityResultMsg> VisqolApi::MeasureInterleaved(
+    absl::Span<const int16_t> reference, absl::Span<const int16_t> degraded,
+    size_t num_channels) {
+  if (num_channels == 0 || reference.size() % num_channels != 0 ||
+      degraded.size() % num_channels != 0) {
+    return absl::Status(
+        absl::StatusCode::kInvalidArgument,
+        "The interleaved signals must hold a whole number of frames.");
+  }
+  std::vector<double> ref_mono(reference.size() / num_channels);
+  std::vector<double> deg_mono(degraded.size() / num_channels);
+  MiscAudio::InterleavedToMono(reference, num_channels,
+                               absl::MakeSpan(ref_mono));
+  MiscAudio::InterleavedToMono(degraded, num_channels,
+                               absl::MakeSpan(deg_mono));
+  return Measure(absl::MakeSpan(ref_mono), absl::MakeSpan(deg_mono));
+}
+
 }  // namespace Visqol
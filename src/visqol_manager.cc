@@ -16,6 +16,8 @@
 
 #include <memory>
 #include <string>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #include "absl/base/internal/raw_logging.h"
@@ -26,9 +28,17 @@
 #include "alignment.h"
 #include "analysis_window.h"
 #include "audio_signal.h"
+#include "audio_signal_view.h"
+#include "conformance.h"
+#include "envelope.h"
 #include "gammatone_filterbank.h"
+#include "mapped_file.h"
+#include "matrix_arena.h"
 #include "misc_audio.h"
+#include "multirate_gammatone_spectrogram_builder.h"
 #include "neurogram_similiarity_index_measure.h"
+#include "resampler.h"
+#include "result_cache.h"
 #include "similarity_result.h"
 #include "speech_similarity_to_quality_mapper.h"
 #include "src/proto/similarity_result.pb.h"  // Generated by cc_proto_library rule
@@ -52,13 +62,20 @@ const double VisqolManager::kDurationMismatchTolerance = 1.0;
 absl::Status VisqolManager::Init(
     const FilePath& similarity_to_quality_mapper_model, bool use_speech_mode,
     bool use_unscaled_speech, int search_window, bool use_lattice_model,
-    bool disable_global_alignment, bool disable_realignment) {
+    bool disable_global_alignment, bool disable_realignment,
+    bool bounded_realignment, bool resample_input, bool multirate_filterbank,
+    absl::optional<WavReader::PcmFormat> raw_pcm_format) {
+  model_path_ = similarity_to_quality_mapper_model;
   use_speech_mode_ = use_speech_mode;
   use_unscaled_speech_mos_mapping_ = use_unscaled_speech;
   search_window_ = search_window;
   use_lattice_model_ = use_lattice_model;
   disable_global_alignment_ = disable_global_alignment;
   disable_realignment_ = disable_realignment;
+  bounded_realignment_ = bounded_realignment;
+  resample_input_ = resample_input;
+  multirate_filterbank_ = multirate_filterbank;
+  raw_pcm_format_ = raw_pcm_format;
 
   InitPatchCreator();
   InitPatchSelector();
@@ -79,11 +96,69 @@ absl::Status VisqolManager::Init(
     absl::string_view similarity_to_quality_mapper_model_string,
     bool use_speech_mode, bool use_unscaled_speech, int search_window,
     bool use_lattice_model, bool disable_global_alignment,
-    bool disable_realignment) {
+    bool disable_realignment, bool bounded_realignment, bool resample_input,
+    bool multirate_filterbank,
+    absl::optional<WavReader::PcmFormat> raw_pcm_format) {
   return Init(FilePath(similarity_to_quality_mapper_model_string),
               use_speech_mode, use_unscaled_speech, search_window,
               use_lattice_model, disable_global_alignment,
-              disable_realignment);
+              disable_realignment, bounded_realignment, resample_input,
+              multirate_filterbank, raw_pcm_format);
+}
+
+absl::StatusOr<std::unique_ptr<VisqolManager>> VisqolManager::Clone() const {
+  VISQOL_RETURN_IF_ERROR(ErrorIfNotInitialized());
+
+  auto clone = std::make_unique<VisqolManager>();
+  clone->model_path_ = model_path_;
+  clone->use_speech_mode_ = use_speech_mode_;
+  clone->use_lattice_model_ = use_lattice_model_;
+  clone->use_unscaled_speech_mos_mapping_ = use_unscaled_speech_mos_mapping_;
+  clone->search_window_ = search_window_;
+  clone->disable_global_alignment_ = disable_global_alignment_;
+  clone->disable_realignment_ = disable_realignment_;
+  clone->bounded_realignment_ = bounded_realignment_;
+  clone->resample_input_ = resample_input_;
+  clone->multirate_filterbank_ = multirate_filterbank_;
+  clone->raw_pcm_format_ = raw_pcm_format_;
+  clone->input_archive_ = input_archive_;
+
+  clone->InitPatchCreator();
+  clone->InitPatchSelector();
+  clone->InitSpectrogramBuilder();
+  clone->sim_to_qual_ = sim_to_qual_;
+  clone->is_initialized_ = true;
+  return clone;
+}
+
+absl::StatusOr<std::string> VisqolManager::ConfigurationKey() const {
+  VISQOL_RETURN_IF_ERROR(ErrorIfNotInitialized());
+  // The same bytes decode to different audio in a different raw format.
+  std::string raw_pcm_key;
+  if (raw_pcm_format_.has_value()) {
+    raw_pcm_key = absl::StrCat(
+        ";raw_pcm=", raw_pcm_format_->sample_rate_hz, "/",
+        raw_pcm_format_->num_channels, "/",
+        static_cast<int>(raw_pcm_format_->sample_format));
+  }
+  // Identify the model by its content, so that a model retrained in place
+  // does not match results scored with the old one. Speech mode without a
+  // lattice model reads no model file, so then the path is used.
+  std::string model_key = model_path_.Path();
+  const auto model_file = MappedFile::Open(model_path_);
+  if (model_file.ok()) {
+    model_key = ResultCache::ContentDigest(model_file.value()->Contents());
+  }
+  return absl::StrCat(
+      "conformance=", kVisqolConformanceNumber, ";model=", model_key,
+      ";speech=", use_speech_mode_, ";unscaled_speech=",
+      use_unscaled_speech_mos_mapping_, ";search_window=", search_window_,
+      ";lattice=", use_lattice_model_, ";global_alignment=",
+      !disable_global_alignment_, ";realignment=", !disable_realignment_,
+      ";bounded_realignment=", bounded_realignment_,
+      // Only added when set, so that existing keys are unchanged.
+      resample_input_ ? ";resample_input=1" : "",
+      multirate_filterbank_ ? ";multirate_filterbank=1" : "", raw_pcm_key);
 }
 
 void VisqolManager::InitPatchCreator() {
@@ -97,16 +172,21 @@ void VisqolManager::InitPatchCreator() {
 void VisqolManager::InitPatchSelector() {
   // Setup the patch similarity comparator to use the Neurogram.
   patch_selector_ = std::make_unique<ComparisonPatchesSelector>(
-      std::make_unique<NeurogramSimiliarityIndexMeasure>());
+      std::make_unique<NeurogramSimiliarityIndexMeasure>(),
+      bounded_realignment_);
 }
 
 void VisqolManager::InitSpectrogramBuilder() {
-  if (use_speech_mode_) {
-    spectrogram_builder_ = std::make_unique<GammatoneSpectrogramBuilder>(
-        GammatoneFilterBank{kNumBandsSpeech, kMinimumFreq}, true);
+  const GammatoneFilterBank filter_bank =
+      use_speech_mode_ ? GammatoneFilterBank{kNumBandsSpeech, kMinimumFreq}
+                       : GammatoneFilterBank{kNumBandsAudio, kMinimumFreq};
+  if (multirate_filterbank_) {
+    spectrogram_builder_ =
+        std::make_unique<MultirateGammatoneSpectrogramBuilder>(
+            filter_bank, use_speech_mode_);
   } else {
     spectrogram_builder_ = std::make_unique<GammatoneSpectrogramBuilder>(
-        GammatoneFilterBank{kNumBandsAudio, kMinimumFreq}, false);
+        filter_bank, use_speech_mode_);
   }
 }
 
@@ -134,14 +214,45 @@ absl::Status VisqolManager::InitSimilarityToQualityMapper(
   return sim_to_qual_->Init();
 }
 
+void VisqolManager::SetInputArchive(
+    std::shared_ptr<const AudioArchive> archive) {
+  input_archive_ = std::move(archive);
+}
+
+AudioSignal VisqolManager::LoadSignal(const FilePath& path) const {
+  if (input_archive_ != nullptr) {
+    const auto member = input_archive_->Find(path.Path());
+    if (!member.has_value()) {
+      ABSL_RAW_LOG(ERROR, "Could not find archive member %s.",
+                   path.Path().c_str());
+      return AudioSignal();
+    }
+    return LoadSignal(member.value(), path);
+  }
+  if (raw_pcm_format_.has_value()) {
+    return MiscAudio::LoadRawPcmAsMono(path, raw_pcm_format_.value());
+  }
+  return MiscAudio::LoadAsMono(path);
+}
+
+AudioSignal VisqolManager::LoadSignal(absl::Span<const char> contents,
+                                      const FilePath& path) const {
+  if (raw_pcm_format_.has_value()) {
+    return MiscAudio::LoadRawPcmAsMono(contents, raw_pcm_format_.value(),
+                                       path.Path());
+  }
+  return MiscAudio::LoadAsMono(contents, path.Path());
+}
+
 absl::StatusOr<SimilarityResultMsg> VisqolManager::Run(
     const FilePath& ref_signal_path, const FilePath& deg_signal_path) {
   // Ensure the initialization succeeded.
   VISQOL_RETURN_IF_ERROR(ErrorIfNotInitialized());
 
-  // Load the wav audio files as mono.
-  const AudioSignal ref_signal = MiscAudio::LoadAsMono(ref_signal_path);
-  AudioSignal deg_signal = MiscAudio::LoadAsMono(deg_signal_path);
+  // Load the audio files as mono.
+  AudioSignal ref_signal = LoadSignal(ref_signal_path);
+  AudioSignal deg_signal = LoadSignal(deg_signal_path);
+  ResampleInput(&ref_signal);
 
   // If the sim result was successfully calculated, set the signal file paths.
   // Else, return the StatusOr failure.
@@ -157,17 +268,121 @@ absl::StatusOr<SimilarityResultMsg> VisqolManager::Run(
   // Ensure the initialization succeeded.
   VISQOL_RETURN_IF_ERROR(ErrorIfNotInitialized());
 
+  if (NeedsResampling(ref_signal)) {
+    AudioSignal resampled_ref = ref_signal;
+    ResampleInput(&resampled_ref);
+    return Run(resampled_ref, deg_signal);
+  }
+  ResampleInput(&deg_signal);
+
   VISQOL_RETURN_IF_ERROR(ValidateInputAudio(ref_signal, deg_signal));
 
-  std::tuple<AudioSignal, double> alignment_result;
+  // Let the comparison reuse the matrix memory released while preparing the
+  // reference.
+  const MatrixArena::Scope arena_scope;
+  PreparedReference reference;
+  VISQOL_ASSIGN_OR_RETURN(reference, BuildPreparedReference(ref_signal));
+  return RunPrepared(reference, deg_signal);
+}
+
+absl::StatusOr<std::shared_ptr<const PreparedReference>>
+VisqolManager::PrepareReference(const FilePath& ref_signal_path) {
+  // Ensure the initialization succeeded.
+  VISQOL_RETURN_IF_ERROR(ErrorIfNotInitialized());
+
+  AudioSignal ref_signal = LoadSignal(ref_signal_path);
+  ResampleInput(&ref_signal);
+  PreparedReference reference;
+  VISQOL_ASSIGN_OR_RETURN(reference, BuildPreparedReference(ref_signal));
+  reference.filepath = ref_signal_path.Path();
+  return std::make_shared<const PreparedReference>(std::move(reference));
+}
+
+absl::StatusOr<std::shared_ptr<const PreparedReference>>
+VisqolManager::PrepareReference(const AudioSignal& ref_signal) {
+  // Ensure the initialization succeeded.
+  VISQOL_RETURN_IF_ERROR(ErrorIfNotInitialized());
+
+  if (NeedsResampling(ref_signal)) {
+    AudioSignal resampled_ref = ref_signal;
+    ResampleInput(&resampled_ref);
+    return PrepareReference(resampled_ref);
+  }
+
+  PreparedReference reference;
+  VISQOL_ASSIGN_OR_RETURN(reference, BuildPreparedReference(ref_signal));
+  return std::make_shared<const PreparedReference>(std::move(reference));
+}
+
+absl::StatusOr<SimilarityResultMsg> VisqolManager::Run(
+    const PreparedReference& reference, const FilePath& deg_signal_path) {
+  // Ensure the initialization succeeded.
+  VISQOL_RETURN_IF_ERROR(ErrorIfNotInitialized());
+
+  AudioSignal deg_signal = LoadSignal(deg_signal_path);
+
+  SimilarityResultMsg sim_result_msg;
+  VISQOL_ASSIGN_OR_RETURN(sim_result_msg, Run(reference, deg_signal));
+  sim_result_msg.set_reference_filepath(reference.filepath);
+  sim_result_msg.set_degraded_filepath(deg_signal_path.Path());
+  return sim_result_msg;
+}
+
+absl::StatusOr<SimilarityResultMsg> VisqolManager::Run(
+    const PreparedReference& reference, AudioSignal& deg_signal) {
+  // Ensure the initialization succeeded.
+  VISQOL_RETURN_IF_ERROR(ErrorIfNotInitialized());
+
+  // The spectrogram and patches of the reference depend on the mode.
+  if (reference.use_speech_mode != use_speech_mode_) {
+    return absl::InvalidArgumentError(
+        "The reference was prepared for a different processing mode than "
+        "this manager was initialized with.");
+  }
+
+  ResampleInput(&deg_signal);
+  VISQOL_RETURN_IF_ERROR(ValidateInputAudio(reference.signal, deg_signal));
+  return RunPrepared(reference, deg_signal);
+}
+
+absl::StatusOr<PreparedReference> VisqolManager::BuildPreparedReference(
+    const AudioSignal& ref_signal) {
+  const MatrixArena::Scope arena_scope;
+  const AnalysisWindow window{ref_signal.sample_rate, kOverlap};
+  const Visqol visqol;
+  PreparedReference reference;
+  VISQOL_ASSIGN_OR_RETURN(
+      reference, visqol.PrepareReference(ref_signal, spectrogram_builder_.get(),
+                                         window, patch_creator_.get()));
+  if (!disable_global_alignment_) {
+    reference.upper_env = Envelope::CalcUpperEnv(ref_signal.data_matrix);
+  }
+  reference.use_speech_mode = use_speech_mode_;
+  return reference;
+}
+
+absl::StatusOr<SimilarityResultMsg> VisqolManager::RunPrepared(
+    const PreparedReference& reference, const AudioSignal& deg_signal) {
+  // Recycle the memory of the many temporary matrices of the comparison.
+  const MatrixArena::Scope arena_scope;
+  const AudioSignal& ref_signal = reference.signal;
+
+  // The aligned degraded signal is a view of deg_signal, padded or truncated
+  // at the start.
+  std::tuple<AudioSignalView, double> alignment_result;
   if (!disable_global_alignment_) {
-    // Adjust for codec initial padding.
-    alignment_result = Alignment::GloballyAlign(ref_signal, deg_signal);
-    deg_signal = std::get<0>(alignment_result);
+    // Adjust for codec initial padding. The envelope is not prepared if the
+    // reference was prepared with global alignment disabled.
+    if (reference.upper_env.NumElements() == 0) {
+      alignment_result = Alignment::GloballyAlign(ref_signal, deg_signal);
+    } else {
+      alignment_result = Alignment::GloballyAlign(
+          ref_signal, reference.upper_env, deg_signal);
+    }
   }
   else {
     // If no alignment is performed, lag should be set to 0
-    alignment_result = std::make_tuple(deg_signal, 0.0);
+    alignment_result = std::make_tuple(AudioSignalView(deg_signal), 0.0);
   }
 
   const AnalysisWindow window{ref_signal.sample_rate, kOverlap};
@@ -177,10 +392,11 @@ absl::StatusOr<SimilarityResultMsg> VisqolManager::Run(
   const Visqol visqol;
   SimilarityResult sim_result;
   VISQOL_ASSIGN_OR_RETURN(
-      sim_result, visqol.CalculateSimilarity(
-                      ref_signal, deg_signal, spectrogram_builder_.get(),
-                      window, patch_creator_.get(), patch_selector_.get(),
-                      sim_to_qual_.get(), search_window_, disable_realignment_));
+      sim_result,
+      visqol.CalculateSimilarity(
+          reference, std::get<0>(alignment_result), spectrogram_builder_.get(),
+          window, patch_creator_.get(), patch_selector_.get(),
+          sim_to_qual_.get(), search_window_, disable_realignment_));
   SimilarityResultMsg sim_result_msg = PopulateSimResultMsg(sim_result);
   sim_result_msg.set_alignment_lag_s(std::get<1>(alignment_result));
   return sim_result_msg;
@@ -228,7 +444,7 @@ SimilarityResultMsg VisqolManager::PopulateSimResultMsg(
   return sim_result_msg;
 }
 
-absl::Status VisqolManager::ErrorIfNotInitialized() {
+absl::Status VisqolManager::ErrorIfNotInitialized() const {
   if (is_initialized_ == false) {
     return absl::Status(absl::StatusCode::kAborted,
                         "VisqolManager must be initialized before use.");
@@ -237,6 +453,21 @@ absl::Status VisqolManager::ErrorIfNotInitialized() {
   }
 }
 
+void VisqolManager::ResampleInput(AudioSignal* signal) const {
+  if (NeedsResampling(*signal)) {
+    *signal = Resampler::Resample(*signal, CanonicalSampleRate());
+  }
+}
+
+size_t VisqolManager::CanonicalSampleRate() const {
+  return use_speech_mode_ ? k16kSampleRate : k48kSampleRate;
+}
+
+bool VisqolManager::NeedsResampling(const AudioSignal& signal) const {
+  return resample_input_ && signal.sample_rate != CanonicalSampleRate() &&
+         signal.data_matrix.NumElements() > 0;
+}
+
 absl::Status VisqolManager::ValidateInputAudio(const AudioSignal& ref_signal,
                                                const AudioSignal& deg_signal) {
   // Warn if there is an excessive difference in durations.
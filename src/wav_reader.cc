@@ -17,10 +17,15 @@
 #include <assert.h>
 
 #include <algorithm>
+#include <cstring>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/base/internal/raw_logging.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "misc_audio.h"
 #include "misc_math.h"
 
 namespace Visqol {
@@ -71,25 +76,151 @@ static_assert(sizeof(WavHeader) == kWavHeaderSize,
 // Supported WAV encoding formats.
 static const uint16_t kExtensibleWavFormat = 0xfffe;
 static const uint16_t kPcmFormat = 0x1;
+static const uint16_t kIeeeFloatFormat = 0x3;
+
+// The offset of the sub-format GUID in the format extension of
+// WAVE_FORMAT_EXTENSIBLE. The first two bytes of the GUID are the format tag.
+static const size_t kSubFormatOffset = 6;
+
+// The data chunk size written by encoders that do not know the length of the
+// data, e.g. because they are streaming to a pipe.
+static const uint32_t kUnknownDataSize = 0xffffffff;
+
+// Scale integer samples to [-1, 1).
+static const double kInt16Scale = 1.0 / 32768.0;
+static const double kInt24Scale = 1.0 / 8388608.0;
+static const double kInt32Scale = 1.0 / 2147483648.0;
+
+// Get the sample format for a WAV format tag and sample size.
+bool ToSampleFormat(uint16_t format_tag, uint16_t bits_per_sample,
+                    WavReader::SampleFormat* sample_format) {
+  if (format_tag == kPcmFormat) {
+    switch (bits_per_sample) {
+      case 16:
+        *sample_format = WavReader::SampleFormat::kInt16;
+        return true;
+      case 24:
+        *sample_format = WavReader::SampleFormat::kInt24;
+        return true;
+      case 32:
+        *sample_format = WavReader::SampleFormat::kInt32;
+        return true;
+    }
+  } else if (format_tag == kIeeeFloatFormat) {
+    switch (bits_per_sample) {
+      case 32:
+        *sample_format = WavReader::SampleFormat::kFloat32;
+        return true;
+      case 64:
+        *sample_format = WavReader::SampleFormat::kFloat64;
+        return true;
+    }
+  }
+  return false;
+}
+
+// The names of the sample formats of raw PCM input.
+struct SampleFormatName {
+  const char* name;
+  WavReader::SampleFormat sample_format;
+  size_t bytes_per_sample;
+};
+const SampleFormatName kSampleFormatNames[] = {
+    {"s16le", WavReader::SampleFormat::kInt16, 2},
+    {"s24le", WavReader::SampleFormat::kInt24, 3},
+    {"s32le", WavReader::SampleFormat::kInt32, 4},
+    {"f32le", WavReader::SampleFormat::kFloat32, 4},
+    {"f64le", WavReader::SampleFormat::kFloat64, 8},
+};
+
+// Convert little endian samples to doubles. Each sample is copied out to
+// avoid unaligned reads; the loop is simple enough for the compiler to
+// vectorize.
+template <typename T>
+void ConvertSamples(const char* encoded_samples, size_t num_samples,
+                    double scale, double* target_buffer) {
+  for (size_t i = 0; i < num_samples; i++) {
+    T sample;
+    std::memcpy(&sample, encoded_samples + i * sizeof(T), sizeof(T));
+    target_buffer[i] = sample * scale;
+  }
+}
 }  // namespace
 
+const size_t WavReader::kMaxBlockSamples = 1 << 14;
+
 WavReader::WavReader(std::istream* binary_stream)
     : binary_stream_(CHECK_NOTNULL(binary_stream)),
       num_channels_(0),
       sample_rate_hz_(-1),
       num_total_samples_(0),
       num_remaining_samples_(0),
+      bytes_per_sample_(0),
+      sample_format_(SampleFormat::kInt16),
       pcm_offset_bytes_(0),
-      bytes_in_stream_(GetCountOfBytesInStream()) {
+      bytes_in_stream_(GetCountOfBytesInStream()),
+      stream_position_(0),
+      length_known_(true) {
   init_ = ParseHeader();
 }
 
+WavReader::WavReader(std::istream* binary_stream, const PcmFormat& format)
+    : binary_stream_(CHECK_NOTNULL(binary_stream)),
+      init_(false),
+      num_channels_(format.num_channels),
+      sample_rate_hz_(format.sample_rate_hz),
+      num_total_samples_(0),
+      num_remaining_samples_(SIZE_MAX),
+      bytes_per_sample_(0),
+      sample_format_(format.sample_format),
+      pcm_offset_bytes_(0),
+      bytes_in_stream_(-1),
+      stream_position_(0),
+      length_known_(false) {
+  for (const auto& format_name : kSampleFormatNames) {
+    if (format_name.sample_format == format.sample_format) {
+      bytes_per_sample_ = format_name.bytes_per_sample;
+    }
+  }
+  if (num_channels_ == 0 || sample_rate_hz_ <= 0) {
+    ABSL_RAW_LOG(ERROR,
+                 "Raw PCM input needs a positive sample rate and number of"
+                 " channels.");
+    return;
+  }
+  init_ = true;
+}
+
+bool WavReader::ParseSampleFormat(absl::string_view name,
+                                  SampleFormat* sample_format) {
+  for (const auto& format_name : kSampleFormatNames) {
+    if (name == format_name.name) {
+      *sample_format = format_name.sample_format;
+      return true;
+    }
+  }
+  return false;
+}
+
 size_t WavReader::ReadBinaryDataFromStream(void* target_ptr, size_t size) {
   if (!binary_stream_->good()) {
     return 0;
   }
   binary_stream_->read(static_cast<char*>(target_ptr), size);
-  return static_cast<size_t>(binary_stream_->gcount());
+  const size_t num_bytes_read = static_cast<size_t>(binary_stream_->gcount());
+  stream_position_ += num_bytes_read;
+  return num_bytes_read;
+}
+
+size_t WavReader::SkipBinaryDataInStream(size_t size) {
+  if (!binary_stream_->good()) {
+    return 0;
+  }
+  binary_stream_->ignore(size);
+  const size_t num_bytes_skipped =
+      static_cast<size_t>(binary_stream_->gcount());
+  stream_position_ += num_bytes_skipped;
+  return num_bytes_skipped;
 }
 
 int64_t WavReader::GetCountOfBytesInStream() {
@@ -99,6 +230,12 @@ int64_t WavReader::GetCountOfBytesInStream() {
   binary_stream_->seekg(0, std::ios::end);
   int64_t count_of_bytes = binary_stream_->tellg();
   binary_stream_->seekg(0, std::ios::beg);
+  if (!binary_stream_->good() || count_of_bytes < 0) {
+    // The stream is not seekable, e.g. a pipe, so it is read from where it
+    // is and its length is unknown.
+    binary_stream_->clear();
+    return -1;
+  }
   return count_of_bytes;
 }
 
@@ -119,9 +256,10 @@ bool WavReader::ParseHeader() {
     ABSL_RAW_LOG(ERROR, "Error parsing WAV Header - Incorrect format size.");
     return false;
   }
+  uint16_t format_tag = header.format.format_tag;
   if (format_size != kFormatSubChunkHeader) {
     // Parse optional extension fields.
-    int16_t extension_size;
+    uint16_t extension_size;
     if (ReadBinaryDataFromStream(&extension_size, sizeof(extension_size)) !=
         sizeof(extension_size)) {
       ABSL_RAW_LOG(ERROR,
@@ -129,52 +267,36 @@ bool WavReader::ParseHeader() {
                    " size");
       return false;
     }
-    int8_t extension_data;
-
-    for (size_t i = 0; i < static_cast<size_t>(extension_size); ++i) {
-      if (ReadBinaryDataFromStream(&extension_data, sizeof(extension_data)) !=
-          sizeof(extension_data)) {
-        ABSL_RAW_LOG(ERROR,
-                     "Error parsing WAV Header - Error reading extension"
-                     " data");
-        return false;
-      }
-    }
-  }
-  if (header.format.format_tag == kExtensibleWavFormat) {
-    // Skip extensible wav format "fact" header.
-    ChunkHeader fact_header;
-    if (ReadBinaryDataFromStream(&fact_header, sizeof(fact_header)) !=
-        sizeof(fact_header)) {
+    std::vector<char> extension_data(extension_size);
+    if (ReadBinaryDataFromStream(extension_data.data(), extension_size) !=
+        extension_size) {
       ABSL_RAW_LOG(ERROR,
-                   "Error parsing WAV Header - Error reading 'fact'"
-                   " header");
-      return false;
-    }
-    if (std::string(fact_header.id, 4) != "fact") {
-      ABSL_RAW_LOG(ERROR,
-                   "Error parsing WAV Header - Incorrect 'fact' header"
-                   " id");
+                   "Error parsing WAV Header - Error reading extension"
+                   " data");
       return false;
     }
-    int8_t fact_data;
-    for (size_t i = 0; i < static_cast<size_t>(fact_header.size); ++i) {
-      if (ReadBinaryDataFromStream(&fact_data, sizeof(fact_data)) !=
-          sizeof(fact_data)) {
+    if (format_tag == kExtensibleWavFormat) {
+      if (extension_size < kSubFormatOffset + sizeof(format_tag)) {
         ABSL_RAW_LOG(ERROR,
-                     "Error parsing WAV Header - Error reading 'fact'"
-                     " data");
+                     "Error parsing WAV Header - Extensible format without"
+                     " a sub-format.");
         return false;
       }
+      std::memcpy(&format_tag, extension_data.data() + kSubFormatOffset,
+                  sizeof(format_tag));
     }
   }
+  // Any "fact" chunk is skipped with the other chunks before the data.
 
   num_channels_ = header.format.num_channels;
   sample_rate_hz_ = header.format.samples_rate;
 
   bytes_per_sample_ = header.format.bits_per_sample / 8;
-  if (bytes_per_sample_ == 0 || bytes_per_sample_ != sizeof(int16_t)) {
-    ABSL_RAW_LOG(ERROR, "Error parsing WAV Header - Expected 16bit samples.");
+  if (!ToSampleFormat(format_tag, header.format.bits_per_sample,
+                      &sample_format_)) {
+    ABSL_RAW_LOG(ERROR,
+                 "Error parsing WAV Header - Expected 16, 24 or 32-bit"
+                 " integer or 32 or 64-bit float samples.");
     return false;
   }
 
@@ -188,15 +310,22 @@ bool WavReader::ParseHeader() {
   }
   while (std::string(header.data.header.id, 4) != "data") {
     if (!binary_stream_->good() ||
-        (static_cast<int64_t>(binary_stream_->tellg()) +
-         static_cast<int64_t>(header.data.header.size)) > bytes_in_stream_) {
+        (bytes_in_stream_ >= 0 &&
+         (static_cast<int64_t>(stream_position_) +
+          static_cast<int64_t>(header.data.header.size)) > bytes_in_stream_)) {
       ABSL_RAW_LOG(ERROR,
                    "Error parsing WAV Header - Could not find data chunk"
                    " in WAV file header.");
       return false;
     }
 
-    binary_stream_->seekg(header.data.header.size, std::ios::cur);
+    if (SkipBinaryDataInStream(header.data.header.size) !=
+        header.data.header.size) {
+      ABSL_RAW_LOG(ERROR,
+                   "Error parsing WAV Header - Could not find data chunk"
+                   " in WAV file header.");
+      return false;
+    }
 
     if (ReadBinaryDataFromStream(&header.data, sizeof(header.data)) !=
         sizeof(header.data)) {
@@ -208,13 +337,18 @@ bool WavReader::ParseHeader() {
   }
 
   const size_t bytes_in_payload = header.data.header.size;
-  num_total_samples_ = bytes_in_payload / bytes_per_sample_;
-  num_remaining_samples_ = num_total_samples_;
+  length_known_ = header.data.header.size != kUnknownDataSize;
+  if (length_known_) {
+    num_total_samples_ = bytes_in_payload / bytes_per_sample_;
+    num_remaining_samples_ = num_total_samples_;
+  } else {
+    num_total_samples_ = 0;
+    num_remaining_samples_ = SIZE_MAX;
+  }
 
-  if (header.format.num_channels == 0 || num_total_samples_ == 0 ||
-      bytes_in_payload % bytes_per_sample_ != 0 ||
-      (header.format.format_tag != kPcmFormat &&
-       header.format.format_tag != kExtensibleWavFormat) ||
+  if (header.format.num_channels == 0 ||
+      (length_known_ && (num_total_samples_ == 0 ||
+                         bytes_in_payload % bytes_per_sample_ != 0)) ||
       (std::string(header.riff.header.id, 4) != "RIFF") ||
       (std::string(header.riff.format, 4) != "WAVE") ||
       (std::string(header.format.header.id, 4) != "fmt ") ||
@@ -223,37 +357,135 @@ bool WavReader::ParseHeader() {
     return false;
   }
 
-  int64_t current_position = binary_stream_->tellg();
-  if (current_position < 0) {
-    ABSL_RAW_LOG(ERROR, "Error parsing WAV Header.");
-    return false;
-  }
-  pcm_offset_bytes_ = static_cast<uint64_t>(current_position);
+  pcm_offset_bytes_ = stream_position_;
   return true;
 }
 
-size_t WavReader::ReadSamples(size_t num_samples, int16_t* target_buffer) {
+size_t WavReader::ReadEncodedSamples(size_t num_samples, char* target_buffer) {
   const size_t num_samples_to_read =
       std::min(num_remaining_samples_, num_samples);
   if (num_samples_to_read == 0) {
     return 0;
   }
-  const size_t num_bytes_read =
-      ReadBinaryDataFromStream(target_buffer, num_samples * sizeof(int16_t));
+  const size_t num_bytes_read = ReadBinaryDataFromStream(
+      target_buffer, num_samples_to_read * bytes_per_sample_);
   const size_t num_samples_read = num_bytes_read / bytes_per_sample_;
 
   num_remaining_samples_ -= num_samples_read;
   return num_samples_read;
 }
 
+size_t WavReader::ReadSamples(size_t num_samples, int16_t* target_buffer) {
+  if (sample_format_ != SampleFormat::kInt16) {
+    ABSL_RAW_LOG(ERROR, "Only 16-bit samples can be read as int16.");
+    return 0;
+  }
+  return ReadEncodedSamples(num_samples,
+                            reinterpret_cast<char*>(target_buffer));
+}
+
+void WavReader::DecodeSamples(const char* encoded_samples, size_t num_samples,
+                              double* target_buffer) const {
+  switch (sample_format_) {
+    case SampleFormat::kInt16:
+      ConvertSamples<int16_t>(encoded_samples, num_samples, kInt16Scale,
+                              target_buffer);
+      break;
+    case SampleFormat::kInt24:
+      // Shift each sample into the top of an int32 so that it is sign
+      // extended, then scale it back down.
+      for (size_t i = 0; i < num_samples; i++) {
+        const unsigned char* bytes =
+            reinterpret_cast<const unsigned char*>(encoded_samples + i * 3);
+        const int32_t sample = static_cast<int32_t>(
+            (static_cast<uint32_t>(bytes[0]) << 8) |
+            (static_cast<uint32_t>(bytes[1]) << 16) |
+            (static_cast<uint32_t>(bytes[2]) << 24));
+        target_buffer[i] = (sample >> 8) * kInt24Scale;
+      }
+      break;
+    case SampleFormat::kInt32:
+      ConvertSamples<int32_t>(encoded_samples, num_samples, kInt32Scale,
+                              target_buffer);
+      break;
+    case SampleFormat::kFloat32:
+      ConvertSamples<float>(encoded_samples, num_samples, 1.0, target_buffer);
+      break;
+    case SampleFormat::kFloat64:
+      ConvertSamples<double>(encoded_samples, num_samples, 1.0, target_buffer);
+      break;
+  }
+}
+
+size_t WavReader::ReadMonoFrames(size_t num_frames, double* target_buffer) {
+  const size_t num_channels = num_channels_;
+  if (!init_ || num_channels == 0) {
+    return 0;
+  }
+  const size_t frames_per_block =
+      std::max<size_t>(kMaxBlockSamples / num_channels, 1);
+  const size_t samples_per_block = frames_per_block * num_channels;
+  // The encoded samples are held in an int16 buffer so that 16-bit samples
+  // can be downmixed in place, without decoding them first.
+  block_buffer_.resize(
+      (samples_per_block * bytes_per_sample_ + sizeof(int16_t) - 1) /
+      sizeof(int16_t));
+  char* encoded_block = reinterpret_cast<char*>(block_buffer_.data());
+
+  size_t num_frames_read = 0;
+  while (num_frames_read < num_frames) {
+    const size_t block_frames =
+        std::min(frames_per_block, num_frames - num_frames_read);
+    const size_t num_samples_read =
+        ReadEncodedSamples(block_frames * num_channels, encoded_block);
+    if (num_samples_read == 0) {
+      break;
+    }
+    // Missing samples of a partial final frame are zero.
+    const size_t num_block_frames =
+        (num_samples_read + num_channels - 1) / num_channels;
+    const size_t num_block_samples = num_block_frames * num_channels;
+    const absl::Span<double> mono(target_buffer + num_frames_read,
+                                  num_block_frames);
+    if (sample_format_ == SampleFormat::kInt16) {
+      std::fill(block_buffer_.begin() + num_samples_read,
+                block_buffer_.begin() + num_block_samples, 0);
+      MiscAudio::InterleavedToMono(
+          absl::MakeConstSpan(block_buffer_.data(), num_block_samples),
+          num_channels, mono);
+    } else {
+      decoded_block_.resize(samples_per_block);
+      DecodeSamples(encoded_block, num_samples_read, decoded_block_.data());
+      std::fill(decoded_block_.begin() + num_samples_read,
+                decoded_block_.begin() + num_block_samples, 0.0);
+      MiscAudio::InterleavedToMono(
+          absl::MakeConstSpan(decoded_block_.data(), num_block_samples),
+          num_channels, mono);
+    }
+    num_frames_read += num_block_frames;
+    if (num_samples_read < block_frames * num_channels) {
+      break;
+    }
+  }
+  return num_frames_read;
+}
+
 size_t WavReader::GetNumTotalSamples() const { return num_total_samples_; }
 
+bool WavReader::IsLengthKnown() const { return length_known_; }
+
 size_t WavReader::GetNumChannels() const { return num_channels_; }
 
+WavReader::SampleFormat WavReader::GetSampleFormat() const {
+  return sample_format_;
+}
+
 int WavReader::GetSampleRateHz() const { return sample_rate_hz_; }
 
 bool WavReader::IsHeaderValid() const { return init_; }
 
+uint64_t WavReader::GetPcmOffsetBytes() const { return pcm_offset_bytes_; }
+
 double WavReader::GetDuration() const {
   return ((num_total_samples_ / num_channels_) /
           static_cast<double>(sample_rate_hz_));
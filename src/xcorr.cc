@@ -19,6 +19,7 @@
 #include <algorithm>
 #include <complex>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -36,6 +37,18 @@ int64_t XCorr::FindLowestLagIndex(const AMatrix<double>& signal_1,
                              static_cast<int64_t>(signal_2.NumRows())) -
                     1;
 
+  const std::vector<double> corrs = CalcCrossCorrelation(signal_1, signal_2);
+  // Find best corr and from that the best lag.
+  auto best_corr = std::max_element(corrs.cbegin(), corrs.cend());
+  return std::distance(corrs.cbegin(), best_corr) - max_lag;
+}
+
+std::vector<double> XCorr::CalcCrossCorrelation(
+    const AMatrix<double>& signal_1, const AMatrix<double>& signal_2) {
+  int64_t max_lag = std::max(static_cast<int64_t>(signal_1.NumRows()),
+                             static_cast<int64_t>(signal_2.NumRows())) -
+                    1;
+
   const std::vector<double> pointwise_fft_vec =
       InverseFFTPointwiseProduct(signal_1, signal_2);
   // Build negatives corrs.
@@ -46,9 +59,46 @@ int64_t XCorr::FindLowestLagIndex(const AMatrix<double>& signal_1,
                                       pointwise_fft_vec.begin() + max_lag + 1};
   // Build total corrs.
   corrs.insert(corrs.end(), positives.begin(), positives.end());
-  // Find best corr and from that the best lag.
-  auto best_corr = std::max_element(corrs.cbegin(), corrs.cend());
-  return std::distance(corrs.cbegin(), best_corr) - max_lag;
+  return corrs;
+}
+
+int64_t XCorr::FindLowestLagIndexInRange(const AMatrix<double>& signal_1,
+                                         const AMatrix<double>& signal_2,
+                                         int64_t min_lag, int64_t max_lag) {
+  // Clamp the range to the lags that FindLowestLagIndex would consider.
+  const int64_t lag_limit = std::max(static_cast<int64_t>(signal_1.NumRows()),
+                                     static_cast<int64_t>(signal_2.NumRows())) -
+                            1;
+  min_lag = std::max(min_lag, -lag_limit);
+  max_lag = std::min(max_lag, lag_limit);
+
+  int64_t best_lag = min_lag;
+  double best_corr = -std::numeric_limits<double>::infinity();
+  for (int64_t lag = min_lag; lag <= max_lag; ++lag) {
+    const double corr = CalcCorrelationAtLag(signal_1, signal_2, lag);
+    if (corr > best_corr) {
+      best_corr = corr;
+      best_lag = lag;
+    }
+  }
+  return best_lag;
+}
+
+double XCorr::CalcCorrelationAtLag(const AMatrix<double>& signal_1,
+                                   const AMatrix<double>& signal_2,
+                                   int64_t lag) {
+  const int64_t len_1 = signal_1.NumRows();
+  const int64_t len_2 = signal_2.NumRows();
+  const double* s1 = signal_1.data();
+  const double* s2 = signal_2.data();
+  // corr[lag] = sum_n signal_1[n + lag] * signal_2[n], over the overlap.
+  const int64_t n_start = std::max<int64_t>(0, -lag);
+  const int64_t n_end = std::min(len_2, len_1 - lag);
+  double corr = 0.0;
+  for (int64_t n = n_start; n < n_end; ++n) {
+    corr += s1[n + lag] * s2[n];
+  }
+  return corr;
 }
 
 std::vector<double> XCorr::InverseFFTPointwiseProduct(
@@ -14,7 +14,12 @@
 
 #include "alignment.h"
 
+#include <random>
+#include <vector>
+
 #include "audio_signal.h"
+#include "audio_signal_view.h"
+#include "envelope.h"
 #include "gtest/gtest.h"
 #include "xcorr.h"
 
@@ -38,6 +43,31 @@ constexpr int kBestLagPositive2 = 2;
 constexpr int kBestLagNegative2 = -2;
 constexpr int kZeroLag = 0;
 
+// Properties of the synthetic signal used to test the alignment of long
+// signals, which uses a coarse search on decimated envelopes.
+constexpr size_t kLongSignalLength = 200000;
+constexpr size_t kLongSignalBurstLength = 4000;
+constexpr int64_t kLongSignalLag = 1237;
+constexpr int64_t kLongSignalMaxLag = 480;
+constexpr int64_t kLongSignalBoundedLag = 321;
+
+// Build a deterministic noise signal with a slowly varying amplitude, so that
+// its envelope has some structure to align.
+AMatrix<double> BuildLongTestSignal() {
+  std::mt19937 generator(42);
+  std::normal_distribution<double> noise(0.0, 1.0);
+  std::uniform_real_distribution<double> gain(0.05, 1.0);
+  std::vector<double> samples(kLongSignalLength);
+  double burst_gain = gain(generator);
+  for (size_t i = 0; i < samples.size(); ++i) {
+    if (i % kLongSignalBurstLength == 0) {
+      burst_gain = gain(generator);
+    }
+    samples[i] = burst_gain * noise(generator);
+  }
+  return AMatrix<double>(samples);
+}
+
 // Test the alignment of a degraded signal with a given reference signal.
 // Test case where the lag between the two signals has a positive value.
 TEST(Alignment, AlignSignalWithPositiveLag) {
@@ -49,9 +79,9 @@ TEST(Alignment, AlignSignalWithPositiveLag) {
   // Ensure there is an positive initial lag.
   EXPECT_EQ(kBestLagPositive2, initial_lag);
 
-  const std::tuple<AudioSignal, double> alignment_result =
+  const std::tuple<AudioSignalView, double> alignment_result =
       Alignment::GloballyAlign(reference_signal, degraded_signal);
-  degraded_signal = std::get<0>(alignment_result);
+  degraded_signal = std::get<0>(alignment_result).ToSignal();
 
   const int64_t final_lag = XCorr::FindLowestLagIndex(
       reference_signal.data_matrix, degraded_signal.data_matrix);
@@ -74,9 +104,9 @@ TEST(Alignment, AlignSignalWithNegativeLag) {
   // Ensure there is an initial negative lag.
   EXPECT_EQ(kBestLagNegative2, initial_lag);
 
-  const std::tuple<AudioSignal, double> alignment_result =
+  const std::tuple<AudioSignalView, double> alignment_result =
       Alignment::GloballyAlign(reference_signal, degraded_signal);
-  degraded_signal = std::get<0>(alignment_result);
+  degraded_signal = std::get<0>(alignment_result).ToSignal();
 
   const int64_t final_lag = XCorr::FindLowestLagIndex(
       reference_signal.data_matrix, degraded_signal.data_matrix);
@@ -101,9 +131,9 @@ TEST(Alignment, AlignSignalWithNoLag) {
   // Ensure there is no initial lag.
   EXPECT_EQ(kZeroLag, initial_lag);
 
-  const std::tuple<AudioSignal, double> alignment_result =
+  const std::tuple<AudioSignalView, double> alignment_result =
       Alignment::GloballyAlign(reference_signal, degraded_signal);
-  degraded_signal = std::get<0>(alignment_result);
+  degraded_signal = std::get<0>(alignment_result).ToSignal();
 
   const int64_t final_lag = XCorr::FindLowestLagIndex(
       reference_signal.data_matrix, degraded_signal.data_matrix);
@@ -115,6 +145,32 @@ TEST(Alignment, AlignSignalWithNoLag) {
             degraded_signal.data_matrix.NumElements());
 }
 
+// Test the alignment of a long degraded signal with a given reference signal.
+// The coarse-to-fine search must find the same lag as a single full rate
+// cross correlation of the envelopes.
+TEST(Alignment, AlignLongSignalMatchesFullRateSearch) {
+  const AMatrix<double> long_signal = BuildLongTestSignal();
+  AudioSignal reference_signal{long_signal, 48000};
+  // The degraded signal starts kLongSignalLag samples into the reference.
+  AudioSignal degraded_signal{
+      long_signal.GetRows(kLongSignalLag, long_signal.NumRows() - 1), 48000};
+
+  const int64_t full_rate_lag = XCorr::FindLowestLagIndex(
+      Envelope::CalcUpperEnv(long_signal),
+      Envelope::CalcUpperEnv(degraded_signal.data_matrix));
+  EXPECT_EQ(kLongSignalLag, full_rate_lag);
+
+  const std::tuple<AudioSignalView, double> alignment_result =
+      Alignment::GloballyAlign(reference_signal, degraded_signal);
+  EXPECT_DOUBLE_EQ(
+      static_cast<double>(full_rate_lag) / reference_signal.sample_rate,
+      std::get<1>(alignment_result));
+
+  // Confirm that the new degraded signal has been padded by the lag amount.
+  EXPECT_EQ(reference_signal.data_matrix.NumElements(),
+            std::get<0>(alignment_result).NumSamples());
+}
+
 // Test the alignment of a degraded signal with a given reference signal.
 // Test case where the lag between the two signals has a negative value.
 TEST(Alignment, AlignAndTruncateSignalWithNegativeLag) {
@@ -122,10 +178,10 @@ TEST(Alignment, AlignAndTruncateSignalWithNegativeLag) {
   AudioSignal degraded_signal{kDegradedSignalNegativeLag2, 1};
 
   const double original_reference_duration = reference_signal.GetDuration();
-  const std::tuple<AudioSignal, AudioSignal, double> alignment_result =
+  const std::tuple<AudioSignalView, AudioSignalView, double> alignment_result =
       Alignment::AlignAndTruncate(reference_signal, degraded_signal);
-  reference_signal = std::get<0>(alignment_result);
-  degraded_signal = std::get<1>(alignment_result);
+  reference_signal = std::get<0>(alignment_result).ToSignal();
+  degraded_signal = std::get<1>(alignment_result).ToSignal();
   const double lag = std::get<2>(alignment_result);
 
   // Ensure there is an initial negative lag.
@@ -146,10 +202,10 @@ TEST(Alignment, AlignAndTruncateSignalWithPositiveLag) {
   AudioSignal degraded_signal{kDegradedSignalLag2, 1};
 
   const double original_reference_duration = reference_signal.GetDuration();
-  const std::tuple<AudioSignal, AudioSignal, double> alignment_result =
+  const std::tuple<AudioSignalView, AudioSignalView, double> alignment_result =
       Alignment::AlignAndTruncate(reference_signal, degraded_signal);
-  reference_signal = std::get<0>(alignment_result);
-  degraded_signal = std::get<1>(alignment_result);
+  reference_signal = std::get<0>(alignment_result).ToSignal();
+  degraded_signal = std::get<1>(alignment_result).ToSignal();
   const double lag = std::get<2>(alignment_result);
 
   // Ensure there is an initial postive lag.
@@ -163,5 +219,71 @@ TEST(Alignment, AlignAndTruncateSignalWithPositiveLag) {
             reference_signal.GetDuration());
 }
 
+// Test the bounded-lag alignment used for patch realignment.
+// Test case where the lag between the two signals is within the bound.
+TEST(Alignment, AlignAndTruncateWithinMaxLag) {
+  AudioSignal reference_signal{kReferenceSignal, 1};
+  AudioSignal degraded_signal{kDegradedSignalLag2, 1};
+
+  const std::tuple<AudioSignalView, AudioSignalView, double> alignment_result =
+      Alignment::AlignAndTruncate(reference_signal, degraded_signal,
+                                  kBestLagPositive2 + 1);
+  EXPECT_EQ(kBestLagPositive2, std::get<2>(alignment_result));
+  EXPECT_EQ(reference_signal.GetDuration() - kBestLagPositive2,
+            std::get<1>(alignment_result).GetDuration());
+}
+
+// Test the bounded-lag alignment used for patch realignment.
+// Test case where the lag between the two signals is beyond the bound.
+TEST(Alignment, AlignAndTruncateBeyondMaxLag) {
+  AudioSignal reference_signal{kReferenceSignal, 1};
+  AudioSignal degraded_signal{kDegradedSignalLag2, 1};
+
+  const std::tuple<AudioSignalView, AudioSignalView, double> alignment_result =
+      Alignment::AlignAndTruncate(reference_signal, degraded_signal,
+                                  kBestLagPositive2 - 1);
+  EXPECT_GE(kBestLagPositive2 - 1, std::abs(std::get<2>(alignment_result)));
+}
+
+// Test the bounded-lag alignment of a long degraded signal, which uses a
+// coarse search on decimated envelopes. It must find the same lag as a full
+// rate search of every lag within the bound.
+TEST(Alignment, AlignLongSignalWithinMaxLagMatchesFullRateSearch) {
+  const AMatrix<double> long_signal = BuildLongTestSignal();
+  AudioSignal reference_signal{long_signal, 48000};
+  AudioSignal degraded_signal{
+      long_signal.GetRows(kLongSignalBoundedLag, long_signal.NumRows() - 1),
+      48000};
+
+  const int64_t full_rate_lag = XCorr::FindLowestLagIndexInRange(
+      Envelope::CalcUpperEnv(long_signal),
+      Envelope::CalcUpperEnv(degraded_signal.data_matrix), -kLongSignalMaxLag,
+      kLongSignalMaxLag);
+  EXPECT_EQ(kLongSignalBoundedLag, full_rate_lag);
+
+  const std::tuple<AudioSignalView, double> alignment_result =
+      Alignment::GloballyAlign(reference_signal, degraded_signal,
+                               kLongSignalMaxLag);
+  EXPECT_DOUBLE_EQ(
+      static_cast<double>(full_rate_lag) / reference_signal.sample_rate,
+      std::get<1>(alignment_result));
+}
+
+// Test the bounded-lag alignment of a long degraded signal whose lag is
+// beyond the bound.
+TEST(Alignment, AlignLongSignalBeyondMaxLag) {
+  const AMatrix<double> long_signal = BuildLongTestSignal();
+  AudioSignal reference_signal{long_signal, 48000};
+  AudioSignal degraded_signal{
+      long_signal.GetRows(kLongSignalLag, long_signal.NumRows() - 1), 48000};
+
+  const std::tuple<AudioSignalView, double> alignment_result =
+      Alignment::GloballyAlign(reference_signal, degraded_signal,
+                               kLongSignalMaxLag);
+  EXPECT_GE(static_cast<double>(kLongSignalMaxLag) /
+                reference_signal.sample_rate,
+            std::abs(std::get<1>(alignment_result)));
+}
+
 }  // namespace
 }  // namespace Visqol
@@ -0,0 +1,76 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "amatrix.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace Visqol {
+namespace {
+
+const AMatrix<double> kMatrix(2, 2, std::vector<double>{1.5, -2.0, 0.25, 4.0});
+const AMatrix<double> kOther(2, 2, std::vector<double>{3.0, 0.5, -8.0, 2.0});
+
+void ExpectSame(const AMatrix<double>& expected,
+                const AMatrix<double>& actual) {
+  ASSERT_EQ(expected.NumRows(), actual.NumRows());
+  ASSERT_EQ(expected.NumCols(), actual.NumCols());
+  for (size_t i = 0; i < expected.NumElements(); i++) {
+    EXPECT_EQ(expected(i), actual(i));
+  }
+}
+
+// Test that the compound operators give the same results as the binary
+// operators.
+TEST(AMatrix, CompoundOperators) {
+  AMatrix<double> m = kMatrix;
+  m += kOther;
+  ExpectSame(kMatrix + kOther, m);
+
+  m = kMatrix;
+  m -= kOther;
+  ExpectSame(kMatrix - kOther, m);
+
+  m = kMatrix;
+  m += 0.1;
+  m -= 0.7;
+  m *= 3.0;
+  m /= 7.0;
+  ExpectSame((((kMatrix + 0.1) - 0.7) * 3.0) / 7.0, m);
+
+  m = kMatrix;
+  m.PointWiseProductInPlace(kOther);
+  ExpectSame(kMatrix.PointWiseProduct(kOther), m);
+
+  m = kMatrix;
+  m.PointWiseDivideInPlace(kOther);
+  ExpectSame(kMatrix.PointWiseDivide(kOther), m);
+}
+
+// Test that the fused multiply-add matches the unfused expression exactly.
+TEST(AMatrix, MultiplyAdd) {
+  AMatrix<double> m = kMatrix;
+  m.MultiplyAdd(kOther, kOther, -0.3);
+  ExpectSame(kMatrix - kOther.PointWiseProduct(kOther) * 0.3, m);
+
+  m = kMatrix;
+  m.MultiplyAdd(kMatrix, kOther, 1.0).MultiplyAdd(kOther, kOther, 2.0);
+  ExpectSame(kMatrix + kMatrix.PointWiseProduct(kOther) +
+                 kOther.PointWiseProduct(kOther) * 2.0,
+             m);
+}
+
+}  // namespace
+}  // namespace Visqol
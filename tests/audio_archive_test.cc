@@ -0,0 +1,148 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "audio_archive.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "file_path.h"
+#include "gtest/gtest.h"
+
+namespace Visqol {
+namespace {
+
+const size_t kBlockSize = 512;
+
+// Pad data to a whole number of tar blocks.
+std::string Pad(std::string data) {
+  data.resize((data.size() + kBlockSize - 1) / kBlockSize * kBlockSize, '\0');
+  return data;
+}
+
+// Make a POSIX ustar header, with a valid checksum.
+std::string TarHeader(const std::string& name, size_t size, char type,
+                      const std::string& prefix = "") {
+  std::string header(kBlockSize, '\0');
+  header.replace(0, name.size(), name);
+  char octal[12];
+  std::snprintf(octal, sizeof(octal), "%011zo", size);
+  header.replace(124, 11, octal, 11);
+  header[156] = type;
+  header.replace(257, 8, std::string("ustar\0" "00", 8));
+  header.replace(345, prefix.size(), prefix);
+  header.replace(148, 8, 8, ' ');
+  unsigned int checksum = 0;
+  for (const char c : header) {
+    checksum += static_cast<unsigned char>(c);
+  }
+  std::snprintf(octal, sizeof(octal), "%06o", checksum);
+  header.replace(148, 7, octal, 7);
+  return header;
+}
+
+// Make an archive member of the given type.
+std::string TarMember(const std::string& name, const std::string& contents,
+                      char type = '0', const std::string& prefix = "") {
+  return TarHeader(name, contents.size(), type, prefix) + Pad(contents);
+}
+
+// Write an archive with the given members to a temporary file.
+FilePath WriteArchive(const std::string& name, const std::string& members) {
+  const std::string path = ::testing::TempDir() + "/" + name;
+  std::ofstream file(path, std::ios::binary);
+  file << members << std::string(2 * kBlockSize, '\0');
+  return FilePath(path);
+}
+
+std::string MemberContents(const AudioArchive& archive,
+                           absl::string_view name) {
+  const auto member = archive.Find(name);
+  if (!member.has_value()) {
+    return "<missing>";
+  }
+  return std::string(member->data(), member->size());
+}
+
+// Test that regular files are found by name, with or without a leading
+// "./", and that other members are not indexed.
+TEST(AudioArchive, FindsMembers) {
+  const std::string long_contents(1000, 'x');
+  const FilePath path = WriteArchive(
+      "members.tar", TarMember("./ref.wav", "reference") +
+                         TarMember("./clips/", "", '5') +
+                         TarMember("./clips/deg.wav", long_contents) +
+                         TarMember("empty.wav", ""));
+
+  auto archive_statusor = AudioArchive::Open(path);
+  ASSERT_TRUE(archive_statusor.ok()) << archive_statusor.status();
+  const AudioArchive& archive = *archive_statusor.value();
+  ASSERT_EQ(3, archive.NumMembers());
+  ASSERT_EQ("reference", MemberContents(archive, "ref.wav"));
+  ASSERT_EQ("reference", MemberContents(archive, "./ref.wav"));
+  ASSERT_EQ(long_contents, MemberContents(archive, "clips/deg.wav"));
+  ASSERT_EQ("", MemberContents(archive, "empty.wav"));
+  ASSERT_FALSE(archive.Find("clips/").has_value());
+  ASSERT_FALSE(archive.Find("missing.wav").has_value());
+}
+
+// Test the ways long member names can be stored: the ustar prefix, a GNU
+// long name member and a pax extended header, which can also give the size.
+TEST(AudioArchive, LongNames) {
+  const std::string long_name = std::string(150, 'a') + "/clip.wav";
+  const std::string pax_record = "31 path=pax/very/long/name.wav\n";
+  ASSERT_EQ(31, pax_record.size());
+  const FilePath path = WriteArchive(
+      "long_names.tar",
+      TarMember("clip.wav", "prefixed", '0', "some/dir") +
+          TarMember("././@LongLink", long_name + '\0', 'L') +
+          TarMember("truncated", "gnu") +
+          TarMember("PaxHeader", pax_record, 'x') +
+          TarMember("truncated", "pax"));
+
+  auto archive_statusor = AudioArchive::Open(path);
+  ASSERT_TRUE(archive_statusor.ok()) << archive_statusor.status();
+  const AudioArchive& archive = *archive_statusor.value();
+  ASSERT_EQ(3, archive.NumMembers());
+  ASSERT_EQ("prefixed", MemberContents(archive, "some/dir/clip.wav"));
+  ASSERT_EQ("gnu", MemberContents(archive, long_name));
+  ASSERT_EQ("pax", MemberContents(archive, "pax/very/long/name.wav"));
+}
+
+// Test that files that are not valid tar archives are rejected.
+TEST(AudioArchive, InvalidArchives) {
+  ASSERT_EQ(absl::StatusCode::kNotFound,
+            AudioArchive::Open(FilePath("non/existent.tar")).status().code());
+
+  std::string corrupt = TarMember("ref.wav", "reference");
+  corrupt[0] = 'R';
+  ASSERT_EQ(absl::StatusCode::kInvalidArgument,
+            AudioArchive::Open(WriteArchive("corrupt.tar", corrupt))
+                .status()
+                .code());
+
+  const std::string truncated =
+      TarHeader("ref.wav", 100 * kBlockSize, '0') + Pad("reference");
+  ASSERT_EQ(absl::StatusCode::kInvalidArgument,
+            AudioArchive::Open(WriteArchive("truncated.tar", truncated))
+                .status()
+                .code());
+}
+
+}  // namespace
+}  // namespace Visqol
@@ -0,0 +1,177 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "audio_prefetcher.h"
+
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <valarray>
+
+#include "absl/synchronization/notification.h"
+#include "file_path.h"
+#include "gtest/gtest.h"
+
+namespace Visqol {
+namespace {
+
+const size_t kNumPairs = 50;
+
+// Produces kNumPairs pairs named after their index.
+AudioPrefetcher::NextPairFunction MakePairs() {
+  return [i = size_t{0}](ReferenceDegradedPathPair* pair) mutable {
+    if (i == kNumPairs) {
+      return false;
+    }
+    pair->reference = FilePath("ref" + std::to_string(i));
+    pair->degraded = FilePath("deg" + std::to_string(i));
+    i++;
+    return true;
+  };
+}
+
+// Test that comparisons are returned in batch order with their audio loaded.
+TEST(AudioPrefetcher, ReturnsInOrder) {
+  AudioPrefetcher prefetcher(
+      MakePairs(),
+      [](LoadedComparison* comparison) {
+        // Load a signal whose length is the index, so that the loads finish
+        // out of order.
+        const size_t length = kNumPairs - comparison->index;
+        comparison->reference.data_matrix =
+            AMatrix<double>(std::valarray<double>(1.0, length));
+      },
+      4, 1 << 20);
+
+  LoadedComparison comparison;
+  for (size_t i = 0; i < kNumPairs; i++) {
+    ASSERT_TRUE(prefetcher.Next(&comparison));
+    ASSERT_EQ(i, comparison.index);
+    ASSERT_EQ("ref" + std::to_string(i), comparison.paths.reference.Path());
+    ASSERT_EQ(kNumPairs - i, comparison.reference.data_matrix.NumElements());
+  }
+  ASSERT_FALSE(prefetcher.Next(&comparison));
+}
+
+// Test that no more comparisons are loaded ahead than the depth and memory
+// limit allow.
+TEST(AudioPrefetcher, BoundsReadAhead) {
+  std::atomic<size_t> num_loaded{0};
+  auto load = [&num_loaded](LoadedComparison* comparison) {
+    comparison->reference.data_matrix =
+        AMatrix<double>(std::valarray<double>(1.0, 100));
+    num_loaded++;
+  };
+
+  {
+    AudioPrefetcher prefetcher(MakePairs(), load, 3, 1 << 20);
+    LoadedComparison comparison;
+    ASSERT_TRUE(prefetcher.Next(&comparison));
+    // Wait for the read ahead to fill up.
+    while (num_loaded < 4) {
+      std::this_thread::yield();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_EQ(4, num_loaded);
+  }
+
+  // A memory limit smaller than one comparison still loads one at a time.
+  num_loaded = 0;
+  {
+    AudioPrefetcher prefetcher(MakePairs(), load, 3, 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_EQ(1, num_loaded);
+    LoadedComparison comparison;
+    for (size_t i = 0; i < kNumPairs; i++) {
+      ASSERT_TRUE(prefetcher.Next(&comparison));
+    }
+    ASSERT_FALSE(prefetcher.Next(&comparison));
+    ASSERT_EQ(kNumPairs, num_loaded);
+  }
+}
+
+// Test that the memory limit holds while comparisons are still loading, by
+// counting the estimates of the slow loads that are in flight.
+TEST(AudioPrefetcher, ReservesMemoryOfLoadsInFlight) {
+  const size_t kNumSamples = 100;
+  const size_t kComparisonBytes = kNumSamples * sizeof(double);
+  std::atomic<size_t> num_loading{0};
+  std::atomic<size_t> max_loading{0};
+  std::atomic<size_t> num_loaded{0};
+  auto load = [&](LoadedComparison* comparison) {
+    const size_t loading = ++num_loading;
+    size_t max = max_loading;
+    while (loading > max && !max_loading.compare_exchange_weak(max, loading)) {
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    comparison->reference.data_matrix =
+        AMatrix<double>(std::valarray<double>(1.0, kNumSamples));
+    num_loading--;
+    num_loaded++;
+  };
+
+  // Room for two and a half comparisons, with a depth that would allow eight
+  // loads at once.
+  AudioPrefetcher prefetcher(
+      MakePairs(), load, 8, kComparisonBytes * 5 / 2,
+      [=](const ReferenceDegradedPathPair&) { return kComparisonBytes; });
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  ASSERT_EQ(2, num_loaded);
+  ASSERT_LE(max_loading, 2);
+
+  LoadedComparison comparison;
+  for (size_t i = 0; i < kNumPairs; i++) {
+    ASSERT_TRUE(prefetcher.Next(&comparison));
+    ASSERT_EQ(i, comparison.index);
+  }
+  ASSERT_FALSE(prefetcher.Next(&comparison));
+  ASSERT_LE(max_loading, 2);
+}
+
+// Test that a load thread that waits for the next pair, as with a manifest
+// on the standard input, does not stop loaded comparisons from being taken.
+TEST(AudioPrefetcher, NextPairMayBlock) {
+  absl::Notification more_pairs;
+  AudioPrefetcher prefetcher(
+      [&more_pairs, i = 0](ReferenceDegradedPathPair* pair) mutable {
+        if (i > 0) {
+          more_pairs.WaitForNotification();
+          return false;
+        }
+        pair->reference = FilePath("ref");
+        i++;
+        return true;
+      },
+      [](LoadedComparison*) {}, 4, 1 << 20);
+
+  LoadedComparison comparison;
+  ASSERT_TRUE(prefetcher.Next(&comparison));
+  ASSERT_EQ("ref", comparison.paths.reference.Path());
+  prefetcher.Stop();
+  ASSERT_FALSE(prefetcher.Next(&comparison));
+  more_pairs.Notify();
+}
+
+// Test that a stopped prefetcher returns no more comparisons.
+TEST(AudioPrefetcher, Stop) {
+  AudioPrefetcher prefetcher(MakePairs(), [](LoadedComparison*) {}, 2, 1);
+  LoadedComparison comparison;
+  ASSERT_TRUE(prefetcher.Next(&comparison));
+  prefetcher.Stop();
+  ASSERT_FALSE(prefetcher.Next(&comparison));
+}
+
+}  // namespace
+}  // namespace Visqol
@@ -0,0 +1,70 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "audio_signal_view.h"
+
+#include <vector>
+
+#include "amatrix.h"
+#include "audio_signal.h"
+#include "gtest/gtest.h"
+
+namespace Visqol {
+namespace {
+
+const size_t kSampleRate = 4;
+
+std::vector<double> Samples(const AudioSignalView& view) {
+  std::vector<double> samples(view.NumSamples());
+  view.CopySamples(0, samples.size(), samples.data());
+  return samples;
+}
+
+// Test that a view of a signal sees its samples without copying them.
+TEST(AudioSignalView, ViewsSignal) {
+  const AudioSignal signal{AMatrix<double>(std::vector<double>{1, 2, 3, 4}),
+                           kSampleRate};
+  const AudioSignalView view = signal;
+  ASSERT_EQ(4, view.NumSamples());
+  ASSERT_EQ(kSampleRate, view.GetSampleRate());
+  ASSERT_EQ(1.0, view.GetDuration());
+  ASSERT_EQ(3.0, view[2]);
+  ASSERT_EQ(std::vector<double>({1, 2, 3, 4}), Samples(view));
+  ASSERT_EQ(signal.data_matrix.ToVector(),
+            view.ToSignal().data_matrix.ToVector());
+}
+
+// Test that padding, slicing and scaling compose.
+TEST(AudioSignalView, PadSliceAndScale) {
+  const std::vector<double> samples{1, 2, 3, 4};
+  const AudioSignalView padded =
+      AudioSignalView(samples, kSampleRate).Padded(2, 1).Scaled(2.0);
+  ASSERT_EQ(std::vector<double>({0, 0, 2, 4, 6, 8, 0}), Samples(padded));
+
+  ASSERT_EQ(std::vector<double>({0, 2, 4}), Samples(padded.Slice(1, 4)));
+  ASSERT_EQ(std::vector<double>({6, 8, 0}), Samples(padded.Slice(4, 7)));
+  ASSERT_EQ(std::vector<double>({0, 0}), Samples(padded.Slice(0, 2)));
+  ASSERT_EQ(std::vector<double>({8, 0}), Samples(padded.Slice(5, 100)));
+  ASSERT_EQ(0, padded.Slice(6, 2).NumSamples());
+
+  const AudioSignalView resliced = padded.Slice(1, 6).Slice(2, 4).Padded(1, 0);
+  ASSERT_EQ(std::vector<double>({0, 4, 6}), Samples(resliced));
+  ASSERT_EQ(6.0, resliced[2]);
+
+  std::vector<double> range(3);
+  padded.CopySamples(1, 3, range.data());
+  ASSERT_EQ(std::vector<double>({0, 2, 4}), range);
+}
+
+}  // namespace
+}  // namespace Visqol
@@ -22,6 +22,8 @@
 #include <vector>
 
 #include "absl/status/statusor.h"
+#include "audio_signal.h"
+#include "audio_signal_view.h"
 #include "gtest/gtest.h"
 #include "image_patch_creator.h"
 #include "neurogram_similiarity_index_measure.h"
@@ -39,8 +41,8 @@ class ComparisonPatchesSelectorPeer {
     return cps_->CalcMaxNumPatches(ref_patch_indices, max_slide_offset,
                                    num_frames);
   }
-  static AudioSignal Slice(const AudioSignal& in_signal, double start_time,
-                           double end_time) {
+  static AudioSignalView Slice(const AudioSignalView& in_signal,
+                               double start_time, double end_time) {
     return ComparisonPatchesSelector::Slice(in_signal, start_time, end_time);
   }
   absl::StatusOr<std::vector<PatchSimilarityResult>> FindMostOptimalDegPatches(
@@ -91,15 +93,33 @@ TEST_F(ComparisonPatchesSelectorTest, Slice) {
   silence_matrix.SetRow(16000, impulse_vec);
   AudioSignal three_seconds_silence{silence_matrix, 16000};
 
-  AudioSignal sliced_signal =
+  AudioSignalView sliced_signal =
       ComparisonPatchesSelectorPeer::Slice(three_seconds_silence, 0.5, 2.5);
 
   EXPECT_EQ(sliced_signal.GetDuration(), 2.0);
 
   // Check that the impulse moved to .5 secs.
-  EXPECT_EQ(sliced_signal.data_matrix(7999, 0), 0.0);
-  EXPECT_EQ(sliced_signal.data_matrix(8000, 0), 1.0);
-  EXPECT_EQ(sliced_signal.data_matrix(8001, 0), 0.0);
+  EXPECT_EQ(sliced_signal[7999], 0.0);
+  EXPECT_EQ(sliced_signal[8000], 1.0);
+  EXPECT_EQ(sliced_signal[8001], 0.0);
+}
+
+TEST_F(ComparisonPatchesSelectorTest, SlicePastEnds) {
+  auto silence_matrix = AMatrix<double>::Filled(16000 * 3, 1, 0.0);
+  // Add an impulse at 1.0 secs
+  std::vector<double> impulse_vec(1, 1.0);
+
+  silence_matrix.SetRow(16000, impulse_vec);
+  AudioSignal three_seconds_silence{silence_matrix, 16000};
+
+  // The silence that pads the slice at either end is added at the start.
+  AudioSignalView sliced_signal =
+      ComparisonPatchesSelectorPeer::Slice(three_seconds_silence, -0.5, 3.5);
+
+  EXPECT_EQ(16000 * 4 - 1, sliced_signal.NumSamples());
+  EXPECT_EQ(sliced_signal[31999], 0.0);
+  EXPECT_EQ(sliced_signal[32000], 1.0);
+  EXPECT_EQ(sliced_signal[32001], 0.0);
 }
 
 TEST_F(ComparisonPatchesSelectorTest, OptimalPatches) {
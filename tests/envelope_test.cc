@@ -0,0 +1,106 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "envelope.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <memory>
+#include <vector>
+
+#include "fast_fourier_transform.h"
+#include "fft_manager.h"
+#include "gtest/gtest.h"
+#include "misc_vector.h"
+
+namespace Visqol {
+namespace {
+
+// The largest difference allowed between the streaming envelope and the FFT
+// based envelope, relative to the largest magnitude of the FFT envelope.
+const double kRelativeTolerance = 1e-6;
+
+// The FFT based upper envelope that CalcUpperEnv replaced.
+AMatrix<double> FftUpperEnv(const AMatrix<double>& signal) {
+  const double mean = MiscVector::Mean(signal);
+  const AMatrix<double> centered = signal - mean;
+
+  auto fft_manager = std::make_unique<FftManager>(centered.NumElements());
+  AMatrix<std::complex<double>> freq =
+      FastFourierTransform::Forward1d(fft_manager, centered);
+  const size_t rows = centered.NumRows();
+  const bool is_odd = rows % 2 == 1;
+  std::vector<double> scaling(freq.NumRows(), 0.0);
+  scaling[0] = 1.0;
+  scaling[rows / 2] = is_odd ? 2.0 : 1.0;
+  const size_t n = is_odd ? (freq.NumRows() + 1) / 2 : freq.NumRows() / 2;
+  for (size_t i = 1; i < n; ++i) {
+    scaling[i] = 2.0;
+  }
+  for (size_t i = 0; i < freq.NumRows(); ++i) {
+    freq(i) *= scaling[i];
+  }
+  const AMatrix<std::complex<double>> hilbert =
+      FastFourierTransform::Inverse1d(fft_manager, freq);
+
+  AMatrix<double> env(rows, 1);
+  for (size_t i = 0; i < rows; ++i) {
+    env(i) = std::abs(hilbert(i)) + mean;
+  }
+  return env;
+}
+
+// A deterministic test signal with a DC offset and broadband content.
+AMatrix<double> TestSignal(size_t length) {
+  AMatrix<double> signal(length, 1);
+  for (size_t i = 0; i < length; ++i) {
+    signal(i) = 0.25 + 0.5 * std::sin(0.013 * i) + 0.3 * std::sin(1.7 * i) +
+                ((i * 7919) % 101) / 404.0;
+  }
+  return signal;
+}
+
+void ExpectMatchesFftUpperEnv(size_t length) {
+  const AMatrix<double> signal = TestSignal(length);
+  const AMatrix<double> expected = FftUpperEnv(signal);
+  const AMatrix<double> actual = Envelope::CalcUpperEnv(signal);
+  ASSERT_EQ(expected.NumRows(), actual.NumRows());
+  double max_magnitude = 0.0;
+  for (size_t i = 0; i < length; ++i) {
+    max_magnitude = std::max(max_magnitude, std::abs(expected(i)));
+  }
+  for (size_t i = 0; i < length; ++i) {
+    ASSERT_NEAR(expected(i), actual(i), kRelativeTolerance * max_magnitude)
+        << "length " << length << ", sample " << i;
+  }
+}
+
+// Test the streaming envelope against the FFT envelope for short signals,
+// covering both odd and even lengths and lengths below the minimum FFT size.
+TEST(EnvelopeTest, MatchesFftUpperEnvShortSignals) {
+  for (size_t length = 1; length <= 70; ++length) {
+    ExpectMatchesFftUpperEnv(length);
+  }
+}
+
+// Test the streaming envelope against the FFT envelope for long signals, both
+// with and without zero padding to the FFT size.
+TEST(EnvelopeTest, MatchesFftUpperEnvLongSignals) {
+  ExpectMatchesFftUpperEnv(1 << 17);
+  ExpectMatchesFftUpperEnv(200001);
+}
+
+}  // namespace
+}  // namespace Visqol
@@ -0,0 +1,80 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "manifest_reader.h"
+
+#include <fstream>
+#include <string>
+
+#include "file_path.h"
+#include "gtest/gtest.h"
+
+namespace Visqol {
+namespace {
+
+// Test to ensure that the example batch file can be read one pair at a time.
+TEST(ManifestReader, ExampleBatchFile) {
+  auto reader_or =
+      ManifestReader::Open(FilePath("testdata/example_batch/batch_input.csv"));
+  ASSERT_TRUE(reader_or.ok());
+  auto reader = std::move(reader_or).value();
+
+  ReferenceDegradedPathPair pair;
+  ASSERT_TRUE(reader->Next(&pair));
+  ASSERT_EQ("ref_1.wav", pair.reference.Path());
+  ASSERT_EQ("deg_1.wav", pair.degraded.Path());
+  ASSERT_TRUE(reader->Next(&pair));
+  ASSERT_EQ("ref_2.wav", pair.reference.Path());
+  ASSERT_EQ("deg_2.wav", pair.degraded.Path());
+  ASSERT_FALSE(reader->Next(&pair));
+}
+
+// Test that rows which are not exactly two columns do not stop the reader.
+TEST(ManifestReader, MalformedRows) {
+  const std::string path = ::testing::TempDir() + "/malformed_manifest.csv";
+  {
+    std::ofstream file(path);
+    file << "reference,degraded\r\n"
+         << "ref_1.wav,deg_1.wav\r\n"
+         << "\r\n"
+         << "only_one_column.wav\n"
+         << "ref_2.wav,deg_2.wav,extra,columns\n"
+         << "ref_3.wav,deg_3.wav";
+  }
+  auto reader_or = ManifestReader::Open(FilePath(path));
+  ASSERT_TRUE(reader_or.ok());
+  auto reader = std::move(reader_or).value();
+
+  ReferenceDegradedPathPair pair;
+  ASSERT_TRUE(reader->Next(&pair));
+  ASSERT_EQ("ref_1.wav", pair.reference.Path());
+  ASSERT_EQ("deg_1.wav", pair.degraded.Path());
+  ASSERT_TRUE(reader->Next(&pair));
+  ASSERT_EQ("ref_2.wav", pair.reference.Path());
+  ASSERT_EQ("deg_2.wav", pair.degraded.Path());
+  ASSERT_TRUE(reader->Next(&pair));
+  ASSERT_EQ("ref_3.wav", pair.reference.Path());
+  ASSERT_EQ("deg_3.wav", pair.degraded.Path());
+  ASSERT_FALSE(reader->Next(&pair));
+}
+
+// Test that a missing manifest file is reported as an error.
+TEST(ManifestReader, MissingFile) {
+  auto reader_or = ManifestReader::Open(FilePath("non/existent/file.csv"));
+  ASSERT_FALSE(reader_or.ok());
+  ASSERT_EQ(absl::StatusCode::kNotFound, reader_or.status().code());
+}
+
+}  // namespace
+}  // namespace Visqol
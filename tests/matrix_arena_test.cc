@@ -0,0 +1,97 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "matrix_arena.h"
+
+#include <cstdint>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <valarray>
+
+#include "amatrix.h"
+#include "gtest/gtest.h"
+
+namespace Visqol {
+namespace {
+
+bool IsAligned(const void* memory) {
+  return reinterpret_cast<uintptr_t>(memory) % MatrixArena::kAlignment == 0;
+}
+
+// Test that released memory is only pooled within a scope, and is freed when
+// the outermost scope ends.
+TEST(MatrixArena, PoolsWithinScope) {
+  void* memory = MatrixArena::Allocate(1000);
+  ASSERT_TRUE(IsAligned(memory));
+  MatrixArena::Release(memory);
+  ASSERT_EQ(0, MatrixArena::PooledBytes());
+
+  {
+    MatrixArena::Scope scope;
+    memory = MatrixArena::Allocate(1000);
+    MatrixArena::Release(memory);
+    ASSERT_EQ(1024, MatrixArena::PooledBytes());
+    {
+      MatrixArena::Scope nested_scope;
+      // Memory of a similar size is reused.
+      void* reused = MatrixArena::Allocate(900);
+      ASSERT_EQ(memory, reused);
+      ASSERT_EQ(0, MatrixArena::PooledBytes());
+      MatrixArena::Release(reused);
+    }
+    ASSERT_EQ(1024, MatrixArena::PooledBytes());
+
+    // Large allocations are never pooled.
+    memory = MatrixArena::Allocate(MatrixArena::kMaxBlockBytes + 1);
+    ASSERT_TRUE(IsAligned(memory));
+    MatrixArena::Release(memory);
+    ASSERT_EQ(1024, MatrixArena::PooledBytes());
+  }
+  ASSERT_EQ(0, MatrixArena::PooledBytes());
+}
+
+// Test that memory allocated outside a scope is not pooled when it is released
+// within one, since it was not rounded up to a pooled block size.
+TEST(MatrixArena, AllocationsOutsideScopeAreNotPooled) {
+  void* memory = MatrixArena::Allocate(1000);
+  ASSERT_TRUE(IsAligned(memory));
+  {
+    MatrixArena::Scope scope;
+    MatrixArena::Release(memory);
+    ASSERT_EQ(0, MatrixArena::PooledBytes());
+  }
+}
+
+// Test that matrices can outlive the scope they were created in, and be
+// released on another thread.
+TEST(MatrixArena, MatricesOutliveScope) {
+  AMatrix<double> matrix;
+  {
+    MatrixArena::Scope scope;
+    AMatrix<double> temporary(std::valarray<double>(1.0, 1000));
+    matrix = temporary * 2.0;
+  }
+  ASSERT_EQ(1000, matrix.NumElements());
+  ASSERT_EQ(2.0, matrix(999));
+
+  std::thread thread([matrix = std::move(matrix)]() mutable {
+    MatrixArena::Scope scope;
+    { const AMatrix<double> released = std::move(matrix); }
+    EXPECT_EQ(8192, MatrixArena::PooledBytes());
+  });
+  thread.join();
+  ASSERT_EQ(0, MatrixArena::PooledBytes());
+}
+
+}  // namespace
+}  // namespace Visqol
@@ -14,8 +14,26 @@
 
 #include "misc_audio.h"
 
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
 #include "file_path.h"
 #include "gtest/gtest.h"
+#include "misc_math.h"
+#include "wav_reader.h"
 
 namespace Visqol {
 namespace {
@@ -79,5 +97,325 @@ TEST(LoadAsMono, Stereo) {
               kDurationTolerance);
 }
 
+// A stream buffer that can only be read forwards, like a pipe.
+class ForwardOnlyStreamBuf : public std::streambuf {
+ public:
+  explicit ForwardOnlyStreamBuf(const std::string& data) : data_(data) {
+    char* begin = const_cast<char*>(data_.data());
+    setg(begin, begin, begin + data_.size());
+  }
+
+ private:
+  const std::string& data_;
+};
+
+std::string ReadTestFile(const std::string& path) {
+  std::ifstream wav_file(path, std::ios::binary);
+  std::stringstream contents;
+  contents << wav_file.rdbuf();
+  return contents.str();
+}
+
+// Load the samples in full, then normalize and downmix them separately, as
+// the samples were loaded before the reader downmixed them block by block.
+std::vector<double> LoadInterleavedAsMono(const std::string& data) {
+  std::stringstream stream(data);
+  WavReader wav_reader(&stream);
+  std::vector<int16_t> samples(wav_reader.GetNumTotalSamples(), 0);
+  wav_reader.ReadSamples(samples.size(), samples.data());
+  const std::vector<double> normalized =
+      MiscMath::NormalizeInt16ToDouble(samples);
+  const size_t num_channels = wav_reader.GetNumChannels();
+  std::vector<double> mono(normalized.size() / num_channels, 0.0);
+  for (size_t chan = 0; chan < num_channels; chan++) {
+    for (size_t frame = 0; frame < mono.size(); frame++) {
+      mono[frame] += normalized[frame * num_channels + chan];
+    }
+  }
+  if (num_channels > 1) {
+    for (double& sample : mono) {
+      sample /= num_channels;
+    }
+  }
+  return mono;
+}
+
+// Test that the block by block downmix gives exactly the same signal as
+// downmixing all the samples at once, from a stream and from memory, for
+// stereo audio and for audio that is shorter than its header says.
+TEST(LoadAsMono, BlocksMatchInterleaved) {
+  const std::string wav_data = ReadTestFile(
+      "testdata/conformance_testdata_subset/guitar48_stereo.wav");
+
+  for (const size_t truncate_bytes : {size_t{0}, size_t{1000}}) {
+    const std::string data =
+        wav_data.substr(0, wav_data.size() - truncate_bytes);
+    const std::vector<double> expected = LoadInterleavedAsMono(data);
+    std::stringstream stream(data);
+    const auto from_stream = MiscAudio::LoadAsMono(&stream);
+    const auto from_memory =
+        MiscAudio::LoadAsMono(absl::Span<const char>(data.data(), data.size()));
+    ASSERT_EQ(kStereoTestNumRows, from_stream.data_matrix.NumRows());
+    ASSERT_EQ(kStereoTestNumCols, from_stream.data_matrix.NumCols());
+    ASSERT_EQ(expected, from_stream.data_matrix.ToVector());
+    ASSERT_EQ(expected, from_memory.data_matrix.ToVector());
+  }
+}
+
+// Test that a stream that cannot seek, and that does not give the length of
+// its data, is read until it ends.
+TEST(LoadAsMono, ForwardOnlyStreamOfUnknownLength) {
+  const std::string wav_data = ReadTestFile(
+      "testdata/conformance_testdata_subset/guitar48_stereo.wav");
+  const std::vector<double> expected = LoadInterleavedAsMono(wav_data);
+
+  std::string unknown_length_data = wav_data;
+  const size_t data_chunk = unknown_length_data.find("data");
+  ASSERT_NE(std::string::npos, data_chunk);
+  unknown_length_data.replace(data_chunk + 4, 4, "\xff\xff\xff\xff");
+
+  for (const std::string& data : {wav_data, unknown_length_data}) {
+    ForwardOnlyStreamBuf stream_buf(data);
+    std::istream stream(&stream_buf);
+    const auto from_stream = MiscAudio::LoadAsMono(&stream);
+    ASSERT_EQ(kStereoTestsample_rate, from_stream.sample_rate);
+    ASSERT_EQ(expected, from_stream.data_matrix.ToVector());
+  }
+}
+
+// Encode a value as little endian bytes.
+template <typename T>
+std::string Encode(T value, size_t num_bytes = sizeof(T)) {
+  std::string bytes(reinterpret_cast<const char*>(&value), sizeof(T));
+  return bytes.substr(0, num_bytes);
+}
+
+// Make a WAV file with the given format and little endian sample data. An
+// extensible file also gets a "fact" chunk.
+std::string MakeWav(uint16_t format_tag, uint16_t bits_per_sample,
+                    uint16_t num_channels, const std::string& data,
+                    bool extensible) {
+  const uint32_t sample_rate = 48000;
+  const uint16_t block_align = num_channels * bits_per_sample / 8;
+  std::string format = Encode<uint16_t>(extensible ? 0xfffe : format_tag) +
+                       Encode(num_channels) + Encode(sample_rate) +
+                       Encode<uint32_t>(sample_rate * block_align) +
+                       Encode(block_align) + Encode(bits_per_sample);
+  std::string fact;
+  if (extensible) {
+    // The extension holds the valid bits, the channel mask and the
+    // sub-format GUID, which starts with the format tag.
+    format += Encode<uint16_t>(22) + Encode(bits_per_sample) +
+              Encode<uint32_t>(0) + Encode(format_tag) +
+              std::string("\x00\x00\x00\x00\x10\x00\x80\x00\x00\xaa"
+                          "\x00\x38\x9b\x71",
+                          14);
+    fact = "fact" + Encode<uint32_t>(4) +
+           Encode<uint32_t>(data.size() / block_align);
+  }
+  const std::string chunks = "fmt " + Encode<uint32_t>(format.size()) +
+                             format + fact + "data" +
+                             Encode<uint32_t>(data.size()) + data;
+  return "RIFF" + Encode<uint32_t>(chunks.size() + 4) + "WAVE" + chunks;
+}
+
+// Test that 24 and 32-bit integer and 32 and 64-bit float samples, in plain
+// and extensible WAV files, give exactly the same signal as the 16-bit
+// samples they were converted from.
+TEST(LoadAsMono, WideSampleFormats) {
+  const uint16_t kPcm = 1;
+  const uint16_t kFloat = 3;
+  const uint16_t kNumChannels = 2;
+  std::string int16_data, int24_data, int32_data, float32_data, float64_data;
+  for (int i = 0; i < 3000; i++) {
+    const int16_t sample = static_cast<int16_t>((i * 7919) % 65536 - 32768);
+    int16_data += Encode(sample);
+    int24_data += Encode<int32_t>(sample * 256, 3);
+    int32_data += Encode<int32_t>(sample * 65536);
+    float32_data += Encode<float>(sample / 32768.0f);
+    float64_data += Encode<double>(sample / 32768.0);
+  }
+  const std::string int16_wav =
+      MakeWav(kPcm, 16, kNumChannels, int16_data, false);
+  const std::vector<double> expected = LoadInterleavedAsMono(int16_wav);
+  ASSERT_EQ(1500, expected.size());
+
+  for (const bool extensible : {false, true}) {
+    for (const std::string& wav :
+         {MakeWav(kPcm, 16, kNumChannels, int16_data, extensible),
+          MakeWav(kPcm, 24, kNumChannels, int24_data, extensible),
+          MakeWav(kPcm, 32, kNumChannels, int32_data, extensible),
+          MakeWav(kFloat, 32, kNumChannels, float32_data, extensible),
+          MakeWav(kFloat, 64, kNumChannels, float64_data, extensible)}) {
+      const auto signal =
+          MiscAudio::LoadAsMono(absl::Span<const char>(wav.data(), wav.size()));
+      ASSERT_EQ(48000, signal.sample_rate);
+      ASSERT_EQ(expected, signal.data_matrix.ToVector());
+    }
+  }
+}
+
+// Test that raw samples in each format give the same signal as the WAV file
+// with the same samples, when read from a stream that cannot seek.
+TEST(LoadRawPcmAsMono, MatchesWav) {
+  const uint16_t kNumChannels = 2;
+  std::string int16_data, int24_data, int32_data, float32_data, float64_data;
+  for (int i = 0; i < 3001; i++) {
+    const int16_t sample = static_cast<int16_t>((i * 7919) % 65536 - 32768);
+    int16_data += Encode(sample);
+    int24_data += Encode<int32_t>(sample * 256, 3);
+    int32_data += Encode<int32_t>(sample * 65536);
+    float32_data += Encode<float>(sample / 32768.0f);
+    float64_data += Encode<double>(sample / 32768.0);
+  }
+  // The last frame is incomplete, and has its missing sample set to zero.
+  const std::vector<double> expected = LoadInterleavedAsMono(
+      MakeWav(1, 16, kNumChannels, int16_data + Encode<int16_t>(0), false));
+  ASSERT_EQ(1501, expected.size());
+
+  const std::vector<std::pair<std::string, std::string>> formats{
+      {"s16le", int16_data},   {"s24le", int24_data},
+      {"s32le", int32_data},   {"f32le", float32_data},
+      {"f64le", float64_data}};
+  for (const auto& format_and_data : formats) {
+    WavReader::PcmFormat format;
+    format.sample_rate_hz = 44100;
+    format.num_channels = kNumChannels;
+    ASSERT_TRUE(WavReader::ParseSampleFormat(format_and_data.first,
+                                             &format.sample_format));
+    ForwardOnlyStreamBuf stream_buf(format_and_data.second);
+    std::istream stream(&stream_buf);
+    const auto signal = MiscAudio::LoadRawPcmAsMono(&stream, format);
+    ASSERT_EQ(44100, signal.sample_rate);
+    ASSERT_EQ(expected, signal.data_matrix.ToVector());
+  }
+}
+
+// Test that raw PCM input without a valid format gives an empty signal.
+TEST(LoadRawPcmAsMono, InvalidFormat) {
+  WavReader::SampleFormat sample_format;
+  ASSERT_FALSE(WavReader::ParseSampleFormat("u8", &sample_format));
+
+  WavReader::PcmFormat format;
+  format.sample_rate_hz = 48000;
+  std::istringstream stream(std::string(100, '\0'));
+  const auto signal = MiscAudio::LoadRawPcmAsMono(&stream, format);
+  ASSERT_EQ(0, signal.data_matrix.NumElements());
+}
+
+// Test that unsupported sample formats are rejected.
+TEST(LoadAsMono, UnsupportedSampleFormat) {
+  const std::string wav = MakeWav(1, 8, 1, std::string(100, '\x80'), false);
+  const auto signal =
+      MiscAudio::LoadAsMono(absl::Span<const char>(wav.data(), wav.size()));
+  ASSERT_EQ(0, signal.data_matrix.NumElements());
+}
+
+// Test that each frame of interleaved samples is averaged, for the channel
+// counts that have their own loops and for any other.
+TEST(InterleavedToMono, AveragesFrames) {
+  const std::vector<int16_t> samples{-32768, 16384, 0, 8192, 32767, -4096};
+  for (const size_t num_channels : {size_t{1}, size_t{2}, size_t{3}}) {
+    std::vector<double> mono(samples.size() / num_channels);
+    MiscAudio::InterleavedToMono(samples, num_channels, absl::MakeSpan(mono));
+    for (size_t frame = 0; frame < mono.size(); frame++) {
+      double sum = 0.0;
+      for (size_t chan = 0; chan < num_channels; chan++) {
+        sum += samples[frame * num_channels + chan] / 32768.0;
+      }
+      ASSERT_EQ(sum / num_channels, mono[frame]);
+    }
+  }
+}
+
+// Test that FLAC files are decoded to exactly the same signal as the WAV
+// files they were encoded from, for mono and stereo audio.
+TEST(LoadAsMono, FlacMatchesWav) {
+  for (const std::string path :
+       {"testdata/clean_speech/CA01_01",
+        "testdata/short_duration/1_second/guitar48_stereo_1_sec"}) {
+    const auto wav_audio = MiscAudio::LoadAsMono(FilePath(path + ".wav"));
+    const auto flac_audio = MiscAudio::LoadAsMono(FilePath(path + ".flac"));
+    ASSERT_EQ(wav_audio.sample_rate, flac_audio.sample_rate);
+    ASSERT_EQ(MiscAudio::kNumChanMono, flac_audio.data_matrix.NumCols());
+    ASSERT_EQ(wav_audio.data_matrix.ToVector(),
+              flac_audio.data_matrix.ToVector());
+  }
+}
+
+// Test that a FLAC stream that cannot seek is decoded, whether or not its
+// metadata gives its length.
+TEST(LoadAsMono, FlacForwardOnlyStream) {
+  const std::vector<double> expected =
+      MiscAudio::LoadAsMono(FilePath("testdata/clean_speech/CA01_01.wav"))
+          .data_matrix.ToVector();
+  const std::string flac_data =
+      ReadTestFile("testdata/clean_speech/CA01_01.flac");
+
+  // Clear the 36 bit sample count at the end of the STREAMINFO fields.
+  std::string unknown_length_data = flac_data;
+  unknown_length_data[21] &= 0xf0;
+  unknown_length_data.replace(22, 4, 4, '\0');
+
+  for (const std::string& data : {flac_data, unknown_length_data}) {
+    ForwardOnlyStreamBuf stream_buf(data);
+    std::istream stream(&stream_buf);
+    const auto from_stream = MiscAudio::LoadAsMono(&stream);
+    ASSERT_EQ(kMonoTestsample_rate, from_stream.sample_rate);
+    ASSERT_EQ(expected, from_stream.data_matrix.ToVector());
+  }
+}
+
+// Test that decoding stops at a corrupted FLAC frame, and that the rest of
+// the signal is silent.
+TEST(LoadAsMono, CorruptFlacFrame) {
+  const std::vector<double> expected =
+      MiscAudio::LoadAsMono(FilePath("testdata/clean_speech/CA01_01.wav"))
+          .data_matrix.ToVector();
+  std::string flac_data = ReadTestFile("testdata/clean_speech/CA01_01.flac");
+  flac_data[flac_data.size() / 2] ^= 0x10;
+
+  const auto audio = MiscAudio::LoadAsMono(
+      absl::Span<const char>(flac_data.data(), flac_data.size()));
+  const std::vector<double> samples = audio.data_matrix.ToVector();
+  ASSERT_EQ(expected.size(), samples.size());
+  ASSERT_NE(expected, samples);
+  ASSERT_TRUE(std::equal(samples.begin(), samples.begin() + 4096,
+                         expected.begin()));
+  ASSERT_EQ(0.0, samples.back());
+}
+
+// Test that a missing file gives an empty signal.
+TEST(LoadAsMono, MissingFile) {
+  auto wavreader_audio = MiscAudio::LoadAsMono(FilePath("non/existent.wav"));
+  ASSERT_EQ(0, wavreader_audio.data_matrix.NumElements());
+}
+
+#ifndef _WIN32
+// Test that a named pipe is read as a stream, and opened only once, so that
+// none of the data its writer sends is lost.
+TEST(LoadAsMono, NamedPipe) {
+  const std::string wav_path = "testdata/clean_speech/CA01_01.wav";
+  const std::string data = ReadTestFile(wav_path);
+  const std::string fifo_path = ::testing::TempDir() + "/load_as_mono.fifo";
+  std::remove(fifo_path.c_str());
+  ASSERT_EQ(0, mkfifo(fifo_path.c_str(), 0600));
+
+  // Opening the pipe for writing waits for the reader to open it.
+  std::thread writer([&fifo_path, &data]() {
+    std::ofstream fifo(fifo_path, std::ios::binary);
+    fifo.write(data.data(), data.size());
+  });
+  const AudioSignal from_fifo = MiscAudio::LoadAsMono(FilePath(fifo_path));
+  writer.join();
+  std::remove(fifo_path.c_str());
+
+  const AudioSignal from_file = MiscAudio::LoadAsMono(FilePath(wav_path));
+  ASSERT_EQ(kMonoTestNumRows, from_fifo.data_matrix.NumRows());
+  ASSERT_EQ(from_file.data_matrix.ToVector(),
+            from_fifo.data_matrix.ToVector());
+}
+#endif
+
 }  // namespace
 }  // namespace Visqol
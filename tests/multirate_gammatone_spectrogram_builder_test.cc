@@ -0,0 +1,109 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "multirate_gammatone_spectrogram_builder.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "analysis_window.h"
+#include "file_path.h"
+#include "gammatone_filterbank.h"
+#include "gammatone_spectrogram_builder.h"
+#include "gtest/gtest.h"
+#include "misc_audio.h"
+#include "spectrogram.h"
+
+namespace Visqol {
+namespace {
+
+const double kMinimumFreq = 50;
+const size_t kNumBandsAudio = 32;
+const size_t kNumBandsSpeech = 21;
+const double kOverlap = 0.25;
+
+// Band energies this far below the loudest band in their frame are under the
+// per-frame noise floor of the comparison, and are not compared.
+const double kDynamicRangeDb = 45.0;
+
+// The band energies of the multirate builder must be within this many dB of
+// the single rate builder on average, and nearly always within
+// kOutlierToleranceDb.
+const double kMeanToleranceDb = 0.1;
+const double kOutlierToleranceDb = 1.0;
+const double kMaxOutlierFraction = 0.005;
+
+// Build the spectrogram of the signal with both builders and compare the band
+// energies.
+void ExpectMatchesSingleRate(const AudioSignal& signal, size_t num_bands,
+                             bool use_speech_mode) {
+  const GammatoneFilterBank filter_bank{num_bands, kMinimumFreq};
+  const AnalysisWindow window{signal.sample_rate, kOverlap};
+  GammatoneSpectrogramBuilder single_rate(filter_bank, use_speech_mode);
+  MultirateGammatoneSpectrogramBuilder multirate(filter_bank, use_speech_mode);
+  const Spectrogram expected = single_rate.Build(signal, window).value();
+  const Spectrogram actual = multirate.Build(signal, window).value();
+
+  ASSERT_EQ(expected.Data().NumRows(), actual.Data().NumRows());
+  ASSERT_EQ(expected.Data().NumCols(), actual.Data().NumCols());
+  ASSERT_EQ(expected.GetCenterFreqBands(), actual.GetCenterFreqBands());
+
+  const double min_ratio = std::pow(10.0, -kDynamicRangeDb / 20.0);
+  double total_error = 0.0;
+  size_t num_compared = 0;
+  size_t num_outliers = 0;
+  for (size_t col = 0; col < expected.Data().NumCols(); col++) {
+    double loudest = 0.0;
+    for (size_t band = 0; band < num_bands; band++) {
+      loudest = std::max(loudest, expected.Data()(band, col));
+    }
+    for (size_t band = 0; band < num_bands; band++) {
+      const double expected_energy = expected.Data()(band, col);
+      if (expected_energy <= loudest * min_ratio) {
+        continue;
+      }
+      const double error = std::abs(
+          20 * std::log10(actual.Data()(band, col) / expected_energy));
+      total_error += error;
+      num_compared++;
+      if (error > kOutlierToleranceDb) {
+        num_outliers++;
+      }
+    }
+  }
+  ASSERT_LT(0, num_compared);
+  ASSERT_GT(kMeanToleranceDb, total_error / num_compared);
+  ASSERT_GT(kMaxOutlierFraction,
+            static_cast<double>(num_outliers) / num_compared);
+}
+
+// Test that the band energies match the single rate builder in audio mode.
+TEST(MultirateGammatoneSpectrogramBuilder, MatchesSingleRateAudio) {
+  const AudioSignal signal = MiscAudio::LoadAsMono(
+      FilePath("testdata/conformance_testdata_subset/"
+               "contrabassoon48_stereo.wav"));
+  ExpectMatchesSingleRate(signal, kNumBandsAudio, false);
+}
+
+// Test that the band energies match the single rate builder in speech mode,
+// where the highest band is well below the Nyquist frequency.
+TEST(MultirateGammatoneSpectrogramBuilder, MatchesSingleRateSpeech) {
+  const AudioSignal signal =
+      MiscAudio::LoadAsMono(FilePath("testdata/clean_speech/CA01_01.wav"));
+  ExpectMatchesSingleRate(signal, kNumBandsSpeech, true);
+}
+
+}  // namespace
+}  // namespace Visqol
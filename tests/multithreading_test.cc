@@ -104,5 +104,45 @@ TEST(MultithreadingTest, DifferentInput) {
   thread_2.join();
 }
 
+// Run two visqol tests simultaneously on clones of one manager, which share
+// its loaded model.
+TEST(MultithreadingTest, ClonedManagers) {
+  const Visqol::CommandLineArgs cmd_args = CommandLineArgsHelper(
+      "testdata/conformance_testdata_subset/"
+      "guitar48_stereo.wav",
+      "testdata/conformance_testdata_subset/"
+      "guitar48_stereo_64kbps_aac.wav");
+  auto files_to_compare = VisqolCommandLineParser::BuildFilePairPaths(cmd_args);
+
+  Visqol::VisqolManager visqol;
+  auto status = visqol.Init(kDefaultModel, false, false, 60);
+  ASSERT_TRUE(status.ok());
+
+  auto clone_1 = visqol.Clone();
+  auto clone_2 = visqol.Clone();
+  ASSERT_TRUE(clone_1.ok());
+  ASSERT_TRUE(clone_2.ok());
+
+  auto run_clone = [&files_to_compare](VisqolManager* manager) {
+    auto status_or = manager->Run(files_to_compare[0].reference,
+                                  files_to_compare[0].degraded);
+    ASSERT_TRUE(status_or.ok());
+    ASSERT_NEAR(kConformanceGuitar64aac, status_or.value().moslqo(),
+                kTolerance);
+  };
+  std::thread thread_1(run_clone, clone_1.value().get());
+  std::thread thread_2(run_clone, clone_2.value().get());
+  thread_1.join();
+  thread_2.join();
+}
+
+// Cloning a manager that has not been initialized fails.
+TEST(MultithreadingTest, CloneWithoutInit) {
+  Visqol::VisqolManager visqol;
+  auto clone = visqol.Clone();
+  ASSERT_FALSE(clone.ok());
+  ASSERT_EQ(absl::StatusCode::kAborted, clone.status().code());
+}
+
 }  // namespace
 }  // namespace Visqol
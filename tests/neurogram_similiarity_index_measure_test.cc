@@ -0,0 +1,71 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "neurogram_similiarity_index_measure.h"
+
+#include <cmath>
+#include <vector>
+
+#include "amatrix.h"
+#include "gtest/gtest.h"
+#include "image_patch_creator.h"
+
+namespace Visqol {
+namespace {
+
+const size_t kNumBands = 32;
+const size_t kNumFrames = 20;
+
+// Builds a patch of smoothly varying levels, in the range of a spectrogram
+// after its floor has been subtracted.
+ImagePatch MakePatch(double phase) {
+  std::vector<double> data(kNumBands * kNumFrames);
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = 30.0 + 20.0 * std::sin(0.37 * i + phase);
+  }
+  return ImagePatch(kNumBands, kNumFrames, std::move(data));
+}
+
+// Test that identical patches are perfectly similar.
+TEST(NeurogramSimiliarityIndexMeasure, IdenticalPatches) {
+  const ImagePatch patch = MakePatch(0.0);
+  const PatchSimilarityResult result =
+      NeurogramSimiliarityIndexMeasure().MeasurePatchSimilarity(patch, patch);
+  EXPECT_NEAR(1.0, result.similarity, 1e-12);
+  ASSERT_EQ(kNumBands, result.freq_band_means.NumRows());
+  for (size_t band = 0; band < kNumBands; band++) {
+    EXPECT_NEAR(1.0, result.freq_band_means(band), 1e-12);
+  }
+}
+
+// Test that shifted patches are less similar, and that the degraded energy
+// of each band is the mean of the degraded patch over that band.
+TEST(NeurogramSimiliarityIndexMeasure, DifferentPatches) {
+  const ImagePatch ref_patch = MakePatch(0.0);
+  const ImagePatch deg_patch = MakePatch(0.4);
+  const PatchSimilarityResult result =
+      NeurogramSimiliarityIndexMeasure().MeasurePatchSimilarity(ref_patch,
+                                                                deg_patch);
+  ASSERT_LT(result.similarity, 0.99);
+  ASSERT_EQ(kNumBands, result.freq_band_deg_energy.NumRows());
+  for (size_t band = 0; band < kNumBands; band++) {
+    double energy = 0.0;
+    for (size_t frame = 0; frame < kNumFrames; frame++) {
+      energy += deg_patch(band, frame);
+    }
+    EXPECT_NEAR(energy / kNumFrames, result.freq_band_deg_energy(band), 1e-9);
+  }
+}
+
+}  // namespace
+}  // namespace Visqol
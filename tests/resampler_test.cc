@@ -0,0 +1,94 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "resampler.h"
+
+#include <cmath>
+#include <vector>
+
+#include "amatrix.h"
+#include "audio_signal.h"
+#include "gtest/gtest.h"
+
+namespace Visqol {
+namespace {
+
+const double kToneFreq = 1000.0;
+
+// A sine tone of the given frequency, one second long.
+AudioSignal MakeTone(double freq, size_t sample_rate) {
+  std::vector<double> samples(sample_rate);
+  for (size_t i = 0; i < samples.size(); i++) {
+    samples[i] = std::sin(2.0 * M_PI * freq * i / sample_rate);
+  }
+  return AudioSignal{AMatrix<double>(samples), sample_rate};
+}
+
+// Test that a signal at the output rate is returned unchanged.
+TEST(Resampler, SameRate) {
+  const AudioSignal tone = MakeTone(kToneFreq, 48000);
+  const AudioSignal resampled = Resampler::Resample(tone, 48000);
+  ASSERT_EQ(48000, resampled.sample_rate);
+  ASSERT_EQ(tone.data_matrix.ToVector(), resampled.data_matrix.ToVector());
+}
+
+// Test that a tone in the passband is the same tone at the new rate, away
+// from the edges of the signal, when upsampling and downsampling, and with
+// coprime rates whose filter phases are interpolated.
+TEST(Resampler, TonePassesThrough) {
+  for (const auto& rates : std::vector<std::pair<size_t, size_t>>{
+           {44100, 48000},
+           {48000, 16000},
+           {8000, 16000},
+           {44099, 48000},
+           {48000, 44099}}) {
+    const AudioSignal tone = MakeTone(kToneFreq, rates.first);
+    const AudioSignal resampled = Resampler::Resample(tone, rates.second);
+    const AudioSignal expected = MakeTone(kToneFreq, rates.second);
+    ASSERT_EQ(rates.second, resampled.sample_rate);
+    ASSERT_EQ(rates.second, resampled.data_matrix.NumRows());
+    for (size_t i = rates.second / 10; i < rates.second * 9 / 10; i++) {
+      ASSERT_NEAR(expected.data_matrix(i), resampled.data_matrix(i), 1e-3)
+          << rates.first << " to " << rates.second << " at " << i;
+    }
+  }
+}
+
+// Test that a tone above the output Nyquist frequency is removed rather than
+// aliased when downsampling.
+TEST(Resampler, RemovesAliases) {
+  const AudioSignal tone = MakeTone(12000.0, 48000);
+  const AudioSignal resampled = Resampler::Resample(tone, 16000);
+  for (size_t i = 1600; i < 14400; i++) {
+    ASSERT_NEAR(0.0, resampled.data_matrix(i), 1e-3);
+  }
+}
+
+// Test that each channel is resampled separately.
+TEST(Resampler, Channels) {
+  const AudioSignal tone = MakeTone(kToneFreq, 44100);
+  const AMatrix<double> stereo(
+      std::vector<std::vector<double>>{tone.data_matrix.ToVector(),
+                                       (tone.data_matrix * 0.5).ToVector()});
+  const AMatrix<double> resampled = Resampler::Resample(stereo, 44100, 48000);
+  ASSERT_EQ(2, resampled.NumCols());
+  ASSERT_EQ(48000, resampled.NumRows());
+  for (size_t i = 0; i < resampled.NumRows(); i++) {
+    ASSERT_DOUBLE_EQ(resampled(i, 0) * 0.5, resampled(i, 1));
+  }
+}
+
+}  // namespace
+}  // namespace Visqol
@@ -0,0 +1,212 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "result_cache.h"
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <fstream>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "absl/types/span.h"
+#include "file_path.h"
+#include "gtest/gtest.h"
+#include "src/proto/similarity_result.pb.h"  // Generated by cc_proto_library rule
+
+namespace Visqol {
+namespace {
+
+std::string LittleEndian32(uint32_t value) {
+  std::string bytes(4, '\0');
+  for (size_t i = 0; i < 4; i++) {
+    bytes[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+  }
+  return bytes;
+}
+
+std::string Chunk(const std::string& id, const std::string& body) {
+  std::string chunk = id + LittleEndian32(body.size()) + body;
+  if (body.size() % 2 == 1) {
+    chunk += '\0';
+  }
+  return chunk;
+}
+
+// Build a mono 16 bit WAV file with the given samples and optionally a
+// metadata chunk before the sample data.
+std::string MakeWav(const std::string& samples,
+                    const std::string& metadata = "") {
+  const std::string fmt = std::string("\x01\x00\x01\x00", 4) +
+                          LittleEndian32(48000) + LittleEndian32(96000) +
+                          std::string("\x02\x00\x10\x00", 4);
+  std::string body = "WAVE" + Chunk("fmt ", fmt);
+  if (!metadata.empty()) {
+    body += Chunk("LIST", metadata);
+  }
+  body += Chunk("data", samples);
+  return "RIFF" + LittleEndian32(body.size()) + body;
+}
+
+absl::Span<const char> AsSpan(const std::string& contents) {
+  return absl::Span<const char>(contents.data(), contents.size());
+}
+
+// Test that the digest depends on the audio content but not on the metadata.
+TEST(ResultCache, AudioDigestIgnoresMetadata) {
+  const std::string samples("\x01\x00\x02\x00\x03\x00", 6);
+  const std::string plain = ResultCache::AudioDigest(AsSpan(MakeWav(samples)));
+  const std::string tagged =
+      ResultCache::AudioDigest(AsSpan(MakeWav(samples, "INFOcomment")));
+  const std::string other = ResultCache::AudioDigest(
+      AsSpan(MakeWav(std::string("\x01\x00\x02\x00\x04\x00", 6))));
+  ASSERT_EQ(plain, tagged);
+  ASSERT_NE(plain, other);
+  ASSERT_EQ(32, plain.size());
+}
+
+// Test that the content digest depends on every byte, including trailing
+// zeros and bytes beyond a whole number of hash blocks.
+TEST(ResultCache, ContentDigestCoversAllBytes) {
+  const std::string contents(37, 'x');
+  const std::string digest = ResultCache::ContentDigest(AsSpan(contents));
+  ASSERT_NE(digest,
+            ResultCache::ContentDigest(AsSpan(contents + std::string(1, 0))));
+  for (size_t i = 0; i < contents.size(); i++) {
+    std::string changed = contents;
+    changed[i] = 'y';
+    ASSERT_NE(digest, ResultCache::ContentDigest(AsSpan(changed))) << i;
+  }
+}
+
+// Test that only regular files are mapped, with their whole content.
+TEST(ResultCache, MapAudioFile) {
+  const std::string path = ::testing::TempDir() + "/mapped.wav";
+  const std::string contents = MakeWav(std::string("\x01\x00", 2));
+  {
+    std::ofstream file(path, std::ios_base::binary);
+    file << contents;
+  }
+  const auto mapped = ResultCache::MapAudioFile(FilePath(path));
+  ASSERT_TRUE(mapped.ok());
+  const absl::Span<const char> mapped_contents = mapped.value()->Contents();
+  ASSERT_EQ(contents,
+            std::string(mapped_contents.data(), mapped_contents.size()));
+
+  ASSERT_FALSE(ResultCache::MapAudioFile(FilePath("non/existent.wav")).ok());
+  ASSERT_FALSE(ResultCache::MapAudioFile(FilePath(::testing::TempDir())).ok());
+}
+
+// Test that a stored result is found by any files with the same audio, and
+// only for the configuration it was stored with.
+TEST(ResultCache, StoreAndLookup) {
+  const std::string cache_dir = ::testing::TempDir() + "/result_cache";
+  std::filesystem::remove_all(cache_dir);
+  auto cache_or = ResultCache::Open(FilePath(cache_dir), "config_a");
+  ASSERT_TRUE(cache_or.ok());
+  const ResultCache cache = cache_or.value();
+
+  const std::string ref_samples("\x10\x00\x20\x00", 4);
+  const std::string deg_samples("\x11\x00\x21\x00", 4);
+  const std::string key =
+      cache.MakeKey(AsSpan(MakeWav(ref_samples)), AsSpan(MakeWav(deg_samples)));
+  ASSERT_FALSE(cache.Lookup(key).has_value());
+
+  SimilarityResultMsg msg;
+  msg.set_moslqo(4.25);
+  msg.add_fvnsim(0.5);
+  ASSERT_TRUE(cache.Store(key, msg).ok());
+
+  // The same audio with different metadata, as in a retagged copy.
+  const std::string tagged_key =
+      cache.MakeKey(AsSpan(MakeWav(ref_samples, "INFOcopy")),
+                    AsSpan(MakeWav(deg_samples, "INFOcopy")));
+  ASSERT_EQ(key, tagged_key);
+  const auto cached = cache.Lookup(tagged_key);
+  ASSERT_TRUE(cached.has_value());
+  ASSERT_EQ(4.25, cached->moslqo());
+  ASSERT_EQ(1, cached->fvnsim_size());
+
+  // Swapping the reference and degraded files is a different comparison.
+  const std::string swapped_key =
+      cache.MakeKey(AsSpan(MakeWav(deg_samples)), AsSpan(MakeWav(ref_samples)));
+  ASSERT_NE(key, swapped_key);
+
+  auto other_config = ResultCache::Open(FilePath(cache_dir), "config_b");
+  ASSERT_TRUE(other_config.ok());
+  const std::string other_key = other_config->MakeKey(
+      AsSpan(MakeWav(ref_samples)), AsSpan(MakeWav(deg_samples)));
+  ASSERT_NE(key, other_key);
+  ASSERT_FALSE(other_config->Lookup(other_key).has_value());
+}
+
+// Test that concurrent writers of the same record leave one complete record
+// and no temporary files.
+TEST(ResultCache, ConcurrentStores) {
+  const std::string cache_dir = ::testing::TempDir() + "/result_cache_mt";
+  std::filesystem::remove_all(cache_dir);
+  auto cache_or = ResultCache::Open(FilePath(cache_dir), "config");
+  ASSERT_TRUE(cache_or.ok());
+  const ResultCache cache = cache_or.value();
+  const std::string key(32, 'a');
+
+  SimilarityResultMsg msg;
+  msg.set_moslqo(3.5);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < 8; t++) {
+    threads.emplace_back([&cache, &key, &msg]() {
+      for (size_t i = 0; i < 20; i++) {
+        ASSERT_TRUE(cache.Store(key, msg).ok());
+        const auto cached = cache.Lookup(key);
+        ASSERT_TRUE(cached.has_value());
+        ASSERT_EQ(3.5, cached->moslqo());
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  size_t num_files = 0;
+  for (const auto& entry :
+       std::filesystem::recursive_directory_iterator(cache_dir)) {
+    num_files += entry.is_regular_file();
+  }
+  ASSERT_EQ(1, num_files);
+}
+
+// Test that opening a cache removes the temporary files of interrupted writes,
+// but not recent ones that a concurrent run may still be writing.
+TEST(ResultCache, OpenRemovesStaleTemporaries) {
+  const std::string cache_dir = ::testing::TempDir() + "/result_cache_tmp";
+  std::filesystem::remove_all(cache_dir);
+  ASSERT_TRUE(ResultCache::Open(FilePath(cache_dir), "config").ok());
+
+  const std::filesystem::path stale = cache_dir + "/tmp/stale";
+  const std::filesystem::path recent = cache_dir + "/tmp/recent";
+  std::ofstream(stale.string()) << "partial";
+  std::ofstream(recent.string()) << "partial";
+  std::filesystem::last_write_time(
+      stale, std::filesystem::file_time_type::clock::now() -
+                 std::chrono::hours(2));
+
+  ASSERT_TRUE(ResultCache::Open(FilePath(cache_dir), "config").ok());
+  ASSERT_FALSE(std::filesystem::exists(stale));
+  ASSERT_TRUE(std::filesystem::exists(recent));
+}
+
+}  // namespace
+}  // namespace Visqol
@@ -0,0 +1,79 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "results_checkpoint.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "file_path.h"
+#include "gtest/gtest.h"
+
+namespace Visqol {
+namespace {
+
+const char kHeader[] = "reference,degraded,moslqo\n";
+const char kCompleteRecords[] =
+    "ref_1.wav,deg_1.wav,4.1\n"
+    "ref_2.wav,deg_2.wav,3.9\n"
+    "ref_1.wav,deg_1.wav,4.1\n";
+
+std::string ReadFile(const FilePath& path) {
+  std::ifstream file(path.Path());
+  std::stringstream ss;
+  ss << file.rdbuf();
+  return ss.str();
+}
+
+// Test that completed records are loaded and a partly written final record
+// is removed from the file.
+TEST(ResultsCheckpoint, LoadAndRepair) {
+  const FilePath path(::testing::TempDir() + "/checkpoint_results.csv");
+  {
+    std::ofstream file(path.Path());
+    file << kHeader << kCompleteRecords << "ref_3.wav,deg_3.wav,2.";
+  }
+
+  auto checkpoint_or = ResultsCheckpoint::Load(path);
+  ASSERT_TRUE(checkpoint_or.ok());
+  ResultsCheckpoint checkpoint = std::move(checkpoint_or).value();
+  ASSERT_EQ(3, checkpoint.NumCompleted());
+  ASSERT_EQ(std::string(kHeader) + kCompleteRecords, ReadFile(path));
+
+  // The duplicated pair was completed twice, so it is skipped twice.
+  const ReferenceDegradedPathPair pair_1{FilePath("ref_1.wav"),
+                                         FilePath("deg_1.wav")};
+  ASSERT_TRUE(checkpoint.ConsumeIfCompleted(pair_1));
+  ASSERT_TRUE(checkpoint.ConsumeIfCompleted(pair_1));
+  ASSERT_FALSE(checkpoint.ConsumeIfCompleted(pair_1));
+  ASSERT_TRUE(checkpoint.ConsumeIfCompleted(
+      {FilePath("ref_2.wav"), FilePath("deg_2.wav")}));
+  ASSERT_FALSE(checkpoint.ConsumeIfCompleted(
+      {FilePath("ref_3.wav"), FilePath("deg_3.wav")}));
+}
+
+// Test that a missing results file is an empty checkpoint.
+TEST(ResultsCheckpoint, MissingFile) {
+  const FilePath path(::testing::TempDir() + "/missing_results.csv");
+  std::remove(path.Path().c_str());
+  auto checkpoint_or = ResultsCheckpoint::Load(path);
+  ASSERT_TRUE(checkpoint_or.ok());
+  ASSERT_EQ(0, checkpoint_or.value().NumCompleted());
+  ASSERT_FALSE(path.Exists());
+}
+
+}  // namespace
+}  // namespace Visqol
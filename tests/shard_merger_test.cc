@@ -0,0 +1,155 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "shard_merger.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "file_path.h"
+#include "gtest/gtest.h"
+#include "manifest_reader.h"
+
+namespace Visqol {
+namespace {
+
+const size_t kNumShards = 3;
+
+void WriteFile(const std::string& path, const std::string& contents) {
+  std::ofstream file(path);
+  file << contents;
+}
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream file(path);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  return contents.str();
+}
+
+// Test that a pair is always assigned to the same shard, and that the shard
+// is in range.
+TEST(ShardMerger, ShardIndexIsStable) {
+  ReferenceDegradedPathPair pair{FilePath("ref_1.wav"), FilePath("deg_1.wav")};
+  const size_t shard = ManifestReader::ShardIndex(pair, kNumShards);
+  ASSERT_GT(kNumShards, shard);
+  ASSERT_EQ(shard, ManifestReader::ShardIndex(pair, kNumShards));
+  ASSERT_EQ(0, ManifestReader::ShardIndex(pair, 1));
+
+  // The pair, not just its concatenation, determines the shard.
+  ReferenceDegradedPathPair swapped{FilePath("deg_1.wav"),
+                                    FilePath("ref_1.wav")};
+  ReferenceDegradedPathPair joined{FilePath("ref_1.wavdeg_1.wav"),
+                                   FilePath("")};
+  ASSERT_NE(ManifestReader::ShardIndex(pair, 1 << 20),
+            ManifestReader::ShardIndex(swapped, 1 << 20));
+  ASSERT_NE(ManifestReader::ShardIndex(pair, 1 << 20),
+            ManifestReader::ShardIndex(joined, 1 << 20));
+}
+
+// Test that the shard CSV files are merged back into manifest order.
+TEST(ShardMerger, MergeResultsCSV) {
+  const std::string dir = ::testing::TempDir();
+  WriteFile(dir + "/merge_manifest.csv",
+            "reference,degraded\n"
+            "r1.wav,d1.wav\n"
+            "r2.wav,d2.wav\n"
+            "r3.wav,d3.wav\n"
+            "r1.wav,d1.wav\n");
+  WriteFile(dir + "/merge_shard0.csv",
+            "reference,degraded,moslqo\n"
+            "r3.wav,d3.wav,3.0\n"
+            "r1.wav,d1.wav,1.0\n"
+            "r1.wav,d1.wav,1.5\n");
+  WriteFile(dir + "/merge_shard1.csv",
+            "reference,degraded,moslqo\n"
+            "r2.wav,d2.wav,2.0\n");
+
+  const absl::Status status = ShardMerger::MergeResultsCSV(
+      FilePath(dir + "/merge_manifest.csv"),
+      {FilePath(dir + "/merge_shard0.csv"), FilePath(dir + "/merge_shard1.csv")},
+      FilePath(dir + "/merged.csv"));
+  ASSERT_TRUE(status.ok()) << status;
+  ASSERT_EQ(
+      "reference,degraded,moslqo\n"
+      "r1.wav,d1.wav,1.0\n"
+      "r2.wav,d2.wav,2.0\n"
+      "r3.wav,d3.wav,3.0\n"
+      "r1.wav,d1.wav,1.5\n",
+      ReadFile(dir + "/merged.csv"));
+}
+
+// Test that a pair without a result is reported, and that the results which
+// were found are still written.
+TEST(ShardMerger, MissingPair) {
+  const std::string dir = ::testing::TempDir();
+  WriteFile(dir + "/missing_manifest.csv",
+            "reference,degraded\n"
+            "r1.wav,d1.wav\n"
+            "r2.wav,d2.wav\n");
+  WriteFile(dir + "/missing_shard0.csv",
+            "reference,degraded,moslqo\n"
+            "r2.wav,d2.wav,2.0\n");
+
+  const absl::Status status = ShardMerger::MergeResultsCSV(
+      FilePath(dir + "/missing_manifest.csv"),
+      {FilePath(dir + "/missing_shard0.csv")},
+      FilePath(dir + "/missing_merged.csv"));
+  ASSERT_EQ(absl::StatusCode::kNotFound, status.code());
+  ASSERT_EQ(
+      "reference,degraded,moslqo\n"
+      "r2.wav,d2.wav,2.0\n",
+      ReadFile(dir + "/missing_merged.csv"));
+}
+
+// Test that shards written with different CSV headers are not merged.
+TEST(ShardMerger, MismatchedHeaders) {
+  const std::string dir = ::testing::TempDir();
+  WriteFile(dir + "/header_manifest.csv",
+            "reference,degraded\n"
+            "r1.wav,d1.wav\n"
+            "r2.wav,d2.wav\n");
+  WriteFile(dir + "/header_shard0.csv",
+            "reference,degraded,moslqo\n"
+            "r1.wav,d1.wav,1.0\n");
+  WriteFile(dir + "/header_shard1.csv",
+            "reference,degraded,moslqo,fvnsim0\n"
+            "r2.wav,d2.wav,2.0,0.5\n");
+
+  const absl::Status status = ShardMerger::MergeResultsCSV(
+      FilePath(dir + "/header_manifest.csv"),
+      {FilePath(dir + "/header_shard0.csv"),
+       FilePath(dir + "/header_shard1.csv")},
+      FilePath(dir + "/header_merged.csv"));
+  ASSERT_FALSE(status.ok());
+}
+
+// Test that concatenated JSON objects are split, including braces in strings.
+TEST(ShardMerger, SplitJsonObjects) {
+  auto objects_or = ShardMerger::SplitJsonObjects(
+      "{\"a\":{\"b\":1}}\n{\"c\":\"}{\\\"\"}{}");
+  ASSERT_TRUE(objects_or.ok());
+  const std::vector<std::string> objects = objects_or.value();
+  ASSERT_EQ(3, objects.size());
+  ASSERT_EQ("{\"a\":{\"b\":1}}", objects[0]);
+  ASSERT_EQ("{\"c\":\"}{\\\"\"}", objects[1]);
+  ASSERT_EQ("{}", objects[2]);
+
+  ASSERT_FALSE(ShardMerger::SplitJsonObjects("{\"a\":1").ok());
+}
+
+}  // namespace
+}  // namespace Visqol
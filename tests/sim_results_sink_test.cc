@@ -0,0 +1,129 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sim_results_sink.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "file_path.h"
+#include "gtest/gtest.h"
+#include "src/proto/similarity_result.pb.h"  // Generated by cc_proto_library rule
+
+namespace Visqol {
+namespace {
+
+const size_t kNumResults = 40;
+
+SimilarityResultMsg MakeResult(size_t index) {
+  SimilarityResultMsg msg;
+  msg.set_reference_filepath("ref" + std::to_string(index) + ".wav");
+  msg.set_degraded_filepath("deg" + std::to_string(index) + ".wav");
+  msg.set_moslqo(1.0 + index / 10.0);
+  msg.add_fvnsim(0.5);
+  return msg;
+}
+
+std::vector<std::string> ReadLines(const FilePath& path) {
+  std::vector<std::string> lines;
+  std::ifstream file(path.Path());
+  std::string line;
+  while (std::getline(file, line)) {
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+// Results submitted from several threads in any order are written in index
+// order, with the header written once, and skipped results are left out.
+TEST(SimilarityResultsSink, WritesInIndexOrder) {
+  const FilePath csv_path(::testing::TempDir() + "/sink_order.csv");
+  std::remove(csv_path.Path().c_str());
+  {
+    SimilarityResultsSink sink(false, csv_path, FilePath(""), false, false,
+                               4);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; t++) {
+      threads.emplace_back([&sink, t]() {
+        for (size_t i = t; i < kNumResults; i += 4) {
+          if (i == 7) {
+            sink.Skip(i);
+          } else {
+            sink.Submit(i, MakeResult(i));
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  const std::vector<std::string> lines = ReadLines(csv_path);
+  ASSERT_EQ(kNumResults, lines.size());
+  ASSERT_EQ(0, lines[0].find("reference,degraded,moslqo,fvnsim0"));
+  size_t line = 1;
+  for (size_t i = 0; i < kNumResults; i++) {
+    if (i == 7) {
+      continue;
+    }
+    const std::string prefix =
+        "ref" + std::to_string(i) + ".wav,deg" + std::to_string(i) + ".wav,";
+    ASSERT_EQ(0, lines[line].find(prefix)) << lines[line];
+    line++;
+  }
+}
+
+// A second sink appends to an existing file without repeating the header.
+TEST(SimilarityResultsSink, AppendsWithoutHeader) {
+  const FilePath csv_path(::testing::TempDir() + "/sink_append.csv");
+  std::remove(csv_path.Path().c_str());
+  for (size_t run = 0; run < 2; run++) {
+    SimilarityResultsSink sink(false, csv_path, FilePath(""), false, false);
+    sink.Submit(0, MakeResult(run));
+  }
+
+  const std::vector<std::string> lines = ReadLines(csv_path);
+  ASSERT_EQ(3, lines.size());
+  ASSERT_EQ(0, lines[1].find("ref0.wav"));
+  ASSERT_EQ(0, lines[2].find("ref1.wav"));
+}
+
+// A buffered result is written once it is older than the flush interval, even
+// though no further results are submitted.
+TEST(SimilarityResultsSink, FlushesAfterInterval) {
+  const FilePath csv_path(::testing::TempDir() + "/sink_interval.csv");
+  std::remove(csv_path.Path().c_str());
+  SimilarityResultsSink sink(false, csv_path, FilePath(""), false, false,
+                             SimilarityResultsSink::kDefaultMaxPendingResults,
+                             absl::Milliseconds(20));
+  sink.Submit(0, MakeResult(0));
+
+  std::vector<std::string> lines;
+  const absl::Time deadline = absl::Now() + absl::Seconds(10);
+  while (lines.size() < 2 && absl::Now() < deadline) {
+    absl::SleepFor(absl::Milliseconds(10));
+    lines = ReadLines(csv_path);
+  }
+  ASSERT_EQ(2, lines.size());
+  ASSERT_EQ(0, lines[1].find("ref0.wav"));
+}
+
+}  // namespace
+}  // namespace Visqol
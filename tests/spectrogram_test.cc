@@ -14,6 +14,9 @@
 
 #include "spectrogram.h"
 
+#include <string>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "test_utility.h"
 
@@ -76,5 +79,29 @@ TEST(SpectrogramTest, SubtractFloorTest) {
       << fail_msg;
 }
 
+// Ensure that the floor of each frame is raised relative to the loudest band
+// of that frame in either spectrogram, and that frames beyond the end of the
+// shorter spectrogram are left unchanged.
+TEST(SpectrogramTest, RaiseFloorPerFrameTest) {
+  // Three bands, with three frames in the reference and two in the degraded.
+  Spectrogram ref{AMatrix<double>{
+      3, 3, std::vector<double>{-10, -50, -20, -70, -30, -90, -5, -80, -99}}};
+  Spectrogram deg{AMatrix<double>{
+      3, 2, std::vector<double>{-60, -40, -15, -25, -95, -35}}};
+  ref.RaiseFloorPerFrame(20, deg);
+
+  std::string fail_msg;
+  const AMatrix<double> expected_ref{
+      3, 3, std::vector<double>{-10, -30, -20, -45, -30, -45, -5, -80, -99}};
+  ASSERT_TRUE(CompareDoubleMatrix(expected_ref, ref.Data(), kTolerance,
+                                  &fail_msg))
+      << fail_msg;
+  const AMatrix<double> expected_deg{
+      3, 2, std::vector<double>{-30, -30, -15, -25, -45, -35}};
+  ASSERT_TRUE(CompareDoubleMatrix(expected_deg, deg.Data(), kTolerance,
+                                  &fail_msg))
+      << fail_msg;
+}
+
 }  // namespace
 }  // namespace Visqol
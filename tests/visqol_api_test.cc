@@ -14,6 +14,11 @@
 
 #include "visqol_api.h"
 
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "audio_signal.h"
@@ -24,6 +29,7 @@
 #include "misc_audio.h"
 #include "src/proto/similarity_result.pb.h"  // Generated by cc_proto_library rule
 #include "src/proto/visqol_config.pb.h"  // Generated by cc_proto_library rule
+#include "wav_reader.h"
 
 namespace Visqol {
 namespace {
@@ -123,6 +129,48 @@ TEST(VisqolApi, happy_path_default_model) {
   }
 }
 
+// Read the interleaved 16-bit samples of a WAV file.
+std::vector<int16_t> ReadInterleaved(absl::string_view path,
+                                     size_t* num_channels) {
+  std::ifstream wav_file(std::string(path), std::ios::binary);
+  WavReader wav_reader(&wav_file);
+  std::vector<int16_t> samples(wav_reader.GetNumTotalSamples());
+  samples.resize(wav_reader.ReadSamples(samples.size(), samples.data()));
+  *num_channels = wav_reader.GetNumChannels();
+  return samples;
+}
+
+/**
+ *  Test that interleaved multichannel signals give the same result as the
+ *  same signals loaded from file.
+ */
+TEST(VisqolApi, interleaved_input) {
+  size_t num_channels;
+  const std::vector<int16_t> ref_data =
+      ReadInterleaved(kContrabassoonRef, &num_channels);
+  ASSERT_EQ(2, num_channels);
+  const std::vector<int16_t> deg_data =
+      ReadInterleaved(kContrabassoonDeg, &num_channels);
+
+  VisqolConfig config;
+  config.mutable_audio()->set_sample_rate(kSampleRate);
+  VisqolApi visqol;
+  ASSERT_TRUE(visqol.Create(config).ok());
+  auto result = visqol.MeasureInterleaved(ref_data, deg_data, num_channels);
+
+  ASSERT_TRUE(result.ok());
+  EXPECT_NEAR(kConformanceContrabassoon24aac, result.value().moslqo(),
+              kTolerance);
+  EXPECT_NEAR(kContrabassoonVnsim, result.value().vnsim(), kTolerance);
+
+  // A partial frame is rejected.
+  auto partial_result = visqol.MeasureInterleaved(
+      absl::MakeConstSpan(ref_data.data(), ref_data.size() - 1), deg_data,
+      num_channels);
+  ASSERT_EQ(absl::StatusCode::kInvalidArgument,
+            partial_result.status().code());
+}
+
 /**
  *  Test calling the ViSQOL API without sample rate data for the input signals.
  */
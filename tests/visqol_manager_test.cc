@@ -14,12 +14,20 @@
 
 #include "visqol_manager.h"
 
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+
 #include "absl/flags/flag.h"
+#include "audio_archive.h"
 #include "commandline_parser.h"
 #include "conformance.h"
 #include "gtest/gtest.h"
 #include "similarity_result.h"
 #include "test_utility.h"
+#include "wav_reader.h"
 
 namespace Visqol {
 namespace {
@@ -80,6 +88,152 @@ TEST(RegressionTest, Stereo) {
   EXPECT_NEAR(kConformanceGuitar64aac, status_or.value().moslqo(), kTolerance);
 }
 
+// Write the samples of a WAV file, without its header, to a raw PCM file.
+FilePath WriteRawPcm(const std::string& wav_path, const std::string& name) {
+  std::ifstream wav_file(wav_path, std::ios::binary);
+  WavReader wav_reader(&wav_file);
+  wav_file.clear();
+  wav_file.seekg(wav_reader.GetPcmOffsetBytes());
+  const FilePath raw_path(::testing::TempDir() + "/" + name);
+  std::ofstream raw_file(raw_path.Path(), std::ios::binary);
+  raw_file << wav_file.rdbuf();
+  return raw_path;
+}
+
+/**
+ * Ensure that raw PCM input gives the same result as the WAV files holding
+ * the same samples.
+ */
+TEST(RegressionTest, RawPcmInput) {
+  const FilePath ref_path = WriteRawPcm(
+      "testdata/conformance_testdata_subset/guitar48_stereo.wav", "ref.raw");
+  const FilePath deg_path = WriteRawPcm(
+      "testdata/conformance_testdata_subset/guitar48_stereo_64kbps_aac.wav",
+      "deg.raw");
+  const Visqol::CommandLineArgs cmd_args =
+      CommandLineArgsHelper(ref_path.Path(), deg_path.Path());
+  WavReader::PcmFormat format;
+  format.sample_rate_hz = 48000;
+  format.num_channels = 2;
+  format.sample_format = WavReader::SampleFormat::kInt16;
+  Visqol::VisqolManager visqol;
+
+  auto status = visqol.Init(
+      cmd_args.similarity_to_quality_mapper_model, cmd_args.use_speech_mode,
+      cmd_args.use_unscaled_speech_mos_mapping, cmd_args.search_window_radius,
+      cmd_args.use_lattice_model, false, false, false, false, false, format);
+  ASSERT_TRUE(status.ok());
+
+  auto status_or = visqol.Run(ref_path, deg_path);
+  ASSERT_TRUE(status_or.ok());
+  EXPECT_NEAR(kConformanceGuitar64aac, status_or.value().moslqo(), kTolerance);
+}
+
+// Append a file to a tar archive as a member with the given name.
+void AppendTarMember(const std::string& path, const std::string& name,
+                     std::ofstream* tar_file) {
+  std::ifstream file(path, std::ios::binary);
+  const std::string contents((std::istreambuf_iterator<char>(file)),
+                             std::istreambuf_iterator<char>());
+  std::string header(512, '\0');
+  header.replace(0, name.size(), name);
+  char field[12];
+  std::snprintf(field, sizeof(field), "%011zo", contents.size());
+  header.replace(124, 11, field, 11);
+  header[156] = '0';
+  header.replace(148, 8, 8, ' ');
+  unsigned int checksum = 0;
+  for (const char c : header) {
+    checksum += static_cast<unsigned char>(c);
+  }
+  std::snprintf(field, sizeof(field), "%06o", checksum);
+  header.replace(148, 7, field, 7);
+  *tar_file << header << contents
+            << std::string((512 - contents.size() % 512) % 512, '\0');
+}
+
+/**
+ * Ensure that reading the input files from a tar archive gives the same
+ * result as reading them from the filesystem.
+ */
+TEST(RegressionTest, ArchiveInput) {
+  const std::string tar_path = ::testing::TempDir() + "/input.tar";
+  {
+    std::ofstream tar_file(tar_path, std::ios::binary);
+    AppendTarMember("testdata/conformance_testdata_subset/guitar48_stereo.wav",
+                    "ref.wav", &tar_file);
+    AppendTarMember(
+        "testdata/conformance_testdata_subset/guitar48_stereo_64kbps_aac.wav",
+        "clips/deg.wav", &tar_file);
+    tar_file << std::string(1024, '\0');
+  }
+  auto archive_or = AudioArchive::Open(FilePath(tar_path));
+  ASSERT_TRUE(archive_or.ok());
+  const Visqol::CommandLineArgs cmd_args =
+      CommandLineArgsHelper("ref.wav", "clips/deg.wav");
+  Visqol::VisqolManager visqol;
+
+  auto status = visqol.Init(
+      cmd_args.similarity_to_quality_mapper_model, cmd_args.use_speech_mode,
+      cmd_args.use_unscaled_speech_mos_mapping, cmd_args.search_window_radius,
+      cmd_args.use_lattice_model);
+  ASSERT_TRUE(status.ok());
+  visqol.SetInputArchive(std::move(archive_or).value());
+
+  auto status_or = visqol.Run(FilePath("ref.wav"), FilePath("clips/deg.wav"));
+  ASSERT_TRUE(status_or.ok());
+  EXPECT_NEAR(kConformanceGuitar64aac, status_or.value().moslqo(), kTolerance);
+
+  // A member that is not in the archive cannot be compared.
+  status_or = visqol.Run(FilePath("ref.wav"), FilePath("missing.wav"));
+  ASSERT_FALSE(status_or.ok());
+}
+
+/**
+ * Ensure that running against a prepared reference gives the same result as
+ * running against the reference file, and that the prepared reference can be
+ * reused for further comparisons.
+ */
+TEST(RegressionTest, PreparedReference) {
+  const Visqol::CommandLineArgs cmd_args = CommandLineArgsHelper(
+      "testdata/conformance_testdata_subset/"
+      "guitar48_stereo.wav",
+      "testdata/conformance_testdata_subset/"
+      "guitar48_stereo_64kbps_aac.wav");
+  Visqol::VisqolManager visqol;
+  auto files_to_compare = VisqolCommandLineParser::BuildFilePairPaths(cmd_args);
+
+  auto status = visqol.Init(
+      cmd_args.similarity_to_quality_mapper_model, cmd_args.use_speech_mode,
+      cmd_args.use_unscaled_speech_mos_mapping, cmd_args.search_window_radius,
+      cmd_args.use_lattice_model);
+  ASSERT_TRUE(status.ok());
+
+  auto reference_or = visqol.PrepareReference(files_to_compare[0].reference);
+  ASSERT_TRUE(reference_or.ok());
+  const auto reference = reference_or.value();
+  for (int i = 0; i < 2; i++) {
+    auto status_or = visqol.Run(*reference, files_to_compare[0].degraded);
+    ASSERT_TRUE(status_or.ok());
+    EXPECT_NEAR(kConformanceGuitar64aac, status_or.value().moslqo(),
+                kTolerance);
+    EXPECT_EQ(files_to_compare[0].reference.Path(),
+              status_or.value().reference_filepath());
+  }
+
+  // A reference prepared for audio mode cannot be used in speech mode.
+  Visqol::VisqolManager speech_visqol;
+  status = speech_visqol.Init(cmd_args.similarity_to_quality_mapper_model,
+                              true, false, cmd_args.search_window_radius,
+                              false);
+  ASSERT_TRUE(status.ok());
+  auto speech_status_or =
+      speech_visqol.Run(*reference, files_to_compare[0].degraded);
+  ASSERT_FALSE(speech_status_or.ok());
+  ASSERT_EQ(absl::StatusCode::kInvalidArgument,
+            speech_status_or.status().code());
+}
+
 /**
  * Pass an invalid model to VisqolManager and ensure an INVALID_ARGUMENT
  * status is returned.
@@ -262,6 +416,32 @@ TEST(VisqolCommandLineTest, DifferentSampleRate) {
   ASSERT_FALSE(status_or.ok());
 }
 
+/**
+ * Ensure that input audio signals with different sample rates are compared
+ * when they are resampled to 48k, and that a signal resampled to 44.1k and
+ * back scores close to the original.
+ */
+TEST(VisqolCommandLineTest, DifferentSampleRateResampled) {
+  const Visqol::CommandLineArgs cmd_args = CommandLineArgsHelper(
+      "testdata/conformance_testdata_subset/"
+      "guitar48_stereo.wav",
+      "testdata/non_48k_sample_rate/"
+      "guitar48_stereo_44100Hz.wav");
+  Visqol::VisqolManager visqol;
+  auto files_to_compare = VisqolCommandLineParser::BuildFilePairPaths(cmd_args);
+
+  auto status = visqol.Init(
+      cmd_args.similarity_to_quality_mapper_model, cmd_args.use_speech_mode,
+      cmd_args.use_unscaled_speech_mos_mapping, cmd_args.search_window_radius,
+      cmd_args.use_lattice_model, false, false, false, true);
+  ASSERT_TRUE(status.ok());
+
+  auto status_or =
+      visqol.Run(files_to_compare[0].reference, files_to_compare[0].degraded);
+  ASSERT_TRUE(status_or.ok());
+  ASSERT_GT(status_or.value().moslqo(), 4.5);
+}
+
 /**
  * Test the debug output patch timestamps. Test with two identical files.
  */
@@ -452,5 +632,43 @@ TEST(VisqolCommandLineTest, ZeroLagOnidenticalFiles) {
   EXPECT_NEAR(0.0, status_or.value().alignment_lag_s(), kLagTolerance);
 }
 
+/**
+ * Test that the configuration key identifies the model by its content, so
+ * that copies of a model share cached results and a model retrained in place
+ * does not.
+ */
+TEST(VisqolCommandLineTest, ConfigurationKeyFollowsModelContent) {
+  const Visqol::CommandLineArgs cmd_args =
+      CommandLineArgsHelper("testdata/clean_speech/CA01_01.wav",
+                            "testdata/clean_speech/transcoded_CA01_01.wav");
+  std::ifstream model(cmd_args.similarity_to_quality_mapper_model.Path(),
+                      std::ios_base::binary);
+  const std::string model_contents((std::istreambuf_iterator<char>(model)),
+                                   std::istreambuf_iterator<char>());
+  ASSERT_FALSE(model_contents.empty());
+  const std::string copy_path = ::testing::TempDir() + "/model_copy.txt";
+  std::ofstream(copy_path, std::ios_base::binary) << model_contents;
+
+  Visqol::VisqolManager original;
+  auto status = original.Init(cmd_args.similarity_to_quality_mapper_model,
+                              false, false, cmd_args.search_window_radius,
+                              false);
+  ASSERT_TRUE(status.ok());
+  Visqol::VisqolManager copy;
+  status = copy.Init(FilePath(copy_path), false, false,
+                     cmd_args.search_window_radius, false);
+  ASSERT_TRUE(status.ok());
+  const auto original_key = original.ConfigurationKey();
+  const auto copy_key = copy.ConfigurationKey();
+  ASSERT_TRUE(original_key.ok());
+  ASSERT_TRUE(copy_key.ok());
+  ASSERT_EQ(original_key.value(), copy_key.value());
+
+  std::ofstream(copy_path, std::ios_base::binary | std::ios_base::app) << "\n";
+  const auto retrained_key = copy.ConfigurationKey();
+  ASSERT_TRUE(retrained_key.ok());
+  ASSERT_NE(original_key.value(), retrained_key.value());
+}
+
 }  // namespace
 }  // namespace Visqol
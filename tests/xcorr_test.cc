@@ -14,6 +14,8 @@
 
 #include "xcorr.h"
 
+#include <vector>
+
 #include "gtest/gtest.h"
 
 namespace Visqol {
@@ -82,5 +84,37 @@ TEST(XCorr, NegativeBestLag) {
   ASSERT_EQ(kBestLagNegative2, best_lag);
 }
 
+// Test the bounded-lag search finds the same lag as the full search when the
+// best lag is within range.
+TEST(XCorr, BestLagInRange) {
+  const int64_t best_lag = XCorr::FindLowestLagIndexInRange(
+      kReferenceSignal, kDegradedSignalLag2, -3, 3);
+  ASSERT_EQ(kBestLagPositive2, best_lag);
+  const int64_t negative_lag = XCorr::FindLowestLagIndexInRange(
+      kReferenceSignal, kDegradedSignalNegativeLag2, -3, 3);
+  ASSERT_EQ(kBestLagNegative2, negative_lag);
+}
+
+// Test the bounded-lag search only considers lags within the given range.
+TEST(XCorr, BestLagRestrictedRange) {
+  const int64_t best_lag = XCorr::FindLowestLagIndexInRange(
+      kReferenceSignal, kDegradedSignalLag2, -1, 1);
+  ASSERT_LE(-1, best_lag);
+  ASSERT_GE(1, best_lag);
+}
+
+// Test the direct correlation agrees with the FFT based correlation.
+TEST(XCorr, CorrelationAtLagMatchesFft) {
+  const std::vector<double> corrs =
+      XCorr::CalcCrossCorrelation(kReferenceSignal, kLongDegradedSignalLag2);
+  const int64_t max_lag = (corrs.size() - 1) / 2;
+  for (int64_t lag = -max_lag; lag <= max_lag; ++lag) {
+    ASSERT_NEAR(corrs[lag + max_lag],
+                XCorr::CalcCorrelationAtLag(kReferenceSignal,
+                                            kLongDegradedSignalLag2, lag),
+                1e-3);
+  }
+}
+
 }  // namespace
 }  // namespace Visqol